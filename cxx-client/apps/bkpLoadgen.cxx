@@ -0,0 +1,550 @@
+//  Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+//  See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+//  All rights not expressly granted are reserved.
+//
+//  This software is distributed under the terms of the GNU General Public
+//  License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+//  In applying this license CERN does not waive the privileges and immunities
+//  granted to it by virtue of its status as an Intergovernmental Organization
+//  or submit itself to any jurisdiction.
+
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <grpcpp/alarm.h>
+#include <grpcpp/generic/async_generic_service.h>
+#include <grpcpp/grpcpp.h>
+#include "BookkeepingApi/BkpClientFactory.h"
+
+using namespace o2::bkp::api;
+using Clock = std::chrono::steady_clock;
+
+namespace
+{
+/// Maximal amount of distinct error messages reported per workload
+constexpr size_t MAX_REPORTED_ERRORS = 5;
+
+/// Load generation configuration, filled from the command line
+struct LoadgenConfiguration {
+  std::string uri;
+  std::string token;
+  std::chrono::seconds duration{ 30 };
+  int32_t runNumber = 1;
+  uint32_t flps = 200;
+  double flpRate = 1;
+  uint32_t flpConcurrency = 8;
+  uint32_t ctpClasses = 64;
+  double ctpRate = 1;
+  uint32_t ctpConcurrency = 4;
+  uint32_t dplDevices = 1000;
+  uint32_t dplConcurrency = 16;
+  uint32_t qcBurstSize = 50;
+  std::chrono::milliseconds qcBurstInterval{ 5000 };
+  uint32_t qcFlagsPerCall = 10;
+  uint32_t qcConcurrency = 8;
+  bool standIn = false;
+  std::chrono::milliseconds standInDelay{ 0 };
+  /// Amount of clients created by the startup benchmark, 0 to generate load instead
+  uint32_t startupIterations = 0;
+  /// Time the startup benchmark leaves between creating a client and its first call, as a process initialising would
+  std::chrono::milliseconds startupInitDelay{ 200 };
+  BkpClientOptions clientOptions;
+};
+
+/// Results gathered by the workers of a workload
+struct WorkloadResult {
+  std::vector<double> latenciesMs;
+  /// Time spent by the server handling the successful calls, for the ones it reported it
+  std::vector<double> serverLatenciesMs;
+  uint64_t errors = 0;
+  std::map<std::string, uint64_t> errorMessages;
+  /// Largest delay between the time a call was scheduled at and the time it was actually sent
+  Clock::duration maxLag{};
+  Clock::duration elapsed{};
+};
+
+/**
+ * Calls of a given kind, scheduled at predefined times and run by a pool of workers
+ *
+ * Scheduling is open-loop: a call whose scheduled time is already passed is sent right away, so a slow server shows up
+ * as a lower achieved throughput and a growing lag behind the schedule instead of silently slowing down the offered load.
+ * Calls still late when the test ends are not sent.
+ */
+struct Workload {
+  std::string name;
+  uint32_t concurrency;
+  /// Total amount of calls, 0 for no other limit than the test duration
+  uint64_t maxCalls;
+  /// Time at which the call of the given index must be sent, relative to the start of the test
+  std::function<Clock::duration(uint64_t)> scheduledAt;
+  /// Send the call of the given index, throw on failure
+  std::function<void(uint64_t)> call;
+};
+
+/// Workload sending calls at a constant total rate
+Clock::duration atRate(uint64_t index, double rate)
+{
+  return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(index / rate));
+}
+
+WorkloadResult runWorkload(const Workload& workload, Clock::time_point start, Clock::time_point end)
+{
+  WorkloadResult result;
+  std::mutex resultMutex;
+  std::atomic<uint64_t> nextIndex{ 0 };
+
+  std::vector<std::thread> workers;
+  for (uint32_t workerIndex = 0; workerIndex < std::max<uint32_t>(workload.concurrency, 1); workerIndex++) {
+    workers.emplace_back([&]() {
+      WorkloadResult workerResult;
+      while (true) {
+        auto index = nextIndex++;
+        auto scheduledAt = start + workload.scheduledAt(index);
+        if ((workload.maxCalls != 0 && index >= workload.maxCalls) || scheduledAt >= end || Clock::now() >= end) {
+          break;
+        }
+        std::this_thread::sleep_until(scheduledAt);
+
+        auto callStart = Clock::now();
+        workerResult.maxLag = std::max(workerResult.maxLag, callStart - scheduledAt);
+        try {
+          workload.call(index);
+          workerResult.latenciesMs.push_back(std::chrono::duration<double, std::milli>(Clock::now() - callStart).count());
+          if (const auto& server = CallTiming::last().server) {
+            workerResult.serverLatenciesMs.push_back(std::chrono::duration<double, std::milli>(server->auth + server->handler).count());
+          }
+        } catch (const std::exception& error) {
+          workerResult.errors++;
+          workerResult.errorMessages[error.what()]++;
+        }
+      }
+
+      std::lock_guard<std::mutex> lock(resultMutex);
+      result.latenciesMs.insert(result.latenciesMs.end(), workerResult.latenciesMs.begin(), workerResult.latenciesMs.end());
+      result.serverLatenciesMs.insert(result.serverLatenciesMs.end(), workerResult.serverLatenciesMs.begin(), workerResult.serverLatenciesMs.end());
+      result.errors += workerResult.errors;
+      result.maxLag = std::max(result.maxLag, workerResult.maxLag);
+      for (const auto& [message, count] : workerResult.errorMessages) {
+        result.errorMessages[message] += count;
+      }
+    });
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  result.elapsed = Clock::now() - start;
+  return result;
+}
+
+double percentile(const std::vector<double>& sortedValues, double rank)
+{
+  if (sortedValues.empty()) {
+    return 0;
+  }
+  auto index = static_cast<size_t>(rank * static_cast<double>(sortedValues.size() - 1) + 0.5);
+  return sortedValues[std::min(index, sortedValues.size() - 1)];
+}
+
+void printHeader(const std::string& firstColumn)
+{
+  std::cout << std::left << std::setw(20) << firstColumn << std::right
+            << std::setw(10) << "calls" << std::setw(12) << "calls/s" << std::setw(10) << "errors"
+            << std::setw(10) << "p50 ms" << std::setw(10) << "p90 ms" << std::setw(10) << "p99 ms" << std::setw(10) << "max ms"
+            << std::setw(10) << "lag ms" << std::setw(14) << "server p99 ms" << std::endl;
+}
+
+void printResult(const std::string& name, WorkloadResult& result)
+{
+  std::sort(result.latenciesMs.begin(), result.latenciesMs.end());
+  std::sort(result.serverLatenciesMs.begin(), result.serverLatenciesMs.end());
+  auto calls = result.latenciesMs.size() + result.errors;
+  auto elapsedSeconds = std::chrono::duration<double>(result.elapsed).count();
+
+  std::cout << std::fixed << std::setprecision(2)
+            << std::left << std::setw(20) << name << std::right
+            << std::setw(10) << calls
+            << std::setw(12) << (elapsedSeconds > 0 ? result.latenciesMs.size() / elapsedSeconds : 0)
+            << std::setw(9) << (calls > 0 ? 100.0 * result.errors / calls : 0) << "%"
+            << std::setw(10) << percentile(result.latenciesMs, 0.5)
+            << std::setw(10) << percentile(result.latenciesMs, 0.9)
+            << std::setw(10) << percentile(result.latenciesMs, 0.99)
+            << std::setw(10) << (result.latenciesMs.empty() ? 0 : result.latenciesMs.back())
+            << std::setw(10) << std::chrono::duration<double, std::milli>(result.maxLag).count()
+            << std::setw(14);
+  // Not reported by the stand-in server
+  if (result.serverLatenciesMs.empty()) {
+    std::cout << "-";
+  } else {
+    std::cout << percentile(result.serverLatenciesMs, 0.99);
+  }
+  std::cout << std::endl;
+  size_t reportedErrors = 0;
+  for (const auto& [message, count] : result.errorMessages) {
+    if (reportedErrors++ == MAX_REPORTED_ERRORS) {
+      std::cout << "    ..." << std::endl;
+      break;
+    }
+    std::cout << "    " << count << " x " << message << std::endl;
+  }
+}
+
+/// Reactor answering any unary call with an empty message, optionally after a delay
+class StandInReactor : public grpc::ServerGenericBidiReactor
+{
+ public:
+  explicit StandInReactor(std::chrono::milliseconds delay) : mDelay(delay)
+  {
+    StartRead(&mRequest);
+  }
+
+  void OnReadDone(bool ok) override
+  {
+    if (!ok) {
+      Finish(grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "No request received"));
+      return;
+    }
+    if (mDelay.count() == 0) {
+      respond();
+      return;
+    }
+    // Do not block the callback threads during the simulated processing time
+    mAlarm.Set(std::chrono::system_clock::now() + mDelay, [this](bool) { respond(); });
+  }
+
+  void OnDone() override
+  {
+    delete this;
+  }
+
+ private:
+  void respond()
+  {
+    grpc::Slice emptyMessage(std::string{});
+    mResponse = grpc::ByteBuffer(&emptyMessage, 1);
+    StartWriteAndFinish(&mResponse, grpc::WriteOptions(), grpc::Status::OK);
+  }
+
+  std::chrono::milliseconds mDelay;
+  grpc::Alarm mAlarm;
+  grpc::ByteBuffer mRequest;
+  grpc::ByteBuffer mResponse;
+};
+
+/// In-process server standing in for bookkeeping, to measure the client side alone
+class StandInService : public grpc::CallbackGenericService
+{
+ public:
+  explicit StandInService(std::chrono::milliseconds delay) : mDelay(delay) {}
+
+  grpc::ServerGenericBidiReactor* CreateReactor(grpc::GenericCallbackServerContext*) override
+  {
+    return new StandInReactor(mDelay);
+  }
+
+ private:
+  std::chrono::milliseconds mDelay;
+};
+
+std::vector<Workload> createWorkloads(const LoadgenConfiguration& configuration, const std::unique_ptr<BkpClient>& client)
+{
+  std::vector<Workload> workloads;
+  auto runNumber = configuration.runNumber;
+
+  auto deviceName = [](const std::string& prefix, uint64_t index) {
+    std::ostringstream name;
+    name << prefix << std::setw(3) << std::setfill('0') << index;
+    return name.str();
+  };
+
+  // Start of run: run update and registration of all the DPL devices at once
+  if (configuration.dplDevices > 0) {
+    workloads.push_back({ "run-sor", 1, 1, [](uint64_t) { return Clock::duration::zero(); }, [&client, runNumber](uint64_t) {
+                           client->run()->setRawCtpTriggerConfiguration(runNumber, "loadgen raw CTP trigger configuration");
+                         } });
+    workloads.push_back({ "dpl-register",
+                          configuration.dplConcurrency,
+                          configuration.dplDevices,
+                          [](uint64_t) { return Clock::duration::zero(); },
+                          [&client, runNumber, deviceName](uint64_t index) {
+                            // Spread the devices over the QC task to merger process types
+                            auto type = static_cast<o2::bkp::DplProcessType>(1 + index % 6);
+                            client->dplProcessExecution()->registerProcessExecution(
+                              runNumber, type, deviceName("epn", index % 250), deviceName("device", index), "--loadgen", "TST");
+                          } });
+  }
+
+  if (configuration.flps > 0 && configuration.flpRate > 0) {
+    auto totalRate = configuration.flps * configuration.flpRate;
+    auto flps = configuration.flps;
+    workloads.push_back({ "flp-counters",
+                          configuration.flpConcurrency,
+                          0,
+                          [totalRate](uint64_t index) { return atRate(index, totalRate); },
+                          [&client, runNumber, flps, deviceName](uint64_t index) {
+                            auto sample = index / flps + 1;
+                            client->flp()->updateReadoutCountersByFlpNameAndRunNumber(
+                              deviceName("flp", index % flps), runNumber, sample * 100, sample << 20, sample << 19, sample << 18);
+                          } });
+  }
+
+  if (configuration.ctpClasses > 0 && configuration.ctpRate > 0) {
+    auto totalRate = configuration.ctpClasses * configuration.ctpRate;
+    auto ctpClasses = configuration.ctpClasses;
+    workloads.push_back({ "ctp-counters",
+                          configuration.ctpConcurrency,
+                          0,
+                          [totalRate](uint64_t index) { return atRate(index, totalRate); },
+                          [&client, runNumber, ctpClasses, deviceName](uint64_t index) {
+                            auto sample = index / ctpClasses + 1;
+                            auto timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                               std::chrono::system_clock::now().time_since_epoch())
+                                               .count();
+                            client->ctpTriggerCounters()->createOrUpdateForRun(
+                              runNumber, deviceName("CLASS-", index % ctpClasses), timestamp,
+                              sample * 6, sample * 5, sample * 4, sample * 3, sample * 2, sample);
+                          } });
+  }
+
+  if (configuration.qcBurstSize > 0 && configuration.qcBurstInterval.count() > 0) {
+    auto burstSize = configuration.qcBurstSize;
+    auto burstInterval = configuration.qcBurstInterval;
+    std::vector<QcFlag> qcFlags;
+    for (uint32_t flagIndex = 0; flagIndex < configuration.qcFlagsPerCall; flagIndex++) {
+      qcFlags.push_back({ 3, flagIndex * 1000, flagIndex * 1000 + 999, "loadgen", "load test flag" });
+    }
+    workloads.push_back({ "qc-flags",
+                          configuration.qcConcurrency,
+                          0,
+                          [burstSize, burstInterval](uint64_t index) {
+                            return std::chrono::duration_cast<Clock::duration>(burstInterval * (index / burstSize));
+                          },
+                          [&client, runNumber, qcFlags, deviceName](uint64_t index) {
+                            client->qcFlag()->createForSynchronous(runNumber, deviceName("DET", index % 20), qcFlags);
+                          } });
+  }
+
+  return workloads;
+}
+
+/**
+ * Measure the time to the first successful call of freshly created clients, without and with connection prewarming
+ *
+ * Each iteration creates its own client, hence its own connections, waits for the configured initialisation delay then
+ * sends the run update a process would send at start of run.
+ */
+void runStartupBenchmark(const LoadgenConfiguration& configuration)
+{
+  std::cout << "Measuring the startup of " << configuration.startupIterations << " clients of " << configuration.uri
+            << (configuration.standIn ? " (stand-in)" : "") << " with " << configuration.startupInitDelay.count()
+            << "ms between creation and first call" << std::endl;
+
+  std::vector<std::pair<std::string, WorkloadResult>> results;
+  for (auto prewarm : { false, true }) {
+    auto options = configuration.clientOptions;
+    options.connection.prewarm = prewarm;
+    WorkloadResult creation;
+    WorkloadResult firstCall;
+    for (uint32_t iteration = 0; iteration < configuration.startupIterations; iteration++) {
+      auto creationStart = Clock::now();
+      auto client = BkpClientFactory::create(configuration.uri, configuration.token, options);
+      creation.latenciesMs.push_back(std::chrono::duration<double, std::milli>(Clock::now() - creationStart).count());
+
+      std::this_thread::sleep_for(configuration.startupInitDelay);
+
+      auto callStart = Clock::now();
+      try {
+        client->run()->setRawCtpTriggerConfiguration(configuration.runNumber, "loadgen raw CTP trigger configuration");
+        firstCall.latenciesMs.push_back(std::chrono::duration<double, std::milli>(Clock::now() - callStart).count());
+      } catch (const std::exception& error) {
+        firstCall.errors++;
+        firstCall.errorMessages[error.what()]++;
+      }
+    }
+    std::string mode = prewarm ? "prewarm" : "cold";
+    results.emplace_back("create " + mode, std::move(creation));
+    results.emplace_back("first-call " + mode, std::move(firstCall));
+  }
+
+  printHeader("step");
+  for (auto& [step, result] : results) {
+    printResult(step, result);
+  }
+}
+
+void printUsage()
+{
+  std::cerr
+    << "Usage: bkp-loadgen <gRPC URI> [token] [options]" << std::endl
+    << "  --duration-s <s>                   test duration (30)" << std::endl
+    << "  --run-number <number>              run used by all the calls (1)" << std::endl
+    << "  --flps <count> --flp-rate <hz> --flp-concurrency <threads>" << std::endl
+    << "                                     readout counters sent by each FLP (200, 1, 8)" << std::endl
+    << "  --ctp-classes <count> --ctp-rate <hz> --ctp-concurrency <threads>" << std::endl
+    << "                                     trigger counters sent for each class (64, 1, 4)" << std::endl
+    << "  --dpl-devices <count> --dpl-concurrency <threads>" << std::endl
+    << "                                     DPL devices registered at start of run (1000, 16)" << std::endl
+    << "  --qc-burst-size <calls> --qc-burst-interval-ms <ms> --qc-flags-per-call <count> --qc-concurrency <threads>" << std::endl
+    << "                                     QC flags creation bursts (50, 5000, 10, 8)" << std::endl
+    << "  --rate-limiter                     enable the client adaptive rate limiter" << std::endl
+    << "  --priority-lanes                   enable the client priority lanes" << std::endl
+    << "  --circuit-breaker                  enable the client circuit breakers" << std::endl
+    << "  --capture <file>                   capture the generated requests, to replay them with bkp-replay" << std::endl
+    << "  --stand-in [--stand-in-delay-ms <ms>]" << std::endl
+    << "                                     serve the URI with an in-process server answering empty messages" << std::endl
+    << "  --startup <iterations> [--startup-init-delay-ms <ms>]" << std::endl
+    << "                                     instead of generating load, measure the time to the first call of new" << std::endl
+    << "                                     clients without and with connection prewarming (200ms init delay)" << std::endl
+    << "  Any workload can be disabled by setting its count to 0" << std::endl;
+}
+
+bool parseArguments(int argc, char** argv, LoadgenConfiguration& configuration)
+{
+  for (int argIndex = 1; argIndex < argc; argIndex++) {
+    std::string arg = argv[argIndex];
+    bool hasValue = argIndex + 1 < argc;
+    auto nextUnsigned = [&]() { return static_cast<uint32_t>(std::stoul(argv[++argIndex])); };
+    auto nextDouble = [&]() { return std::stod(argv[++argIndex]); };
+
+    if (arg == "--duration-s" && hasValue) {
+      configuration.duration = std::chrono::seconds(nextUnsigned());
+    } else if (arg == "--run-number" && hasValue) {
+      configuration.runNumber = static_cast<int32_t>(nextUnsigned());
+    } else if (arg == "--flps" && hasValue) {
+      configuration.flps = nextUnsigned();
+    } else if (arg == "--flp-rate" && hasValue) {
+      configuration.flpRate = nextDouble();
+    } else if (arg == "--flp-concurrency" && hasValue) {
+      configuration.flpConcurrency = nextUnsigned();
+    } else if (arg == "--ctp-classes" && hasValue) {
+      configuration.ctpClasses = nextUnsigned();
+    } else if (arg == "--ctp-rate" && hasValue) {
+      configuration.ctpRate = nextDouble();
+    } else if (arg == "--ctp-concurrency" && hasValue) {
+      configuration.ctpConcurrency = nextUnsigned();
+    } else if (arg == "--dpl-devices" && hasValue) {
+      configuration.dplDevices = nextUnsigned();
+    } else if (arg == "--dpl-concurrency" && hasValue) {
+      configuration.dplConcurrency = nextUnsigned();
+    } else if (arg == "--qc-burst-size" && hasValue) {
+      configuration.qcBurstSize = nextUnsigned();
+    } else if (arg == "--qc-burst-interval-ms" && hasValue) {
+      configuration.qcBurstInterval = std::chrono::milliseconds(nextUnsigned());
+    } else if (arg == "--qc-flags-per-call" && hasValue) {
+      configuration.qcFlagsPerCall = nextUnsigned();
+    } else if (arg == "--qc-concurrency" && hasValue) {
+      configuration.qcConcurrency = nextUnsigned();
+    } else if (arg == "--rate-limiter") {
+      configuration.clientOptions.rateLimiter.enabled = true;
+    } else if (arg == "--circuit-breaker") {
+      configuration.clientOptions.circuitBreaker.enabled = true;
+    } else if (arg == "--priority-lanes") {
+      configuration.clientOptions.priorityLanes.enabled = true;
+    } else if (arg == "--capture" && hasValue) {
+      configuration.clientOptions.capture.path = argv[++argIndex];
+    } else if (arg == "--stand-in") {
+      configuration.standIn = true;
+    } else if (arg == "--stand-in-delay-ms" && hasValue) {
+      configuration.standInDelay = std::chrono::milliseconds(nextUnsigned());
+    } else if (arg == "--startup" && hasValue) {
+      configuration.startupIterations = nextUnsigned();
+    } else if (arg == "--startup-init-delay-ms" && hasValue) {
+      configuration.startupInitDelay = std::chrono::milliseconds(nextUnsigned());
+    } else if (configuration.uri.empty()) {
+      configuration.uri = arg;
+    } else if (configuration.token.empty()) {
+      configuration.token = arg;
+    } else {
+      return false;
+    }
+  }
+  return !configuration.uri.empty();
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+  LoadgenConfiguration configuration;
+  try {
+    if (!parseArguments(argc, argv, configuration)) {
+      printUsage();
+      return 1;
+    }
+  } catch (const std::logic_error&) {
+    printUsage();
+    return 1;
+  }
+
+  try {
+    std::unique_ptr<StandInService> standInService;
+    std::unique_ptr<grpc::Server> standInServer;
+    if (configuration.standIn) {
+      standInService = std::make_unique<StandInService>(configuration.standInDelay);
+      grpc::ServerBuilder builder;
+      builder.AddListeningPort(configuration.uri, grpc::InsecureServerCredentials());
+      builder.RegisterCallbackGenericService(standInService.get());
+      standInServer = builder.BuildAndStart();
+      if (!standInServer) {
+        throw std::runtime_error("Unable to start the stand-in server on " + configuration.uri);
+      }
+    }
+
+    if (configuration.startupIterations > 0) {
+      runStartupBenchmark(configuration);
+      if (standInServer) {
+        standInServer->Shutdown();
+      }
+      return 0;
+    }
+
+    auto client = BkpClientFactory::create(configuration.uri, configuration.token, configuration.clientOptions);
+    auto workloads = createWorkloads(configuration, client);
+
+    std::cout << "Generating load on " << configuration.uri << (configuration.standIn ? " (stand-in)" : "")
+              << " for " << configuration.duration.count() << "s" << std::endl;
+
+    auto start = Clock::now();
+    auto end = start + configuration.duration;
+    std::vector<WorkloadResult> results(workloads.size());
+    std::vector<std::thread> workloadThreads;
+    for (size_t workloadIndex = 0; workloadIndex < workloads.size(); workloadIndex++) {
+      workloadThreads.emplace_back([&, workloadIndex]() {
+        results[workloadIndex] = runWorkload(workloads[workloadIndex], start, end);
+      });
+    }
+    for (auto& workloadThread : workloadThreads) {
+      workloadThread.join();
+    }
+
+    printHeader("workload");
+    for (size_t workloadIndex = 0; workloadIndex < workloads.size(); workloadIndex++) {
+      printResult(workloads[workloadIndex].name, results[workloadIndex]);
+    }
+
+    for (const auto& [serviceName, state] : client->rateLimiterStates()) {
+      std::cout << "rate limiter " << serviceName << ": " << state.rate << " calls/s, " << state.throttledCalls
+                << " throttled, " << state.rejectedCalls << " rejected, " << state.backoffs << " backoffs" << std::endl;
+    }
+
+    if (standInServer) {
+      standInServer->Shutdown();
+    }
+  } catch (const std::exception& error) {
+    std::cerr << "An error occurred: " << error.what() << std::endl;
+    return 2;
+  }
+
+  return 0;
+}
@@ -0,0 +1,335 @@
+//  Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+//  See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+//  All rights not expressly granted are reserved.
+//
+//  This software is distributed under the terms of the GNU General Public
+//  License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+//  In applying this license CERN does not waive the privileges and immunities
+//  granted to it by virtue of its status as an Intergovernmental Organization
+//  or submit itself to any jurisdiction.
+
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <grpcpp/generic/generic_stub.h>
+#include <grpcpp/grpcpp.h>
+#include "dplProcessExecution.pb.h"
+#include "grpc/IdempotencyKey.h"
+#include "grpc/TrafficCapture.h"
+#include "log.pb.h"
+#include "qcFlag.pb.h"
+
+using o2::bkp::api::grpc::CapturedRequest;
+using o2::bkp::api::grpc::CaptureReader;
+using o2::bkp::api::grpc::createIdempotencyKey;
+using Clock = std::chrono::steady_clock;
+
+namespace
+{
+/// Maximal amount of distinct error messages reported per method
+constexpr size_t MAX_REPORTED_ERRORS = 5;
+
+/// Replay configuration, filled from the command line
+struct ReplayConfiguration {
+  std::string capturePath;
+  std::string uri;
+  std::string token;
+  /// Factor applied to the original pace of the requests, 0 to send them as fast as possible
+  double speed = 1;
+  /// Maximal amount of requests in flight, the next ones waiting for a slot (and falling behind their schedule)
+  uint32_t concurrency = 16;
+};
+
+/// Results of the replayed requests of a method
+struct MethodResult {
+  std::vector<double> latenciesMs;
+  uint64_t errors = 0;
+  std::map<std::string, uint64_t> errorMessages;
+  /// Largest delay between the time a request was scheduled at and the time it was actually sent
+  Clock::duration maxLag{};
+};
+
+/// Request replayed with the gRPC callback API, kept alive until its response is received
+struct ReplayedCall {
+  grpc::ClientContext context;
+  grpc::ByteBuffer request;
+  grpc::ByteBuffer response;
+  std::string method;
+  Clock::time_point sentAt;
+};
+
+/**
+ * Gives new idempotency keys to the replayed creations, which would otherwise be answered by the server from the
+ * responses it remembers for the captured ones instead of being written again
+ *
+ * The retries of a captured creation share its key, their replays share its new key so that they are still applied once.
+ */
+class IdempotencyKeyRenewer
+{
+ public:
+  /// Return the serialized request with a new idempotency key if it is a creation carrying one, unchanged otherwise
+  std::string renew(const std::string& method, const std::string& message)
+  {
+    if (method == "/o2.bookkeeping.QcFlagService/CreateForDataPass") {
+      return renew<o2::bookkeeping::DataPassQcFlagCreationRequest>(message);
+    }
+    if (method == "/o2.bookkeeping.QcFlagService/CreateForSimulationPass") {
+      return renew<o2::bookkeeping::SimulationPassQcFlagCreationRequest>(message);
+    }
+    if (method == "/o2.bookkeeping.QcFlagService/CreateSynchronous") {
+      return renew<o2::bookkeeping::SynchronousQcFlagCreationRequest>(message);
+    }
+    if (method == "/o2.bookkeeping.DplProcessExecutionService/Create") {
+      return renew<o2::bookkeeping::DplProcessExecutionCreationRequest>(message);
+    }
+    if (method == "/o2.bookkeeping.LogService/Create") {
+      return renew<o2::bookkeeping::LogCreationRequest>(message);
+    }
+    return message;
+  }
+
+ private:
+  template <typename Request>
+  std::string renew(const std::string& message)
+  {
+    Request request;
+    if (!request.ParseFromString(message) || !request.has_idempotencykey()) {
+      return message;
+    }
+    auto renewedKey = mRenewedKeys.try_emplace(request.idempotencykey());
+    if (renewedKey.second) {
+      renewedKey.first->second = createIdempotencyKey();
+    }
+    request.set_idempotencykey(renewedKey.first->second);
+    return request.SerializeAsString();
+  }
+
+  /// New key of each captured key
+  std::map<std::string, std::string> mRenewedKeys;
+};
+
+/// Run a function when leaving its scope, whether normally or by an exception
+template <typename Function>
+class ScopeExit
+{
+ public:
+  explicit ScopeExit(Function function) : mFunction(std::move(function)) {}
+  ~ScopeExit() { mFunction(); }
+  ScopeExit(const ScopeExit&) = delete;
+  ScopeExit& operator=(const ScopeExit&) = delete;
+
+ private:
+  Function mFunction;
+};
+
+double percentile(const std::vector<double>& sortedValues, double rank)
+{
+  if (sortedValues.empty()) {
+    return 0;
+  }
+  auto index = static_cast<size_t>(rank * static_cast<double>(sortedValues.size() - 1) + 0.5);
+  return sortedValues[std::min(index, sortedValues.size() - 1)];
+}
+
+void printHeader()
+{
+  std::cout << std::left << std::setw(64) << "method" << std::right
+            << std::setw(10) << "calls" << std::setw(10) << "errors"
+            << std::setw(10) << "p50 ms" << std::setw(10) << "p90 ms" << std::setw(10) << "p99 ms" << std::setw(10) << "max ms"
+            << std::setw(10) << "lag ms" << std::endl;
+}
+
+void printResult(const std::string& method, MethodResult& result)
+{
+  std::sort(result.latenciesMs.begin(), result.latenciesMs.end());
+  auto calls = result.latenciesMs.size() + result.errors;
+
+  std::cout << std::fixed << std::setprecision(2)
+            << std::left << std::setw(64) << method << std::right
+            << std::setw(10) << calls
+            << std::setw(9) << (calls > 0 ? 100.0 * result.errors / calls : 0) << "%"
+            << std::setw(10) << percentile(result.latenciesMs, 0.5)
+            << std::setw(10) << percentile(result.latenciesMs, 0.9)
+            << std::setw(10) << percentile(result.latenciesMs, 0.99)
+            << std::setw(10) << (result.latenciesMs.empty() ? 0 : result.latenciesMs.back())
+            << std::setw(10) << std::chrono::duration<double, std::milli>(result.maxLag).count()
+            << std::endl;
+  size_t reportedErrors = 0;
+  for (const auto& [message, count] : result.errorMessages) {
+    if (reportedErrors++ == MAX_REPORTED_ERRORS) {
+      std::cout << "    ..." << std::endl;
+      break;
+    }
+    std::cout << "    " << count << " x " << message << std::endl;
+  }
+}
+
+/**
+ * Send the captured requests to the configured endpoint, in their original order and at their original pace scaled by
+ * the configured speed
+ *
+ * Scheduling is open-loop, as for bkp-loadgen: a request whose scheduled time is already passed, because the server or
+ * the concurrency limit did not keep up, is sent as soon as possible and the delay is reported as lag.
+ */
+void replay(const ReplayConfiguration& configuration)
+{
+  CaptureReader reader(configuration.capturePath);
+  grpc::GenericStub stub(grpc::CreateChannel(configuration.uri, grpc::InsecureChannelCredentials()));
+
+  std::mutex mutex;
+  std::condition_variable callCompleted;
+  uint32_t inFlight = 0;
+  std::map<std::string, MethodResult> results;
+  auto waitForCallsInFlight = [&]() {
+    std::unique_lock<std::mutex> lock(mutex);
+    callCompleted.wait(lock, [&]() { return inFlight == 0; });
+  };
+  // The callbacks of the calls in flight use the state above, even if reading the capture failed
+  ScopeExit waitOnExit(waitForCallsInFlight);
+
+  std::ostringstream pace;
+  if (configuration.speed > 0) {
+    pace << configuration.speed << "x speed";
+  } else {
+    pace << "full speed";
+  }
+  std::cout << "Replaying " << configuration.capturePath << " on " << configuration.uri << " at " << pace.str() << " with up to "
+            << configuration.concurrency << " requests in flight" << std::endl;
+
+  IdempotencyKeyRenewer idempotencyKeys;
+  auto start = Clock::now();
+  int64_t firstSentAtNs = 0;
+  bool first = true;
+  CapturedRequest capturedRequest;
+  while (reader.next(capturedRequest)) {
+    if (first) {
+      firstSentAtNs = capturedRequest.sentAtNs;
+      first = false;
+    }
+    auto scheduledAt = start;
+    if (configuration.speed > 0) {
+      scheduledAt += std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double, std::nano>((capturedRequest.sentAtNs - firstSentAtNs) / configuration.speed));
+      std::this_thread::sleep_until(scheduledAt);
+    }
+
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      callCompleted.wait(lock, [&]() { return inFlight < std::max<uint32_t>(configuration.concurrency, 1); });
+      inFlight++;
+    }
+
+    auto call = std::make_shared<ReplayedCall>();
+    if (!configuration.token.empty()) {
+      call->context.AddMetadata("authorization", "Bearer " + configuration.token);
+    }
+    grpc::Slice message(idempotencyKeys.renew(capturedRequest.method, capturedRequest.message));
+    call->request = grpc::ByteBuffer(&message, 1);
+    call->method = capturedRequest.method;
+    call->sentAt = Clock::now();
+    if (configuration.speed > 0) {
+      std::lock_guard<std::mutex> lock(mutex);
+      auto& maxLag = results[call->method].maxLag;
+      maxLag = std::max(maxLag, call->sentAt - scheduledAt);
+    }
+
+    stub.UnaryCall(&call->context, call->method, grpc::StubOptions(), &call->request, &call->response, [&, call](grpc::Status status) {
+      auto latency = std::chrono::duration<double, std::milli>(Clock::now() - call->sentAt).count();
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto& result = results[call->method];
+        if (status.ok()) {
+          result.latenciesMs.push_back(latency);
+        } else {
+          result.errors++;
+          result.errorMessages[status.error_message()]++;
+        }
+        inFlight--;
+        // Notified under the lock, as the replay may return as soon as it sees no call in flight
+        callCompleted.notify_one();
+      }
+    });
+  }
+
+  waitForCallsInFlight();
+  auto elapsedSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+  printHeader();
+  uint64_t calls = 0;
+  for (auto& [method, result] : results) {
+    calls += result.latenciesMs.size() + result.errors;
+    printResult(method, result);
+  }
+  std::cout << calls << " requests replayed in " << std::fixed << std::setprecision(2) << elapsedSeconds << "s" << std::endl;
+  if (reader.droppedRequests() > 0) {
+    std::cout << "Warning: " << reader.droppedRequests() << " requests were dropped during the capture and are missing" << std::endl;
+  }
+}
+
+void printUsage()
+{
+  std::cerr
+    << "Usage: bkp-replay <capture file> <gRPC URI> [token] [options]" << std::endl
+    << "  --speed <factor>                   pace of the replay relative to the capture, 0 for full speed (1)" << std::endl
+    << "  --concurrency <requests>           maximal amount of requests in flight (16)" << std::endl
+    << "  Captures are recorded by clients created with the capture.path option" << std::endl;
+}
+
+bool parseArguments(int argc, char** argv, ReplayConfiguration& configuration)
+{
+  for (int argIndex = 1; argIndex < argc; argIndex++) {
+    std::string arg = argv[argIndex];
+    bool hasValue = argIndex + 1 < argc;
+
+    if (arg == "--speed" && hasValue) {
+      configuration.speed = std::stod(argv[++argIndex]);
+    } else if (arg == "--concurrency" && hasValue) {
+      configuration.concurrency = static_cast<uint32_t>(std::stoul(argv[++argIndex]));
+    } else if (configuration.capturePath.empty()) {
+      configuration.capturePath = arg;
+    } else if (configuration.uri.empty()) {
+      configuration.uri = arg;
+    } else if (configuration.token.empty()) {
+      configuration.token = arg;
+    } else {
+      return false;
+    }
+  }
+  return !configuration.uri.empty() && configuration.speed >= 0;
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+  ReplayConfiguration configuration;
+  try {
+    if (!parseArguments(argc, argv, configuration)) {
+      printUsage();
+      return 1;
+    }
+  } catch (const std::logic_error&) {
+    printUsage();
+    return 1;
+  }
+
+  try {
+    replay(configuration);
+  } catch (const std::exception& error) {
+    std::cerr << "An error occurred: " << error.what() << std::endl;
+    return 2;
+  }
+
+  return 0;
+}
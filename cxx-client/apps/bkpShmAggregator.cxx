@@ -0,0 +1,124 @@
+//  Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+//  See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+//  All rights not expressly granted are reserved.
+//
+//  This software is distributed under the terms of the GNU General Public
+//  License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+//  In applying this license CERN does not waive the privileges and immunities
+//  granted to it by virtue of its status as an Intergovernmental Organization
+//  or submit itself to any jurisdiction.
+
+#include <atomic>
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <grp.h>
+#include <grpc++/grpc++.h>
+#include "shm/ShmAggregator.h"
+
+using namespace o2::bkp::api::shm;
+
+namespace
+{
+std::atomic<bool> stopRequested{ false };
+
+void requestStop(int)
+{
+  stopRequested = true;
+}
+
+void printUsage()
+{
+  std::cerr << "Usage: bkp-shm-aggregator <gRPC URI> [token] [--segment <name>] [--slots <count>] [--slot-size <bytes>] [--flush-interval-ms <ms>] [--claim-timeout-ms <ms>] [--group <name>]" << std::endl
+            << "  Clients reach the aggregator by creating their client with the URI shm://<name>, only the daemon's user and the" << std::endl
+            << "  members of the given group can write to it" << std::endl;
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+  std::string uri;
+  std::string token;
+  std::string segmentName = "o2-bookkeeping";
+  uint32_t slotCount = 4096;
+  uint32_t slotSize = 16384;
+  std::chrono::milliseconds flushInterval{ 500 };
+  std::chrono::milliseconds claimTimeout{ 1000 };
+  std::optional<gid_t> group;
+
+  try {
+    for (int argIndex = 1; argIndex < argc; argIndex++) {
+      std::string arg = argv[argIndex];
+      bool hasValue = argIndex + 1 < argc;
+      if (arg == "--segment" && hasValue) {
+        segmentName = argv[++argIndex];
+      } else if (arg == "--slots" && hasValue) {
+        slotCount = std::stoul(argv[++argIndex]);
+      } else if (arg == "--slot-size" && hasValue) {
+        slotSize = std::stoul(argv[++argIndex]);
+      } else if (arg == "--flush-interval-ms" && hasValue) {
+        flushInterval = std::chrono::milliseconds(std::stoul(argv[++argIndex]));
+      } else if (arg == "--claim-timeout-ms" && hasValue) {
+        claimTimeout = std::chrono::milliseconds(std::stoul(argv[++argIndex]));
+      } else if (arg == "--group" && hasValue) {
+        std::string groupName = argv[++argIndex];
+        auto groupEntry = getgrnam(groupName.c_str());
+        if (groupEntry == nullptr) {
+          std::cerr << "Unknown group " << groupName << std::endl;
+          return 1;
+        }
+        group = groupEntry->gr_gid;
+      } else if (uri.empty()) {
+        uri = arg;
+      } else if (token.empty()) {
+        token = arg;
+      } else {
+        printUsage();
+        return 1;
+      }
+    }
+  } catch (const std::logic_error&) {
+    printUsage();
+    return 1;
+  }
+  if (uri.empty()) {
+    printUsage();
+    return 1;
+  }
+
+  std::signal(SIGINT, requestStop);
+  std::signal(SIGTERM, requestStop);
+
+  try {
+    auto shmName = "/" + segmentName;
+    ShmAggregator aggregator(
+      ShmRingBuffer::create(shmName, slotCount, slotSize, claimTimeout, group),
+      uri,
+      [token]() {
+        auto clientContext = std::make_unique<grpc::ClientContext>();
+        if (!token.empty()) {
+          clientContext->AddMetadata("authorization", "Bearer " + token);
+        }
+        return clientContext;
+      },
+      flushInterval);
+
+    std::cout << "Aggregating records from shm://" << segmentName << " to " << uri << std::endl;
+    // The segment is kept, so that a restarted daemon drains the records its producers wrote meanwhile
+    aggregator.run(stopRequested);
+
+    const auto& statistics = aggregator.statistics();
+    std::cout << "Received " << statistics.received << " records, coalesced " << statistics.coalesced
+              << ", forwarded " << statistics.forwarded << " requests, " << statistics.failed << " failures, "
+              << statistics.dropped << " records dropped by full ring, never published or overwritten" << std::endl;
+  } catch (std::exception& error) {
+    std::cerr << "An error occurred: " << error.what() << std::endl;
+    return 2;
+  }
+
+  return 0;
+}
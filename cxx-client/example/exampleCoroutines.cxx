@@ -0,0 +1,120 @@
+//  Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+//  See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+//  All rights not expressly granted are reserved.
+//
+//  This software is distributed under the terms of the GNU General Public
+//  License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+//  In applying this license CERN does not waive the privileges and immunities
+//  granted to it by virtue of its status as an Intergovernmental Organization
+//  or submit itself to any jurisdiction.
+
+
+#include <condition_variable>
+#include <coroutine>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include "BookkeepingApi/BkpClientFactory.h"
+#include "BookkeepingApi/Coroutines.h"
+
+using namespace o2::bkp::api;
+
+/// Minimal single-threaded event loop standing for the one of the calling service
+class EventLoop
+{
+ public:
+  void post(std::function<void()> task)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mTasks.push_back(std::move(task));
+    }
+    mTaskPosted.notify_one();
+  }
+
+  /// Run tasks until the given amount of coroutines completed
+  void runUntil(const int& remaining)
+  {
+    while (remaining > 0) {
+      std::unique_lock<std::mutex> lock(mMutex);
+      mTaskPosted.wait(lock, [this]() { return !mTasks.empty(); });
+      auto task = std::move(mTasks.front());
+      mTasks.pop_front();
+      lock.unlock();
+      task();
+    }
+  }
+
+  coroutines::Executor executor()
+  {
+    return [this](std::function<void()> task) { post(std::move(task)); };
+  }
+
+ private:
+  std::mutex mMutex;
+  std::condition_variable mTaskPosted;
+  std::deque<std::function<void()>> mTasks;
+};
+
+/// Fire-and-forget coroutine type
+struct Detached {
+  struct promise_type {
+    Detached get_return_object() { return {}; }
+    std::suspend_never initial_suspend() noexcept { return {}; }
+    std::suspend_never final_suspend() noexcept { return {}; }
+    void return_void() {}
+    void unhandled_exception() { std::terminate(); }
+  };
+};
+
+Detached updateFlpCounters(BkpClient& client, coroutines::Executor executor, int flpIndex, int& remaining, int& failures)
+{
+  try {
+    co_await coroutines::updateReadoutCountersByFlpNameAndRunNumber(
+      *client.flp(), executor, "FLP-" + std::to_string(flpIndex), 1, 100, 1 << 20, 1 << 19, 1 << 18);
+  } catch (const std::runtime_error& error) {
+    failures++;
+  }
+  remaining--;
+}
+
+Detached createQcFlags(BkpClient& client, coroutines::Executor executor, int& remaining)
+{
+  try {
+    std::vector<QcFlag> qcFlags{ { 2, 1565280000000, 1565287200000, "FT0/Check" } };
+    auto flagIds = co_await coroutines::createForSynchronous(*client.qcFlag(), executor, 55, std::string("FT0"), qcFlags);
+    std::cout << "QC flags created: " << flagIds.size() << std::endl;
+  } catch (const std::runtime_error& error) {
+    std::cerr << "QC flags creation failed: " << error.what() << std::endl;
+  }
+  remaining--;
+}
+
+int main(int argc, char** argv)
+{
+  if (argc < 2) {
+    std::cerr << "You need to provide the gRPC URI as first argument and eventually authentication token as second argument" << std::endl;
+    exit(1);
+  }
+
+  auto client = BkpClientFactory::create(argv[1], argc > 2 ? argv[2] : "");
+  EventLoop eventLoop;
+
+  // Thousand of calls interleaved on the single thread of the event loop
+  constexpr int flpCount = 1000;
+  int remaining = flpCount + 1;
+  int failures = 0;
+  eventLoop.post([&]() {
+    for (int flpIndex = 0; flpIndex < flpCount; flpIndex++) {
+      updateFlpCounters(*client, eventLoop.executor(), flpIndex, remaining, failures);
+    }
+    createQcFlags(*client, eventLoop.executor(), remaining);
+  });
+  eventLoop.runUntil(remaining);
+
+  std::cout << flpCount - failures << " FLP counters updates succeeded, " << failures << " failed" << std::endl;
+  return 0;
+}
@@ -12,12 +12,23 @@
 #ifndef CXX_CLIENT_BOOKKEEPINGAPI_BKPCLIENT_H_
 #define CXX_CLIENT_BOOKKEEPINGAPI_BKPCLIENT_H_
 
+#include <chrono>
+#include <map>
 #include <memory>
+#include <string>
+#include <vector>
 #include "FlpServiceClient.h"
 #include "DplProcessExecutionClient.h"
 #include "QcFlagServiceClient.h"
 #include "CtpTriggerCountersServiceClient.h"
 #include "RunServiceClient.h"
+#include "LhcFillServiceClient.h"
+#include "LogServiceClient.h"
+#include "EnvironmentServiceClient.h"
+#include "RateLimiterState.h"
+#include "CircuitBreakerState.h"
+#include "EndpointState.h"
+#include "ShutdownReport.h"
 
 namespace o2::bkp::api
 {
@@ -44,6 +55,38 @@ class BkpClient
 
   /// Returns the client for runs
   virtual const std::unique_ptr<RunServiceClient>& run() const = 0;
+
+  /// Returns the client for LHC fills
+  virtual const std::unique_ptr<LhcFillServiceClient>& lhcFill() const = 0;
+
+  /// Returns the client for logs
+  virtual const std::unique_ptr<LogServiceClient>& log() const = 0;
+
+  /// Returns the client for environments
+  virtual const std::unique_ptr<EnvironmentServiceClient>& environment() const = 0;
+
+  /// Returns the current state of the client-side rate limiter of each service, indexed by service name
+  virtual std::map<std::string, RateLimiterState> rateLimiterStates() const { return {}; }
+
+  /// Returns the current state of the client-side circuit breakers, open only if those of all the endpoints are
+  virtual CircuitBreakerState circuitBreakerState() const { return CircuitBreakerState::CLOSED; }
+
+  /// Returns the current state of each of the endpoints the calls are balanced over
+  virtual std::vector<EndpointState> endpointStates() const { return {}; }
+
+  /// Wait at most the given budget for the connections to all the endpoints to be established, starting them if needed
+  ///
+  /// @return true if all the connections are ready, calls can still be made if they are not
+  virtual bool waitUntilConnected(std::chrono::milliseconds /* budget */) { return true; }
+
+  /// Stop accepting calls and wait at most until the deadline for the calls in flight to complete
+  ///
+  /// Calls made afterwards fail. The calls in flight, asynchronous ones waiting for their turn or retry included, are
+  /// cancelled if they did not complete by the deadline, server streams only reading from bookkeeping are cancelled
+  /// right away. The destructor of a client shuts it down if this has not been done, see ShutdownOptions.
+  ///
+  /// @return the report of the calls abandoned at the deadline
+  virtual ShutdownReport shutdown(std::chrono::system_clock::time_point /* deadline */) { return {}; }
 };
 } // namespace o2::bkp::api
 
@@ -17,6 +17,7 @@
 #define CXX_CLIENT_BOOKKEEPINGAPI_BKPCLIENTFACTORY_H
 
 #include "BookkeepingApi/BkpClient.h"
+#include "BookkeepingApi/BkpClientOptions.h"
 
 namespace o2::bkp::api
 {
@@ -27,10 +28,33 @@ class BkpClientFactory
   BkpClientFactory() = delete;
 
   /// Provides a Bookkeeping API client configured from a given configuration URI without authentication
+  ///
+  /// A URI of the form `shm://<segment-name>` provides a client writing to the node-local shared memory ring drained by
+  /// the `bkp-shm-aggregator` daemon instead of opening a gRPC connection
+  ///
+  /// A comma-separated list of endpoints (`host1:port,host2:port`) provides a client balancing its calls over them and
+  /// ejecting the failing ones
   static std::unique_ptr<BkpClient> create(const std::string& gRPCUri);
 
   /// Provides a Bookkeeping API client configured from a given configuration URI using an authentication token
   static std::unique_ptr<BkpClient> create(const std::string& gRPCUri, const std::string& token);
+
+  /// Provides a Bookkeeping API client configured from a given configuration URI and options, using an authentication
+  /// token if it is not empty
+  static std::unique_ptr<BkpClient> create(const std::string& gRPCUri, const std::string& token, const BkpClientOptions& options);
+
+  /// Provides a Bookkeeping API client shared by all the callers of the process using the same URI and token
+  ///
+  /// The client, its connections and its background threads are created by the first call and destroyed when the last
+  /// handle is released. As the client is shared, so are its rate limiters and circuit breakers. If the shared client
+  /// already exists it is returned whatever the options it was created with, otherwise it uses the default options.
+  static std::shared_ptr<BkpClient> shared(const std::string& gRPCUri, const std::string& token = "");
+
+  /// Same as above, creating the shared client with the given options if it does not exist yet
+  ///
+  /// Throws std::invalid_argument if the shared client already exists with different options. Callbacks can not be
+  /// compared, only whether each of them is set is.
+  static std::shared_ptr<BkpClient> shared(const std::string& gRPCUri, const std::string& token, const BkpClientOptions& options);
 };
 } // namespace o2::bkp::api
 
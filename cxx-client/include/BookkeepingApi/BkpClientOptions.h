@@ -0,0 +1,190 @@
+//  Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+//  See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+//  All rights not expressly granted are reserved.
+//
+//  This software is distributed under the terms of the GNU General Public
+//  License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+//  In applying this license CERN does not waive the privileges and immunities
+//  granted to it by virtue of its status as an Intergovernmental Organization
+//  or submit itself to any jurisdiction.
+
+#ifndef CXX_CLIENT_BOOKKEEPINGAPI_BKPCLIENTOPTIONS_H
+#define CXX_CLIENT_BOOKKEEPINGAPI_BKPCLIENTOPTIONS_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include "CallTiming.h"
+#include "ConnectivityState.h"
+#include "ShutdownReport.h"
+
+namespace o2::bkp::api
+{
+/// Configuration of the per-service adaptive rate limiter
+///
+/// Each service uses a token bucket whose rate is decreased multiplicatively when the server reports overload
+/// (RESOURCE_EXHAUSTED, UNAVAILABLE or DEADLINE_EXCEEDED) and increased additively by successful calls. Disabled by
+/// default, as it caps the throughput of the client and makes calls fail client-side once they wait longer than maxWait.
+struct RateLimiterOptions {
+  bool enabled = false;
+  /// Rate, in calls per second, used when the client is created
+  double initialRate = 500;
+  double minRate = 1;
+  double maxRate = 500;
+  /// Maximal amount of calls that can be done at once after an idle period
+  double burst = 100;
+  /// Rate increase, in calls per second, gained every second of successful calls
+  double additiveIncrease = 10;
+  /// Factor applied to the rate when the server reports overload
+  double multiplicativeDecrease = 0.5;
+  /// Calls that would have to wait longer than this for a token fail immediately without reaching the server
+  std::chrono::milliseconds maxWait{ 2000 };
+};
+
+/// Configuration of the circuit breakers of a client, one per endpoint shared by all the services
+///
+/// After failureThreshold consecutive calls to an endpoint failed because it is unreachable (UNAVAILABLE or
+/// DEADLINE_EXCEEDED), its breaker opens and its calls go to the other endpoints. Once all of them are open, calls fail
+/// immediately without using the network. Once openDuration elapsed, a single probe call is let through to the endpoint
+/// (half-open state), waiting at most probeTimeout for the connection to be re-established: its success closes the
+/// breaker, its failure opens it again for openDuration. Disabled by default, as it makes calls fail that would
+/// otherwise have waited for the server to come back.
+struct CircuitBreakerOptions {
+  bool enabled = false;
+  uint32_t failureThreshold = 5;
+  std::chrono::milliseconds openDuration{ 5000 };
+  std::chrono::milliseconds probeTimeout{ 2000 };
+  /// If set, called with the service and method names instead of throwing when a call is refused by the open breaker.
+  /// The call then returns normally with a default response (for example no created QC flags ids). Reads, such as
+  /// fetching runs, still throw as their default response would be taken for bookkeeping data.
+  std::function<void(const std::string& serviceName, const std::string& methodName)> fallback;
+};
+
+/// Configuration of the traffic classes of a client
+///
+/// Run, DPL process execution and QC flag calls are critical, FLP and CTP counters updates are bulk traffic. When
+/// enabled, each class uses its own connection so that critical calls never queue behind counters on the wire, critical
+/// calls are always dispatched immediately and bulk calls are limited to a number in flight, reduced while critical calls
+/// are in flight. Disabled by default, as it doubles the connections of the client to each endpoint.
+struct PriorityLanesOptions {
+  bool enabled = false;
+  uint32_t maxBulkInFlight = 8;
+  uint32_t maxBulkInFlightDuringCritical = 1;
+};
+
+/// Configuration of the balancing of the calls over several endpoints
+///
+/// Each call goes to the endpoint with the least calls in flight. After ejectionFailureThreshold consecutive calls to an
+/// endpoint failed because it is unreachable or took longer than slowCallThreshold, the endpoint is ejected for
+/// ejectionDuration, then reinstated once a probe (every probeInterval) finds its connection ready.
+struct LoadBalancingOptions {
+  uint32_t ejectionFailureThreshold = 3;
+  /// Calls taking longer than this count as failures of their endpoint, 0 to disable
+  std::chrono::milliseconds slowCallThreshold{ 5000 };
+  std::chrono::milliseconds ejectionDuration{ 10000 };
+  std::chrono::milliseconds probeInterval{ 1000 };
+};
+
+/// Configuration of the retries of failed calls
+///
+/// Calls failing because the server is unreachable (UNAVAILABLE or DEADLINE_EXCEEDED) are sent again up to maxAttempts
+/// times in total, waiting initialBackoff before the first retry and backoffMultiplier times longer before each next
+/// one. Only the calls safe to send again are retried by default: reads, and the logs, QC flags and DPL process
+/// executions creation requests. Those carry an idempotency key and their retries are sent to the endpoint of their
+/// first attempt, whose server only applies once the requests with the same key it received within its deduplication
+/// window. Such a creation is applied twice only if that server restarted between its attempts.
+struct RetryOptions {
+  uint32_t maxAttempts = 3;
+  std::chrono::milliseconds initialBackoff{ 100 };
+  double backoffMultiplier = 2;
+  /// Also retry the other writes, which the server may have applied although the call failed. Updates set absolute
+  /// values and are safe to repeat, while counters updates may be counted twice. Environments, runs and FLPs are unique
+  /// by their identifier: they can not be created twice, but a retried creation whose first attempt was applied fails as
+  /// already existing (except for environments, whose creation then succeeds).
+  bool retryWritesWithoutKey = false;
+};
+
+/// Configuration of the connections of a client to its endpoints
+///
+/// Connections are established on the first call by default, which then pays for name resolution, TCP and HTTP/2 setup.
+/// With prewarm, they are started in the background as soon as the client is created, see also
+/// BkpClient::waitUntilConnected to bound the wait for them.
+struct ConnectionOptions {
+  bool prewarm = false;
+  /// If set, called from a client thread with the endpoint URI whenever its (critical lane) connection changes state
+  std::function<void(const std::string& uri, ConnectivityState state)> onStateChange;
+};
+
+/// Configuration of the tracing of the calls
+///
+/// When enabled, every call carries a W3C trace context in its traceparent metadata, with which the server records the
+/// spans of its own stages. Calls made within a TraceScope are part of the caller's trace and follow its sampling
+/// decision, the other ones start a new trace sampled with a probability of sampleRatio. The client span of each
+/// attempt of a sampled call is appended as a JSON line to exportPath, by a background thread writing every
+/// flushInterval: spans reported while maxBufferedSpans are already waiting are dropped rather than slowing the call.
+struct TracingOptions {
+  bool enabled = false;
+  double sampleRatio = 0.01;
+  /// File the client spans are appended to, if empty the trace context is only propagated to the server
+  std::string exportPath;
+  std::chrono::milliseconds flushInterval{ 1000 };
+  size_t maxBufferedSpans = 10000;
+};
+
+/// Configuration of the capture of the traffic of a client, to replay it later with bkp-replay
+///
+/// When a path is given, the request of every attempt of every unary call is appended to this file with its method and
+/// send time, in a length-prefixed binary format. Requests are captured in the form serialized for sending, without
+/// their metadata, and written by a background thread every flushInterval: requests captured while maxBufferedBytes are
+/// already waiting to be written are dropped rather than slowing the calls, the file recording how many were.
+///
+/// A capture file is written by a single client: creating a client capturing to a file another one is still capturing
+/// to fails. If writing the file fails, the capture stops and onError is called once with the reason.
+struct CaptureOptions {
+  std::string path;
+  size_t maxBufferedBytes = 64 * 1024 * 1024;
+  std::chrono::milliseconds flushInterval{ 1000 };
+  /// If set, called from the capture thread when the capture stops because its file could not be written
+  std::function<void(const std::string& error)> onError;
+};
+
+/// Configuration of the reporting of the timing of the calls
+///
+/// Bookkeeping reports in the trailers of every call the time it waited for a database connection, authenticated the
+/// call, ran its handler and ran database queries. With the duration seen by the client, this timing is available to
+/// the caller through CallTiming::last and given to onCall for every attempt, for example to feed client-side metrics.
+struct CallTimingOptions {
+  /// If set, called from the thread completing the attempt, so it must return quickly
+  std::function<void(const std::string& serviceName, const std::string& methodName, const CallTiming& timing)> onCall;
+};
+
+/// Configuration of the shutdown of a client when it is destroyed
+///
+/// The destructor runs BkpClient::shutdown with a deadline budget after its start, so that the calls still in flight,
+/// asynchronous ones included, are completed before the process exits. If some of them are abandoned at the deadline,
+/// onAbandoned is called with the report of the shutdown. A client destroyed by the callback of one of its asynchronous
+/// calls, for instance when that callback drops the last handle to it, does not wait for that call.
+struct ShutdownOptions {
+  std::chrono::milliseconds budget{ 5000 };
+  std::function<void(const ShutdownReport& report)> onAbandoned;
+};
+
+/// Options used to create bookkeeping API clients
+struct BkpClientOptions {
+  RateLimiterOptions rateLimiter;
+  CircuitBreakerOptions circuitBreaker;
+  PriorityLanesOptions priorityLanes;
+  LoadBalancingOptions loadBalancing;
+  RetryOptions retry;
+  ConnectionOptions connection;
+  TracingOptions tracing;
+  CaptureOptions capture;
+  ShutdownOptions shutdown;
+  CallTimingOptions callTiming;
+};
+} // namespace o2::bkp::api
+
+#endif // CXX_CLIENT_BOOKKEEPINGAPI_BKPCLIENTOPTIONS_H
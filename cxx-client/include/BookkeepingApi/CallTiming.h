@@ -0,0 +1,54 @@
+//  Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+//  See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+//  All rights not expressly granted are reserved.
+//
+//  This software is distributed under the terms of the GNU General Public
+//  License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+//  In applying this license CERN does not waive the privileges and immunities
+//  granted to it by virtue of its status as an Intergovernmental Organization
+//  or submit itself to any jurisdiction.
+
+#ifndef CXX_CLIENT_BOOKKEEPINGAPI_CALLTIMING_H
+#define CXX_CLIENT_BOOKKEEPINGAPI_CALLTIMING_H
+
+#include <chrono>
+#include <optional>
+
+namespace o2::bkp::api
+{
+/// Time spent by bookkeeping handling a call, as reported in the trailers of the call
+struct ServerTiming {
+  /// Waiting for a database connection, part of handler
+  std::chrono::microseconds queue{};
+  /// Authenticating the call
+  std::chrono::microseconds auth{};
+  /// Running the handler of the call, database queries included
+  std::chrono::microseconds handler{};
+  /// Running database queries, part of handler
+  std::chrono::microseconds db{};
+};
+
+/// Timing of an attempt of a call, seen from both ends
+struct CallTiming {
+  /// Duration of the attempt seen by the client, from the time it was sent to its completion
+  std::chrono::microseconds total{};
+  /// Timing reported by bookkeeping, none if the call did not reach its handlers or the server does not report it
+  std::optional<ServerTiming> server;
+
+  /// Part of total spent outside of the server handling (network, serialization, client side), if the server reported it
+  std::optional<std::chrono::microseconds> outsideServer() const
+  {
+    if (!server.has_value()) {
+      return std::nullopt;
+    }
+    return total - server->auth - server->handler;
+  }
+
+  /// Timing of the last attempt of the last call completed by the current thread: the blocking call which returned
+  /// last, or the asynchronous call whose completion is being run
+  static const CallTiming& last();
+};
+} // namespace o2::bkp::api
+
+#endif // CXX_CLIENT_BOOKKEEPINGAPI_CALLTIMING_H
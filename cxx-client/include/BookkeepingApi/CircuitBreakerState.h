@@ -0,0 +1,28 @@
+//  Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+//  See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+//  All rights not expressly granted are reserved.
+//
+//  This software is distributed under the terms of the GNU General Public
+//  License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+//  In applying this license CERN does not waive the privileges and immunities
+//  granted to it by virtue of its status as an Intergovernmental Organization
+//  or submit itself to any jurisdiction.
+
+#ifndef CXX_CLIENT_BOOKKEEPINGAPI_CIRCUITBREAKERSTATE_H
+#define CXX_CLIENT_BOOKKEEPINGAPI_CIRCUITBREAKERSTATE_H
+
+namespace o2::bkp::api
+{
+/// State of the client-side circuit breaker
+enum class CircuitBreakerState {
+  /// Calls reach the server normally
+  CLOSED,
+  /// The server is considered unreachable, calls fail immediately
+  OPEN,
+  /// A probe call is checking whether the server is reachable again
+  HALF_OPEN,
+};
+} // namespace o2::bkp::api
+
+#endif // CXX_CLIENT_BOOKKEEPINGAPI_CIRCUITBREAKERSTATE_H
@@ -0,0 +1,58 @@
+//  Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+//  See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+//  All rights not expressly granted are reserved.
+//
+//  This software is distributed under the terms of the GNU General Public
+//  License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+//  In applying this license CERN does not waive the privileges and immunities
+//  granted to it by virtue of its status as an Intergovernmental Organization
+//  or submit itself to any jurisdiction.
+
+
+#ifndef CXX_CLIENT_BOOKKEEPINGAPI_COMPLETION_H
+#define CXX_CLIENT_BOOKKEEPINGAPI_COMPLETION_H
+
+#include <exception>
+#include <functional>
+
+namespace o2::bkp::api
+{
+/// Callback receiving the outcome of an asynchronous call, error is null if the call succeeded
+///
+/// It may be called from a gRPC thread and must return quickly: hand the outcome to the caller's own executor instead
+/// of processing it in place.
+using Completion = std::function<void(std::exception_ptr error)>;
+
+/// Callback receiving the result of an asynchronous call, result is meaningful only if error is null
+template <typename Result>
+using ResultCompletion = std::function<void(Result result, std::exception_ptr error)>;
+
+/// Run a blocking call and report its outcome to the given completion, used by clients with no asynchronous transport
+inline void completeInline(const std::function<void()>& call, const Completion& onDone)
+{
+  std::exception_ptr error;
+  try {
+    call();
+  } catch (...) {
+    error = std::current_exception();
+  }
+  onDone(error);
+}
+
+/// Run a blocking call and report its result to the given completion, used by clients with no asynchronous transport
+template <typename Result>
+void completeInline(const std::function<Result()>& call, const ResultCompletion<Result>& onDone)
+{
+  Result result{};
+  std::exception_ptr error;
+  try {
+    result = call();
+  } catch (...) {
+    error = std::current_exception();
+  }
+  onDone(std::move(result), error);
+}
+} // namespace o2::bkp::api
+
+#endif // CXX_CLIENT_BOOKKEEPINGAPI_COMPLETION_H
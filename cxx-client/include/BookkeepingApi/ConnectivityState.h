@@ -0,0 +1,33 @@
+//  Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+//  See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+//  All rights not expressly granted are reserved.
+//
+//  This software is distributed under the terms of the GNU General Public
+//  License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+//  In applying this license CERN does not waive the privileges and immunities
+//  granted to it by virtue of its status as an Intergovernmental Organization
+//  or submit itself to any jurisdiction.
+
+
+#ifndef CXX_CLIENT_BOOKKEEPINGAPI_CONNECTIVITYSTATE_H
+#define CXX_CLIENT_BOOKKEEPINGAPI_CONNECTIVITYSTATE_H
+
+namespace o2::bkp::api
+{
+/// State of the connection to a bookkeeping endpoint
+enum class ConnectivityState {
+  /// No connection has been attempted yet, or it has been closed for inactivity
+  IDLE,
+  /// The connection is being established
+  CONNECTING,
+  /// The connection is established and calls can be sent
+  READY,
+  /// The connection failed, it will be attempted again after a backoff
+  TRANSIENT_FAILURE,
+  /// The client is being destroyed
+  SHUTDOWN,
+};
+} // namespace o2::bkp::api
+
+#endif // CXX_CLIENT_BOOKKEEPINGAPI_CONNECTIVITYSTATE_H
@@ -0,0 +1,250 @@
+//  Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+//  See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+//  All rights not expressly granted are reserved.
+//
+//  This software is distributed under the terms of the GNU General Public
+//  License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+//  In applying this license CERN does not waive the privileges and immunities
+//  granted to it by virtue of its status as an Intergovernmental Organization
+//  or submit itself to any jurisdiction.
+
+
+#ifndef CXX_CLIENT_BOOKKEEPINGAPI_COROUTINES_H
+#define CXX_CLIENT_BOOKKEEPINGAPI_COROUTINES_H
+
+#if !defined(__cpp_impl_coroutine) || !__has_include(<coroutine>)
+#error "BookkeepingApi/Coroutines.h requires a compiler with C++20 coroutines support"
+#endif
+
+#include <atomic>
+#include <coroutine>
+#include <exception>
+#include <functional>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <variant>
+#include <vector>
+#include "BkpClient.h"
+#include "Completion.h"
+
+/**
+ * Awaitable wrappers of the asynchronous methods of the service clients
+ *
+ * The library itself is built with C++17, this header only requires C++20 from the code including it. A coroutine
+ * awaiting a call is suspended without blocking its thread, and is resumed through the given executor once the call
+ * completed, so that it continues on the caller's event loop instead of a gRPC thread.
+ */
+namespace o2::bkp::api::coroutines
+{
+/// Post a function to the caller's event loop, used to resume the awaiting coroutines
+using Executor = std::function<void(std::function<void()>)>;
+
+/// Awaitable outcome of an asynchronous call, co_await returns its result or throws its error
+template <typename Result = void>
+class Awaitable
+{
+  using Value = std::conditional_t<std::is_void_v<Result>, std::monostate, Result>;
+
+ public:
+  /// Start the call, the given callback must be called exactly once with its outcome
+  using Start = std::function<void(std::function<void(Value, std::exception_ptr)>)>;
+
+  Awaitable(Executor executor, Start start) : mExecutor(std::move(executor)), mStart(std::move(start)) {}
+
+  Awaitable(const Awaitable&) = delete;
+  Awaitable& operator=(const Awaitable&) = delete;
+
+  bool await_ready() const noexcept
+  {
+    return false;
+  }
+
+  bool await_suspend(std::coroutine_handle<> handle)
+  {
+    mHandle = handle;
+    mStart([this](Value value, std::exception_ptr error) {
+      mValue.emplace(std::move(value));
+      mError = error;
+      // Once the exchange is done the coroutine may be resumed, and this awaitable destroyed with its frame, at any time
+      auto executor = mExecutor;
+      auto suspended = mHandle;
+      // The last one of the completion and await_suspend resumes the coroutine
+      if (mCompletedOrSuspended.exchange(true, std::memory_order_acq_rel)) {
+        executor([suspended]() { suspended.resume(); });
+      }
+    });
+    // Completed synchronously: do not suspend at all
+    return !mCompletedOrSuspended.exchange(true, std::memory_order_acq_rel);
+  }
+
+  Result await_resume()
+  {
+    if (mError) {
+      std::rethrow_exception(mError);
+    }
+    if constexpr (!std::is_void_v<Result>) {
+      return std::move(*mValue);
+    }
+  }
+
+ private:
+  Executor mExecutor;
+  Start mStart;
+  std::coroutine_handle<> mHandle;
+  std::atomic<bool> mCompletedOrSuspended{ false };
+  std::optional<Value> mValue;
+  std::exception_ptr mError;
+};
+
+/// Awaitable of a call reporting to a Completion
+template <typename StartCall>
+Awaitable<> awaitCompletion(Executor executor, StartCall startCall)
+{
+  return Awaitable<>(std::move(executor), [startCall = std::move(startCall)](auto onOutcome) {
+    startCall([onOutcome = std::move(onOutcome)](std::exception_ptr error) { onOutcome({}, error); });
+  });
+}
+
+/// Awaitable of a call reporting to a ResultCompletion
+template <typename Result, typename StartCall>
+Awaitable<Result> awaitResult(Executor executor, StartCall startCall)
+{
+  return Awaitable<Result>(std::move(executor), [startCall = std::move(startCall)](auto onOutcome) {
+    startCall(ResultCompletion<Result>(std::move(onOutcome)));
+  });
+}
+
+/// Awaitable version of FlpServiceClient::updateReadoutCountersByFlpNameAndRunNumber
+inline Awaitable<> updateReadoutCountersByFlpNameAndRunNumber(
+  FlpServiceClient& client,
+  Executor executor,
+  std::string flpName,
+  int32_t runNumber,
+  uint64_t nSubtimeframes,
+  uint64_t nEquipmentBytes,
+  uint64_t nRecordingBytes,
+  uint64_t nFairMQBytes)
+{
+  return awaitCompletion(std::move(executor), [=, &client](Completion onDone) {
+    client.updateReadoutCountersByFlpNameAndRunNumberAsync(flpName, runNumber, nSubtimeframes, nEquipmentBytes, nRecordingBytes, nFairMQBytes, std::move(onDone));
+  });
+}
+
+/// Awaitable version of CtpTriggerCountersServiceClient::createOrUpdateForRun
+inline Awaitable<> createOrUpdateForRun(
+  CtpTriggerCountersServiceClient& client,
+  Executor executor,
+  uint32_t runNumber,
+  std::string className,
+  int64_t timestamp,
+  uint64_t lmb,
+  uint64_t lma,
+  uint64_t l0b,
+  uint64_t l0a,
+  uint64_t l1b,
+  uint64_t l1a)
+{
+  return awaitCompletion(std::move(executor), [=, &client](Completion onDone) {
+    client.createOrUpdateForRunAsync(runNumber, className, timestamp, lmb, lma, l0b, l0a, l1b, l1a, std::move(onDone));
+  });
+}
+
+/// Awaitable version of DplProcessExecutionClient::registerProcessExecution
+inline Awaitable<> registerProcessExecution(
+  DplProcessExecutionClient& client,
+  Executor executor,
+  int runNumber,
+  o2::bkp::DplProcessType type,
+  std::string hostname,
+  std::string deviceId,
+  std::string args,
+  std::string detector)
+{
+  return awaitCompletion(std::move(executor), [=, &client](Completion onDone) {
+    client.registerProcessExecutionAsync(runNumber, type, hostname, deviceId, args, detector, std::move(onDone));
+  });
+}
+
+/// Awaitable version of RunServiceClient::setRawCtpTriggerConfiguration
+inline Awaitable<> setRawCtpTriggerConfiguration(RunServiceClient& client, Executor executor, int runNumber, std::string rawCtpTriggerConfiguration)
+{
+  return awaitCompletion(std::move(executor), [=, &client](Completion onDone) {
+    client.setRawCtpTriggerConfigurationAsync(runNumber, rawCtpTriggerConfiguration, std::move(onDone));
+  });
+}
+
+/// Awaitable version of RunServiceClient::get, co_await returns the fetched run
+inline Awaitable<Run> get(RunServiceClient& client, Executor executor, int runNumber, std::vector<RunField> fields = {}, bool withLhcFill = false)
+{
+  return awaitResult<Run>(std::move(executor), [=, &client](ResultCompletion<Run> onDone) {
+    client.getAsync(runNumber, fields, withLhcFill, std::move(onDone));
+  });
+}
+
+/// Awaitable version of LogServiceClient::createLog, co_await returns the id of the created log
+inline Awaitable<int> createLog(
+  LogServiceClient& client,
+  Executor executor,
+  std::string title,
+  std::string text,
+  std::vector<int> runNumbers = {},
+  std::optional<int> parentLogId = std::nullopt)
+{
+  return awaitResult<int>(std::move(executor), [=, &client](ResultCompletion<int> onDone) {
+    client.createLogAsync(title, text, runNumbers, parentLogId, std::move(onDone));
+  });
+}
+
+/// Awaitable version of EnvironmentServiceClient::updateStatus
+inline Awaitable<> updateStatus(EnvironmentServiceClient& client, Executor executor, std::string id, std::string status, std::optional<std::string> statusMessage = std::nullopt)
+{
+  return awaitCompletion(std::move(executor), [=, &client](Completion onDone) {
+    client.updateStatus(id, status, statusMessage, std::move(onDone));
+  });
+}
+
+/// Awaitable version of QcFlagServiceClient::createForDataPass, co_await returns the created flags ids
+inline Awaitable<std::vector<int>> createForDataPass(
+  QcFlagServiceClient& client,
+  Executor executor,
+  uint32_t runNumber,
+  std::string passName,
+  std::string detectorName,
+  std::vector<QcFlag> qcFlags)
+{
+  return awaitResult<std::vector<int>>(std::move(executor), [=, &client](ResultCompletion<std::vector<int>> onDone) {
+    client.createForDataPassAsync(runNumber, passName, detectorName, qcFlags, std::move(onDone));
+  });
+}
+
+/// Awaitable version of QcFlagServiceClient::createForSimulationPass, co_await returns the created flags ids
+inline Awaitable<std::vector<int>> createForSimulationPass(
+  QcFlagServiceClient& client,
+  Executor executor,
+  uint32_t runNumber,
+  std::string productionName,
+  std::string detectorName,
+  std::vector<QcFlag> qcFlags)
+{
+  return awaitResult<std::vector<int>>(std::move(executor), [=, &client](ResultCompletion<std::vector<int>> onDone) {
+    client.createForSimulationPassAsync(runNumber, productionName, detectorName, qcFlags, std::move(onDone));
+  });
+}
+
+/// Awaitable version of QcFlagServiceClient::createForSynchronous, co_await returns the created flags ids
+inline Awaitable<std::vector<int>> createForSynchronous(
+  QcFlagServiceClient& client,
+  Executor executor,
+  uint32_t runNumber,
+  std::string detectorName,
+  std::vector<QcFlag> qcFlags)
+{
+  return awaitResult<std::vector<int>>(std::move(executor), [=, &client](ResultCompletion<std::vector<int>> onDone) {
+    client.createForSynchronousAsync(runNumber, detectorName, qcFlags, std::move(onDone));
+  });
+}
+} // namespace o2::bkp::api::coroutines
+
+#endif // CXX_CLIENT_BOOKKEEPINGAPI_COROUTINES_H
@@ -17,6 +17,7 @@
 
 #include <string>
 #include <cstdint>
+#include "Completion.h"
 
 namespace o2::bkp::api
 {
@@ -36,6 +37,24 @@ class CtpTriggerCountersServiceClient
     uint64_t l0a,
     uint64_t l1b,
     uint64_t l1a) = 0;
+
+  /// Asynchronous version of createOrUpdateForRun, onDone receives the outcome of the call
+  ///
+  /// The default implementation runs the blocking call and completes before returning
+  virtual void createOrUpdateForRunAsync(
+    uint32_t runNumber,
+    const std::string& className,
+    int64_t timestamp,
+    uint64_t lmb,
+    uint64_t lma,
+    uint64_t l0b,
+    uint64_t l0a,
+    uint64_t l1b,
+    uint64_t l1a,
+    Completion onDone)
+  {
+    completeInline([&]() { createOrUpdateForRun(runNumber, className, timestamp, lmb, lma, l0b, l0a, l1b, l1a); }, onDone);
+  }
 };
 } // namespace o2::bkp::api
 
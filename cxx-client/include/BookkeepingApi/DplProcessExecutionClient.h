@@ -13,7 +13,9 @@
 #define CXX_CLIENT_BOOKKEEPINGAPI_DPLPROCESSEXECUTIONCLIENT_H
 
 #include <memory>
+#include <string>
 #include "DplProcessType.h"
+#include "Completion.h"
 
 namespace o2::bkp::api
 {
@@ -31,6 +33,21 @@ class DplProcessExecutionClient
     std::string args,
     std::string detector
   ) = 0;
+
+  /// Asynchronous version of registerProcessExecution, onDone receives the outcome of the call
+  ///
+  /// The default implementation runs the blocking call and completes before returning
+  virtual void registerProcessExecutionAsync(
+    int runNumber,
+    o2::bkp::DplProcessType type,
+    std::string hostname,
+    std::string deviceId,
+    std::string args,
+    std::string detector,
+    Completion onDone)
+  {
+    completeInline([&]() { registerProcessExecution(runNumber, type, hostname, deviceId, args, detector); }, onDone);
+  }
 };
 } // namespace o2::bkp::api::proto
 
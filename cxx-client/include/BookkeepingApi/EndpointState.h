@@ -0,0 +1,38 @@
+//  Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+//  See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+//  All rights not expressly granted are reserved.
+//
+//  This software is distributed under the terms of the GNU General Public
+//  License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+//  In applying this license CERN does not waive the privileges and immunities
+//  granted to it by virtue of its status as an Intergovernmental Organization
+//  or submit itself to any jurisdiction.
+
+
+#ifndef CXX_CLIENT_BOOKKEEPINGAPI_ENDPOINTSTATE_H
+#define CXX_CLIENT_BOOKKEEPINGAPI_ENDPOINTSTATE_H
+
+#include <cstdint>
+#include <string>
+
+namespace o2::bkp::api
+{
+/// Snapshot of one of the bookkeeping endpoints a client balances its calls over
+struct EndpointState {
+  /// URI of the endpoint
+  std::string uri;
+  /// Number of calls currently in flight on this endpoint
+  uint32_t outstandingCalls;
+  /// True if the endpoint is currently ejected because it failed or was too slow
+  bool ejected;
+  /// Number of calls sent to this endpoint
+  uint64_t calls;
+  /// Number of these calls that failed because the endpoint was unreachable or too slow
+  uint64_t failedCalls;
+  /// Number of times the endpoint has been ejected
+  uint64_t ejections;
+};
+} // namespace o2::bkp::api
+
+#endif // CXX_CLIENT_BOOKKEEPINGAPI_ENDPOINTSTATE_H
@@ -0,0 +1,82 @@
+//  Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+//  See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+//  All rights not expressly granted are reserved.
+//
+//  This software is distributed under the terms of the GNU General Public
+//  License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+//  In applying this license CERN does not waive the privileges and immunities
+//  granted to it by virtue of its status as an Intergovernmental Organization
+//  or submit itself to any jurisdiction.
+
+
+#ifndef CXX_CLIENT_BOOKKEEPINGAPI_ENVIRONMENTSERVICECLIENT_H
+#define CXX_CLIENT_BOOKKEEPINGAPI_ENVIRONMENTSERVICECLIENT_H
+
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include "Completion.h"
+
+namespace o2::bkp::api
+{
+class EnvironmentServiceClient
+{
+ public:
+  virtual ~EnvironmentServiceClient() = default;
+
+  /// Create an environment
+  ///
+  /// A creation retried after its first attempt was applied by bookkeeping succeeds, as would any creation retried
+  /// while another client created the same environment.
+  ///
+  /// @param rawConfiguration the full configuration of the environment, only sent at creation (compressed by the gRPC
+  ///                         transport)
+  virtual void create(std::string id, std::string rawConfiguration, std::optional<std::string> status = std::nullopt, std::optional<std::string> statusMessage = std::nullopt)
+  {
+    (void)id;
+    (void)rawConfiguration;
+    (void)status;
+    (void)statusMessage;
+    throw std::runtime_error("Creating environments is not supported by this client");
+  }
+
+  /// Asynchronous version of create, onDone receives the outcome of the call
+  ///
+  /// The default implementation runs the blocking call and completes before returning
+  virtual void createAsync(std::string id, std::string rawConfiguration, std::optional<std::string> status, std::optional<std::string> statusMessage, Completion onDone)
+  {
+    completeInline([&]() { create(id, rawConfiguration, status, statusMessage); }, onDone);
+  }
+
+  /// Set the status of an environment, each call being sent to bookkeeping and recorded in the environment history
+  virtual void update(std::string id, std::string status, std::optional<std::string> statusMessage = std::nullopt)
+  {
+    (void)id;
+    (void)status;
+    (void)statusMessage;
+    throw std::runtime_error("Updating environments is not supported by this client");
+  }
+
+  /// Report the latest status of an environment, without blocking
+  ///
+  /// At most one update per environment is in flight: the statuses reported meanwhile replace each other and only the
+  /// latest is sent once the previous update completed, and a status identical to the last one sent is not sent again
+  /// (unless the environment has been created or updated through create or update since).
+  /// The statuses replaced this way are missing from the environment history, use update to record every transition.
+  ///
+  /// The default implementation runs the blocking update and completes before returning
+  ///
+  /// @param onDone if set, called with the outcome of the update which sent this status, or the one replacing it
+  virtual void updateStatus(std::string id, std::string status, std::optional<std::string> statusMessage = std::nullopt, Completion onDone = {})
+  {
+    completeInline([&]() { update(id, status, statusMessage); }, [&](std::exception_ptr error) {
+      if (onDone) {
+        onDone(error);
+      }
+    });
+  }
+};
+} // namespace o2::bkp::api
+
+#endif // CXX_CLIENT_BOOKKEEPINGAPI_ENVIRONMENTSERVICECLIENT_H
@@ -18,6 +18,7 @@
 
 #include <string>
 #include <cstdint>
+#include "Completion.h"
 
 namespace o2::bkp::api
 {
@@ -34,6 +35,21 @@ class FlpServiceClient
     uint64_t nEquipmentBytes,
     uint64_t nRecordingBytes,
     uint64_t nFairMQBytes) = 0;
+
+  /// Asynchronous version of updateReadoutCountersByFlpNameAndRunNumber, onDone receives the outcome of the call
+  ///
+  /// The default implementation runs the blocking call and completes before returning
+  virtual void updateReadoutCountersByFlpNameAndRunNumberAsync(
+    const std::string& flpName,
+    int32_t runNumber,
+    uint64_t nSubtimeframes,
+    uint64_t nEquipmentBytes,
+    uint64_t nRecordingBytes,
+    uint64_t nFairMQBytes,
+    Completion onDone)
+  {
+    completeInline([&]() { updateReadoutCountersByFlpNameAndRunNumber(flpName, runNumber, nSubtimeframes, nEquipmentBytes, nRecordingBytes, nFairMQBytes); }, onDone);
+  }
 };
 } // namespace o2::bkp::api
 
@@ -0,0 +1,37 @@
+//  Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+//  See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+//  All rights not expressly granted are reserved.
+//
+//  This software is distributed under the terms of the GNU General Public
+//  License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+//  In applying this license CERN does not waive the privileges and immunities
+//  granted to it by virtue of its status as an Intergovernmental Organization
+//  or submit itself to any jurisdiction.
+
+
+
+#ifndef CXX_CLIENT_BOOKKEEPINGAPI_LHCFILL_H
+#define CXX_CLIENT_BOOKKEEPINGAPI_LHCFILL_H
+
+#include <cstdint>
+#include <optional>
+#include <string>
+
+namespace o2::bkp::api
+{
+/// LHC fill, as fetched from bookkeeping
+///
+/// Timestamps are in milliseconds since epoch, the stable beams ones are only set once stable beams started or ended.
+struct LhcFill {
+  int32_t fillNumber = 0;
+  std::optional<int64_t> stableBeamsStart;
+  std::optional<int64_t> stableBeamsEnd;
+  /// In seconds
+  std::optional<int64_t> stableBeamsDuration;
+  std::string beamType;
+  std::string fillingSchemeName;
+};
+} // namespace o2::bkp::api
+
+#endif // CXX_CLIENT_BOOKKEEPINGAPI_LHCFILL_H
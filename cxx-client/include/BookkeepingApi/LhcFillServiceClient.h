@@ -0,0 +1,40 @@
+//  Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+//  See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+//  All rights not expressly granted are reserved.
+//
+//  This software is distributed under the terms of the GNU General Public
+//  License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+//  In applying this license CERN does not waive the privileges and immunities
+//  granted to it by virtue of its status as an Intergovernmental Organization
+//  or submit itself to any jurisdiction.
+
+
+
+#ifndef CXX_CLIENT_BOOKKEEPINGAPI_LHCFILLSERVICECLIENT_H
+#define CXX_CLIENT_BOOKKEEPINGAPI_LHCFILLSERVICECLIENT_H
+
+#include <memory>
+#include <stdexcept>
+#include "LhcFill.h"
+#include "Subscription.h"
+
+namespace o2::bkp::api
+{
+class LhcFillServiceClient
+{
+ public:
+  virtual ~LhcFillServiceClient() = default;
+
+  /// Subscribe to the most recent LHC fill, see Subscription
+  ///
+  /// @param onChange if set, called with each version of the fill received
+  virtual std::unique_ptr<Subscription<LhcFill>> watchLast(OnChange<LhcFill> onChange = {})
+  {
+    (void)onChange;
+    throw std::runtime_error("Watching LHC fills is not supported by this client");
+  }
+};
+} // namespace o2::bkp::api
+
+#endif // CXX_CLIENT_BOOKKEEPINGAPI_LHCFILLSERVICECLIENT_H
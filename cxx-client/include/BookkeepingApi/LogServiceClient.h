@@ -0,0 +1,67 @@
+//  Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+//  See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+//  All rights not expressly granted are reserved.
+//
+//  This software is distributed under the terms of the GNU General Public
+//  License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+//  In applying this license CERN does not waive the privileges and immunities
+//  granted to it by virtue of its status as an Intergovernmental Organization
+//  or submit itself to any jurisdiction.
+
+
+#ifndef CXX_CLIENT_BOOKKEEPINGAPI_LOGSERVICECLIENT_H
+#define CXX_CLIENT_BOOKKEEPINGAPI_LOGSERVICECLIENT_H
+
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "Completion.h"
+
+namespace o2::bkp::api
+{
+class LogServiceClient
+{
+ public:
+  virtual ~LogServiceClient() = default;
+
+  /// Create a log and return its id
+  ///
+  /// @param runNumbers the runs the log is related to
+  /// @param parentLogId if set, the log is created as a reply to this one
+  virtual int createLog(std::string title, std::string text, std::vector<int> runNumbers = {}, std::optional<int> parentLogId = std::nullopt)
+  {
+    (void)title;
+    (void)text;
+    (void)runNumbers;
+    (void)parentLogId;
+    throw std::runtime_error("Creating logs is not supported by this client");
+  }
+
+  /// Asynchronous version of createLog, onDone receives the id of the created log
+  ///
+  /// The default implementation runs the blocking call and completes before returning
+  virtual void createLogAsync(std::string title, std::string text, std::vector<int> runNumbers, std::optional<int> parentLogId, ResultCompletion<int> onDone)
+  {
+    completeInline<int>([&]() { return createLog(title, text, runNumbers, parentLogId); }, onDone);
+  }
+
+  /// Attach a file to an existing log and return the id of the created attachment
+  ///
+  /// The file is streamed from disk in fixed-size chunks, so that uploading it only needs a bounded amount of memory
+  /// whatever its size. Throw std::runtime_error if the file can not be read or the upload fails.
+  ///
+  /// @param filePath the path of the file to upload, its name is kept as the attachment's original name
+  /// @param mimeType the MIME type of the file
+  virtual int uploadAttachment(int logId, const std::string& filePath, const std::string& mimeType = "application/octet-stream")
+  {
+    (void)logId;
+    (void)filePath;
+    (void)mimeType;
+    throw std::runtime_error("Uploading attachments is not supported by this client");
+  }
+};
+} // namespace o2::bkp::api
+
+#endif // CXX_CLIENT_BOOKKEEPINGAPI_LOGSERVICECLIENT_H
@@ -19,6 +19,7 @@
 #include <string>
 #include <cstdint>
 #include "QcFlag.h"
+#include "Completion.h"
 
 namespace o2::bkp::api
 {
@@ -46,6 +47,44 @@ class QcFlagServiceClient
     uint32_t runNumber,
     const std::string& detectorName,
     const std::vector<QcFlag>& qcFlags) = 0;
+
+  /// Asynchronous version of createForDataPass, onDone receives the created flags ids
+  ///
+  /// The default implementation runs the blocking call and completes before returning
+  virtual void createForDataPassAsync(
+    uint32_t runNumber,
+    const std::string& passName,
+    const std::string& detectorName,
+    const std::vector<QcFlag>& qcFlags,
+    ResultCompletion<std::vector<int>> onDone)
+  {
+    completeInline<std::vector<int>>([&]() { return createForDataPass(runNumber, passName, detectorName, qcFlags); }, onDone);
+  }
+
+  /// Asynchronous version of createForSimulationPass, onDone receives the created flags ids
+  ///
+  /// The default implementation runs the blocking call and completes before returning
+  virtual void createForSimulationPassAsync(
+    uint32_t runNumber,
+    const std::string& productionName,
+    const std::string& detectorName,
+    const std::vector<QcFlag>& qcFlags,
+    ResultCompletion<std::vector<int>> onDone)
+  {
+    completeInline<std::vector<int>>([&]() { return createForSimulationPass(runNumber, productionName, detectorName, qcFlags); }, onDone);
+  }
+
+  /// Asynchronous version of createForSynchronous, onDone receives the created flags ids
+  ///
+  /// The default implementation runs the blocking call and completes before returning
+  virtual void createForSynchronousAsync(
+    uint32_t runNumber,
+    const std::string& detectorName,
+    const std::vector<QcFlag>& qcFlags,
+    ResultCompletion<std::vector<int>> onDone)
+  {
+    completeInline<std::vector<int>>([&]() { return createForSynchronous(runNumber, detectorName, qcFlags); }, onDone);
+  }
 };
 } // namespace o2::bkp::api
 
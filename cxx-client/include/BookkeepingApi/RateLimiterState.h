@@ -0,0 +1,34 @@
+//  Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+//  See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+//  All rights not expressly granted are reserved.
+//
+//  This software is distributed under the terms of the GNU General Public
+//  License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+//  In applying this license CERN does not waive the privileges and immunities
+//  granted to it by virtue of its status as an Intergovernmental Organization
+//  or submit itself to any jurisdiction.
+
+#ifndef CXX_CLIENT_BOOKKEEPINGAPI_RATELIMITERSTATE_H
+#define CXX_CLIENT_BOOKKEEPINGAPI_RATELIMITERSTATE_H
+
+#include <cstdint>
+
+namespace o2::bkp::api
+{
+/// Snapshot of the client-side adaptive rate limiter of a service
+struct RateLimiterState {
+  /// Current allowed rate, in calls per second
+  double rate;
+  /// Tokens currently available in the bucket (negative when calls are waiting for a token)
+  double availableTokens;
+  /// Number of calls that had to wait for a token
+  uint64_t throttledCalls;
+  /// Number of calls rejected because no token would have been available in time
+  uint64_t rejectedCalls;
+  /// Number of times the rate has been decreased because the server reported overload
+  uint64_t backoffs;
+};
+} // namespace o2::bkp::api
+
+#endif // CXX_CLIENT_BOOKKEEPINGAPI_RATELIMITERSTATE_H
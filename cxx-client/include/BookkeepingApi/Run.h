@@ -0,0 +1,76 @@
+//  Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+//  See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+//  All rights not expressly granted are reserved.
+//
+//  This software is distributed under the terms of the GNU General Public
+//  License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+//  In applying this license CERN does not waive the privileges and immunities
+//  granted to it by virtue of its status as an Intergovernmental Organization
+//  or submit itself to any jurisdiction.
+
+
+#ifndef CXX_CLIENT_BOOKKEEPINGAPI_RUN_H
+#define CXX_CLIENT_BOOKKEEPINGAPI_RUN_H
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace o2::bkp::api
+{
+/// Metadata of a run, as fetched from bookkeeping
+///
+/// Enumerated values (run type, run quality and detectors) are given by their name, for example PHYSICS, GOOD or TPC.
+/// Timestamps are in milliseconds since epoch.
+struct Run {
+  int32_t runNumber = 0;
+  std::optional<std::string> environmentId;
+  std::optional<std::string> runType;
+  std::optional<std::string> runQuality;
+  std::optional<int64_t> timeO2Start;
+  std::optional<int64_t> timeO2End;
+  std::optional<int64_t> timeTrgStart;
+  std::optional<int64_t> timeTrgEnd;
+  std::optional<std::string> triggerValue;
+  std::optional<std::string> lhcPeriod;
+  std::optional<std::string> pdpBeamType;
+  std::optional<int32_t> nDetectors;
+  std::optional<int32_t> nFlps;
+  std::optional<int32_t> nEpns;
+  std::vector<std::string> detectors;
+  /// Only set if the LHC fill has been requested and the run has one
+  std::optional<int32_t> fillNumber;
+};
+
+/// Optional fields of a Run, to fetch only some of them
+enum class RunField {
+  ENVIRONMENT_ID,
+  RUN_TYPE,
+  RUN_QUALITY,
+  TIME_O2_START,
+  TIME_O2_END,
+  TIME_TRG_START,
+  TIME_TRG_END,
+  TRIGGER_VALUE,
+  LHC_PERIOD,
+  PDP_BEAM_TYPE,
+  N_DETECTORS,
+  N_FLPS,
+  N_EPNS,
+  DETECTORS,
+};
+
+/// Criteria of the runs to fetch at once, at least a bound of the run numbers or the LHC period must be specified
+struct RunsQuery {
+  /// Inclusive bounds of the run numbers
+  std::optional<int32_t> runNumberFrom;
+  std::optional<int32_t> runNumberTo;
+  std::optional<std::string> lhcPeriod;
+  /// Fetch the fill number of the runs
+  bool withLhcFill = false;
+};
+} // namespace o2::bkp::api
+
+#endif // CXX_CLIENT_BOOKKEEPINGAPI_RUN_H
@@ -13,7 +13,13 @@
 #ifndef CXX_CLIENT_BOOKKEEPINGAPI_RUNSERVICECLIENT_H
 #define CXX_CLIENT_BOOKKEEPINGAPI_RUNSERVICECLIENT_H
 
+#include <memory>
+#include <stdexcept>
 #include <string>
+#include <vector>
+#include "Completion.h"
+#include "RunStream.h"
+#include "Subscription.h"
 
 namespace o2::bkp::api
 {
@@ -23,6 +29,56 @@ class RunServiceClient
   virtual ~RunServiceClient() = default;
 
   virtual void setRawCtpTriggerConfiguration(int runNumber, std::string rawCtpTriggerConfiguration) = 0;
+
+  /// Asynchronous version of setRawCtpTriggerConfiguration, onDone receives the outcome of the call
+  ///
+  /// The default implementation runs the blocking call and completes before returning
+  virtual void setRawCtpTriggerConfigurationAsync(int runNumber, std::string rawCtpTriggerConfiguration, Completion onDone)
+  {
+    completeInline([&]() { setRawCtpTriggerConfiguration(runNumber, rawCtpTriggerConfiguration); }, onDone);
+  }
+
+  /// Fetch a single run, throw std::runtime_error if it does not exist
+  ///
+  /// @param fields if not empty, only these fields are set in the returned run (its run number always is), sparing
+  ///               their transfer and the server the lookup of the detectors, run type and LHC period if not selected.
+  ///               Without selection, the detectors, run type and LHC period are not fetched.
+  /// @param withLhcFill whether to fetch the fill number of the run
+  virtual Run get(int runNumber, const std::vector<RunField>& fields = {}, bool withLhcFill = false)
+  {
+    (void)runNumber;
+    (void)fields;
+    (void)withLhcFill;
+    throw std::runtime_error("Fetching runs is not supported by this client");
+  }
+
+  /// Asynchronous version of get, onDone receives the fetched run
+  ///
+  /// The default implementation runs the blocking call and completes before returning
+  virtual void getAsync(int runNumber, std::vector<RunField> fields, bool withLhcFill, ResultCompletion<Run> onDone)
+  {
+    completeInline<Run>([&]() { return get(runNumber, fields, withLhcFill); }, onDone);
+  }
+
+  /// Fetch the runs matching the given query, in increasing run number order
+  ///
+  /// The runs are streamed by the server and read one after the other from the returned stream, see RunStream
+  virtual std::unique_ptr<RunStream> getMany(const RunsQuery& query)
+  {
+    (void)query;
+    throw std::runtime_error("Fetching runs is not supported by this client");
+  }
+
+  /// Subscribe to the most recent run, the one with the highest run number, see Subscription
+  ///
+  /// @param withLhcFill whether to fetch the fill number of the run
+  /// @param onChange if set, called with each version of the run received
+  virtual std::unique_ptr<Subscription<Run>> watchLast(bool withLhcFill = false, OnChange<Run> onChange = {})
+  {
+    (void)withLhcFill;
+    (void)onChange;
+    throw std::runtime_error("Watching runs is not supported by this client");
+  }
 };
 } // namespace o2::bkp::api
 
@@ -0,0 +1,70 @@
+//  Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+//  See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+//  All rights not expressly granted are reserved.
+//
+//  This software is distributed under the terms of the GNU General Public
+//  License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+//  In applying this license CERN does not waive the privileges and immunities
+//  granted to it by virtue of its status as an Intergovernmental Organization
+//  or submit itself to any jurisdiction.
+
+
+#ifndef CXX_CLIENT_BOOKKEEPINGAPI_RUNSNAPSHOT_H
+#define CXX_CLIENT_BOOKKEEPINGAPI_RUNSNAPSHOT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+#include "Run.h"
+#include "RunStream.h"
+
+namespace o2::bkp::api
+{
+/**
+ * Runs metadata saved in a compact file, read through a read-only memory mapping
+ *
+ * Opening a snapshot only maps the file: runs are decoded when accessed, and the pages of the file are shared by all
+ * the processes of the node reading it. Jobs repeatedly needing the metadata of the same runs can fetch them once
+ * with RunServiceClient::getMany, save them with write and then open the snapshot without any call to bookkeeping.
+ *
+ * The file uses the byte order of the machine that wrote it and is meant to be read on the same node.
+ */
+class RunSnapshot
+{
+ public:
+  /// Map the snapshot file at the given path, throw std::runtime_error if it can not be read or is not a runs snapshot
+  explicit RunSnapshot(const std::string& path);
+  ~RunSnapshot();
+
+  RunSnapshot(const RunSnapshot&) = delete;
+  RunSnapshot& operator=(const RunSnapshot&) = delete;
+
+  /// Write the given runs to a snapshot file, atomically replacing any existing one so that readers never see it partial
+  static void write(const std::string& path, std::vector<Run> runs);
+
+  /// Write all the runs of a stream to a snapshot file, return the amount of runs written
+  ///
+  /// Runs are written as they are read, only their strings being kept in memory until the end of the stream. They are
+  /// sorted in the file once all read if the stream did not give them by increasing run number.
+  static size_t write(const std::string& path, RunStream& runs);
+
+  /// Amount of runs in the snapshot
+  size_t size() const;
+
+  /// Decode the run at the given index, runs are sorted by increasing run number
+  Run at(size_t index) const;
+
+  /// Find a run by its run number
+  std::optional<Run> find(int32_t runNumber) const;
+
+ private:
+  const void* mData = nullptr;
+  size_t mSize = 0;
+  std::string mPath;
+};
+} // namespace o2::bkp::api
+
+#endif // CXX_CLIENT_BOOKKEEPINGAPI_RUNSNAPSHOT_H
@@ -0,0 +1,87 @@
+//  Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+//  See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+//  All rights not expressly granted are reserved.
+//
+//  This software is distributed under the terms of the GNU General Public
+//  License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+//  In applying this license CERN does not waive the privileges and immunities
+//  granted to it by virtue of its status as an Intergovernmental Organization
+//  or submit itself to any jurisdiction.
+
+
+#ifndef CXX_CLIENT_BOOKKEEPINGAPI_RUNSTREAM_H
+#define CXX_CLIENT_BOOKKEEPINGAPI_RUNSTREAM_H
+
+#include <cstddef>
+#include <iterator>
+#include "Run.h"
+
+namespace o2::bkp::api
+{
+/**
+ * Runs received one after the other from bookkeeping
+ *
+ * Runs are read as they arrive, so that any amount of them can be processed without holding all of them in memory. The
+ * stream can be iterated over once, while it is kept alive:
+ *
+ * ```cpp
+ * auto runs = client->run()->getMany(query);
+ * for (const Run& run : *runs) {
+ * }
+ * ```
+ *
+ * Destroying the stream before its end cancels the fetch. A stream must be destroyed before the client it was created
+ * from.
+ */
+class RunStream
+{
+ public:
+  /// Single pass iterator over the runs of a stream
+  class Iterator
+  {
+   public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = Run;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const Run*;
+    using reference = const Run&;
+
+    /// End of stream iterator
+    Iterator() = default;
+
+    explicit Iterator(RunStream* stream) : mStream(stream)
+    {
+      ++*this;
+    }
+
+    reference operator*() const { return mRun; }
+    pointer operator->() const { return &mRun; }
+
+    Iterator& operator++()
+    {
+      if (!mStream->next(mRun)) {
+        mStream = nullptr;
+      }
+      return *this;
+    }
+
+    bool operator==(const Iterator& other) const { return mStream == other.mStream; }
+    bool operator!=(const Iterator& other) const { return mStream != other.mStream; }
+
+   private:
+    RunStream* mStream = nullptr;
+    Run mRun;
+  };
+
+  virtual ~RunStream() = default;
+
+  /// Read the next run, return false at the end of the stream and throw std::runtime_error if the fetch failed
+  virtual bool next(Run& run) = 0;
+
+  Iterator begin() { return Iterator(this); }
+  Iterator end() { return {}; }
+};
+} // namespace o2::bkp::api
+
+#endif // CXX_CLIENT_BOOKKEEPINGAPI_RUNSTREAM_H
@@ -0,0 +1,31 @@
+//  Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+//  See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+//  All rights not expressly granted are reserved.
+//
+//  This software is distributed under the terms of the GNU General Public
+//  License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+//  In applying this license CERN does not waive the privileges and immunities
+//  granted to it by virtue of its status as an Intergovernmental Organization
+//  or submit itself to any jurisdiction.
+
+#ifndef CXX_CLIENT_BOOKKEEPINGAPI_SHUTDOWNREPORT_H
+#define CXX_CLIENT_BOOKKEEPINGAPI_SHUTDOWNREPORT_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+
+namespace o2::bkp::api
+{
+/// Outcome of the shutdown of a client
+struct ShutdownReport {
+  /// Number of calls still in flight at the deadline, which have been cancelled, per "service/method"
+  std::map<std::string, uint32_t> abandonedCalls;
+
+  /// True if all the calls in flight completed before the deadline
+  bool drained() const { return abandonedCalls.empty(); }
+};
+} // namespace o2::bkp::api
+
+#endif // CXX_CLIENT_BOOKKEEPINGAPI_SHUTDOWNREPORT_H
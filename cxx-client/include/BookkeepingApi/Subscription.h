@@ -0,0 +1,53 @@
+//  Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+//  See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+//  All rights not expressly granted are reserved.
+//
+//  This software is distributed under the terms of the GNU General Public
+//  License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+//  In applying this license CERN does not waive the privileges and immunities
+//  granted to it by virtue of its status as an Intergovernmental Organization
+//  or submit itself to any jurisdiction.
+
+
+
+#ifndef CXX_CLIENT_BOOKKEEPINGAPI_SUBSCRIPTION_H
+#define CXX_CLIENT_BOOKKEEPINGAPI_SUBSCRIPTION_H
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+
+namespace o2::bkp::api
+{
+/**
+ * Latest version of a bookkeeping entity, kept up to date in the background by a server stream
+ *
+ * The server sends the current version when the subscription starts, then each new version as soon as it sees it. The
+ * stream is opened again, with an exponential backoff, whenever it is interrupted. Reading the cached version never
+ * waits, neither for the server nor for the thread receiving the updates, so it can be done from any thread at any
+ * rate. A subscription must be destroyed before the client it was created from.
+ */
+template <typename T>
+class Subscription
+{
+ public:
+  virtual ~Subscription() = default;
+
+  /// Latest version received, nothing until the first one is received
+  virtual std::optional<T> latest() const = 0;
+
+  /// Number of versions received so far, to cheaply know whether latest changed since the previous read
+  virtual uint64_t version() const = 0;
+
+  /// Whether the stream is currently open
+  virtual bool connected() const = 0;
+};
+
+/// Called from the subscription thread with each version received, possibly again with the same version after the
+/// stream has been opened again
+template <typename T>
+using OnChange = std::function<void(const T&)>;
+} // namespace o2::bkp::api
+
+#endif // CXX_CLIENT_BOOKKEEPINGAPI_SUBSCRIPTION_H
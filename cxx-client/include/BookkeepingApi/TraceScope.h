@@ -0,0 +1,45 @@
+//  Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+//  See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+//  All rights not expressly granted are reserved.
+//
+//  This software is distributed under the terms of the GNU General Public
+//  License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+//  In applying this license CERN does not waive the privileges and immunities
+//  granted to it by virtue of its status as an Intergovernmental Organization
+//  or submit itself to any jurisdiction.
+
+#ifndef CXX_CLIENT_BOOKKEEPINGAPI_TRACESCOPE_H
+#define CXX_CLIENT_BOOKKEEPINGAPI_TRACESCOPE_H
+
+#include <string>
+
+namespace o2::bkp::api
+{
+/**
+ * Make the bookkeeping calls started by the current thread part of the caller's trace while the scope is alive
+ *
+ * The calls become children of the span whose W3C trace context is given, for example "00-<trace id>-<span id>-01",
+ * and are sampled if and only if it is. Asynchronous calls keep the scope which was current when they were started.
+ * Scopes can be nested, the innermost one applies. Without a scope, or with an invalid trace context, each call starts
+ * its own trace. Only used if tracing is enabled in the client options.
+ */
+class TraceScope
+{
+ public:
+  explicit TraceScope(std::string traceparent);
+  ~TraceScope();
+
+  TraceScope(const TraceScope&) = delete;
+  TraceScope& operator=(const TraceScope&) = delete;
+
+  /// Trace context of the innermost scope of the current thread, empty if there is none
+  static const std::string& current();
+
+ private:
+  std::string mTraceparent;
+  const TraceScope* mOuter;
+};
+} // namespace o2::bkp::api
+
+#endif // CXX_CLIENT_BOOKKEEPINGAPI_TRACESCOPE_H
@@ -14,8 +14,16 @@
 //
 
 #include "BookkeepingApi/BkpClientFactory.h"
+#include <algorithm>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
 #include "grpc/GrpcBkpClient.h"
+#include "shm/ShmBkpClient.h"
 
 using grpc::ClientContext;
 using std::make_unique;
@@ -24,19 +32,159 @@ using std::unique_ptr;
 
 namespace o2::bkp::api
 {
+namespace
+{
+constexpr char SHM_URI_SCHEME[] = "shm://";
+
+/// Return the shared memory segment name if the URI targets the node-local aggregator, an empty string if not
+string extractShmSegmentName(const string& uri)
+{
+  if (uri.rfind(SHM_URI_SCHEME, 0) != 0) {
+    return "";
+  }
+  return "/" + uri.substr(sizeof(SHM_URI_SCHEME) - 1);
+}
+
+/// Split a comma-separated list of endpoints, URIs using one of gRPC's name resolvers are kept whole as they have
+/// their own syntax for several addresses (for example ipv4:10.0.0.1:4001,10.0.0.2:4001)
+std::vector<string> splitEndpoints(const string& uri)
+{
+  for (const auto* resolverScheme : { "dns:", "ipv4:", "ipv6:", "unix:", "unix-abstract:", "vsock:", "xds:" }) {
+    if (uri.rfind(resolverScheme, 0) == 0) {
+      return { uri };
+    }
+  }
+
+  std::vector<string> endpoints;
+  size_t start = 0;
+  while (start <= uri.size()) {
+    auto end = std::min(uri.find(',', start), uri.size());
+    if (end > start) {
+      endpoints.push_back(uri.substr(start, end - start));
+    }
+    start = end + 1;
+  }
+  if (endpoints.empty()) {
+    throw std::invalid_argument("No bookkeeping endpoint in URI \"" + uri + "\"");
+  }
+  return endpoints;
+}
+
+/// Serialize the options a client was created with, to tell whether another caller asks for the same ones
+///
+/// Callbacks can not be compared, only whether they are set is part of the fingerprint
+string fingerprint(const BkpClientOptions& options)
+{
+  std::ostringstream stream;
+  const auto& [rateLimiter, circuitBreaker, priorityLanes, loadBalancing, retry, connection, tracing, capture, shutdown,
+               callTiming] = options;
+  stream << rateLimiter.enabled << ' ' << rateLimiter.initialRate << ' ' << rateLimiter.minRate << ' '
+         << rateLimiter.maxRate << ' ' << rateLimiter.burst << ' ' << rateLimiter.additiveIncrease << ' '
+         << rateLimiter.multiplicativeDecrease << ' ' << rateLimiter.maxWait.count() << ';'
+         << circuitBreaker.enabled << ' ' << circuitBreaker.failureThreshold << ' ' << circuitBreaker.openDuration.count()
+         << ' ' << circuitBreaker.probeTimeout.count() << ' ' << static_cast<bool>(circuitBreaker.fallback) << ';'
+         << priorityLanes.enabled << ' ' << priorityLanes.maxBulkInFlight << ' '
+         << priorityLanes.maxBulkInFlightDuringCritical << ';'
+         << loadBalancing.ejectionFailureThreshold << ' ' << loadBalancing.slowCallThreshold.count() << ' '
+         << loadBalancing.ejectionDuration.count() << ' ' << loadBalancing.probeInterval.count() << ';'
+         << retry.maxAttempts << ' ' << retry.initialBackoff.count() << ' ' << retry.backoffMultiplier << ' '
+         << retry.retryWritesWithoutKey << ';'
+         << connection.prewarm << ' ' << static_cast<bool>(connection.onStateChange) << ';'
+         << tracing.enabled << ' ' << tracing.sampleRatio << ' ' << tracing.exportPath.size() << ':' << tracing.exportPath
+         << ' ' << tracing.flushInterval.count() << ' ' << tracing.maxBufferedSpans << ';'
+         << capture.path.size() << ':' << capture.path << ' ' << capture.maxBufferedBytes << ' '
+         << capture.flushInterval.count() << ' ' << static_cast<bool>(capture.onError) << ';'
+         << shutdown.budget.count() << ' ' << static_cast<bool>(shutdown.onAbandoned) << ';'
+         << static_cast<bool>(callTiming.onCall);
+  return stream.str();
+}
+
+/// Client handed out by BkpClientFactory::shared, with the fingerprint of the options it was created with
+struct SharedClient {
+  std::weak_ptr<BkpClient> client;
+  string optionsFingerprint;
+};
+
+/// Clients handed out by BkpClientFactory::shared, indexed by URI and token
+struct SharedClientRegistry {
+  std::mutex mutex;
+  std::map<std::pair<string, string>, SharedClient> clients;
+};
+
+SharedClientRegistry& sharedClientRegistry()
+{
+  static SharedClientRegistry registry;
+  return registry;
+}
+
+/// Return the live shared client of the URI and token, created with the given options if there is none
+///
+/// Without options, an existing client is returned whatever its options and a new one uses the default options
+std::shared_ptr<BkpClient> acquireSharedClient(const string& gRPCUri, const string& token,
+                                               const std::optional<BkpClientOptions>& options)
+{
+  auto& registry = sharedClientRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+
+  // Forget the clients whose last handle has been released
+  for (auto clientIterator = registry.clients.begin(); clientIterator != registry.clients.end();) {
+    clientIterator = clientIterator->second.client.expired() ? registry.clients.erase(clientIterator) : std::next(clientIterator);
+  }
+
+  auto optionsFingerprint = fingerprint(options.value_or(BkpClientOptions{}));
+  auto& sharedClient = registry.clients[{ gRPCUri, token }];
+  if (auto client = sharedClient.client.lock()) {
+    if (options && sharedClient.optionsFingerprint != optionsFingerprint) {
+      throw std::invalid_argument("The shared bookkeeping client of \"" + gRPCUri
+                                  + "\" already exists with different options");
+    }
+    return client;
+  }
+  std::shared_ptr<BkpClient> client = BkpClientFactory::create(gRPCUri, token, options.value_or(BkpClientOptions{}));
+  sharedClient = { client, optionsFingerprint };
+  return client;
+}
+} // namespace
+
 unique_ptr<BkpClient> BkpClientFactory::create(const std::string& gRPCUri)
 {
-  return make_unique<grpc::GrpcBkpClient>(gRPCUri, []() { return make_unique<ClientContext>(); });
+  return create(gRPCUri, "", BkpClientOptions{});
 }
 
 unique_ptr<BkpClient> BkpClientFactory::create(const string& gRPCUri, const string& token)
 {
+  return create(gRPCUri, token, BkpClientOptions{});
+}
+
+unique_ptr<BkpClient> BkpClientFactory::create(const string& gRPCUri, const string& token, const BkpClientOptions& options)
+{
+  // Authentication is done by the aggregator daemon when forwarding the records
+  if (auto segmentName = extractShmSegmentName(gRPCUri); !segmentName.empty()) {
+    return make_unique<shm::ShmBkpClient>(segmentName);
+  }
+
+  auto endpoints = splitEndpoints(gRPCUri);
+  if (token.empty()) {
+    return make_unique<grpc::GrpcBkpClient>(endpoints, []() { return make_unique<ClientContext>(); }, options);
+  }
+
   return make_unique<grpc::GrpcBkpClient>(
-    gRPCUri,
+    endpoints,
     [token]() {
       auto clientContext = make_unique<ClientContext>();
       clientContext->AddMetadata("authorization", "Bearer " + token);
       return clientContext;
-    });
+    },
+    options);
+}
+
+std::shared_ptr<BkpClient> BkpClientFactory::shared(const string& gRPCUri, const string& token)
+{
+  return acquireSharedClient(gRPCUri, token, std::nullopt);
+}
+
+std::shared_ptr<BkpClient> BkpClientFactory::shared(const string& gRPCUri, const string& token, const BkpClientOptions& options)
+{
+  return acquireSharedClient(gRPCUri, token, options);
 }
 } // namespace o2::bkp::api
@@ -0,0 +1,382 @@
+//  Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+//  See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+//  All rights not expressly granted are reserved.
+//
+//  This software is distributed under the terms of the GNU General Public
+//  License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+//  In applying this license CERN does not waive the privileges and immunities
+//  granted to it by virtue of its status as an Intergovernmental Organization
+//  or submit itself to any jurisdiction.
+
+
+#include "BookkeepingApi/RunSnapshot.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace o2::bkp::api
+{
+namespace
+{
+constexpr uint64_t MAGIC = 0x4f32424b5052554e; // "O2BKPRUN"
+constexpr uint32_t VERSION = 1;
+
+/// Length marking an absent optional string
+constexpr uint32_t ABSENT = UINT32_MAX;
+
+/// Fixed layout header at the beginning of the file, followed by the records then by the strings
+struct SnapshotHeader {
+  uint64_t magic;
+  uint32_t version;
+  uint32_t recordSize;
+  uint64_t runCount;
+  uint64_t stringsOffset;
+  uint64_t stringsSize;
+};
+
+/// String stored in the strings area of the file
+struct StringRef {
+  uint32_t offset;
+  uint32_t length;
+};
+
+/// Bits of SnapshotRecord::presentFields telling which optional numbers are set
+enum PresentField : uint32_t {
+  TIME_O2_START = 1 << 0,
+  TIME_O2_END = 1 << 1,
+  TIME_TRG_START = 1 << 2,
+  TIME_TRG_END = 1 << 3,
+  N_DETECTORS = 1 << 4,
+  N_FLPS = 1 << 5,
+  N_EPNS = 1 << 6,
+  FILL_NUMBER = 1 << 7,
+};
+
+/// Fixed size record of a run, records are sorted by run number
+struct SnapshotRecord {
+  int32_t runNumber;
+  uint32_t presentFields;
+  int64_t timeO2Start;
+  int64_t timeO2End;
+  int64_t timeTrgStart;
+  int64_t timeTrgEnd;
+  int32_t nDetectors;
+  int32_t nFlps;
+  int32_t nEpns;
+  int32_t fillNumber;
+  StringRef environmentId;
+  StringRef runType;
+  StringRef runQuality;
+  StringRef triggerValue;
+  StringRef lhcPeriod;
+  StringRef pdpBeamType;
+  /// Comma-separated names
+  StringRef detectors;
+};
+
+std::runtime_error systemError(const std::string& what, const std::string& path)
+{
+  return std::runtime_error(what + " runs snapshot " + path + ": " + std::strerror(errno));
+}
+
+/// Builds the strings area of a snapshot being written
+class StringsWriter
+{
+ public:
+  StringRef add(const std::optional<std::string>& value)
+  {
+    if (!value.has_value()) {
+      return { 0, ABSENT };
+    }
+    StringRef ref{ static_cast<uint32_t>(mStrings.size()), static_cast<uint32_t>(value->size()) };
+    mStrings += *value;
+    return ref;
+  }
+
+  const std::string& strings() const { return mStrings; }
+
+ private:
+  std::string mStrings;
+};
+
+template <typename T>
+void setIfPresent(uint32_t& presentFields, PresentField field, const std::optional<T>& value, T& destination)
+{
+  if (value.has_value()) {
+    presentFields |= field;
+    destination = *value;
+  }
+}
+
+template <typename T>
+std::optional<T> getIfPresent(uint32_t presentFields, PresentField field, T value)
+{
+  return (presentFields & field) ? std::optional<T>(value) : std::nullopt;
+}
+
+std::optional<std::string> joinDetectors(const std::vector<std::string>& detectors)
+{
+  std::string joined;
+  for (const auto& detector : detectors) {
+    joined += (joined.empty() ? "" : ",") + detector;
+  }
+  return joined;
+}
+
+/// Writes the records of a snapshot as they are added, next to the destination which is replaced once committed
+///
+/// Only the strings are kept in memory, as they follow the records in the file. Records added out of run number order
+/// are sorted in the file when committing.
+class SnapshotWriter
+{
+ public:
+  explicit SnapshotWriter(const std::string& path) : mPath(path), mTemporaryPath(path + ".tmp." + std::to_string(getpid()))
+  {
+    // Readers either map the previous file or the complete new one
+    mFile = std::fopen(mTemporaryPath.c_str(), "w+b");
+    if (mFile == nullptr) {
+      throw systemError("Unable to create", mTemporaryPath);
+    }
+    SnapshotHeader header{};
+    writeOrThrow(&header, sizeof(header));
+  }
+
+  ~SnapshotWriter()
+  {
+    if (mFile != nullptr) {
+      std::fclose(mFile);
+      std::remove(mTemporaryPath.c_str());
+    }
+  }
+
+  SnapshotWriter(const SnapshotWriter&) = delete;
+  SnapshotWriter& operator=(const SnapshotWriter&) = delete;
+
+  void add(const Run& run)
+  {
+    SnapshotRecord record{};
+    record.runNumber = run.runNumber;
+    setIfPresent(record.presentFields, TIME_O2_START, run.timeO2Start, record.timeO2Start);
+    setIfPresent(record.presentFields, TIME_O2_END, run.timeO2End, record.timeO2End);
+    setIfPresent(record.presentFields, TIME_TRG_START, run.timeTrgStart, record.timeTrgStart);
+    setIfPresent(record.presentFields, TIME_TRG_END, run.timeTrgEnd, record.timeTrgEnd);
+    setIfPresent(record.presentFields, N_DETECTORS, run.nDetectors, record.nDetectors);
+    setIfPresent(record.presentFields, N_FLPS, run.nFlps, record.nFlps);
+    setIfPresent(record.presentFields, N_EPNS, run.nEpns, record.nEpns);
+    setIfPresent(record.presentFields, FILL_NUMBER, run.fillNumber, record.fillNumber);
+    record.environmentId = mStrings.add(run.environmentId);
+    record.runType = mStrings.add(run.runType);
+    record.runQuality = mStrings.add(run.runQuality);
+    record.triggerValue = mStrings.add(run.triggerValue);
+    record.lhcPeriod = mStrings.add(run.lhcPeriod);
+    record.pdpBeamType = mStrings.add(run.pdpBeamType);
+    record.detectors = mStrings.add(joinDetectors(run.detectors));
+
+    mSorted = mSorted && (mRunCount == 0 || mLastRunNumber <= run.runNumber);
+    mLastRunNumber = run.runNumber;
+    writeOrThrow(&record, sizeof(record));
+    mRunCount++;
+  }
+
+  /// Complete the file and replace the destination with it, return the amount of runs written
+  size_t commit()
+  {
+    if (!mSorted) {
+      sortRecords();
+    }
+    writeOrThrow(mStrings.strings().data(), mStrings.strings().size());
+
+    SnapshotHeader header{};
+    header.magic = MAGIC;
+    header.version = VERSION;
+    header.recordSize = sizeof(SnapshotRecord);
+    header.runCount = mRunCount;
+    header.stringsOffset = sizeof(SnapshotHeader) + mRunCount * sizeof(SnapshotRecord);
+    header.stringsSize = mStrings.strings().size();
+    if (std::fseek(mFile, 0, SEEK_SET) != 0) {
+      throw systemError("Unable to write", mTemporaryPath);
+    }
+    writeOrThrow(&header, sizeof(header));
+
+    auto closed = std::fclose(mFile) == 0;
+    mFile = nullptr;
+    if (!closed) {
+      auto error = systemError("Unable to write", mTemporaryPath);
+      std::remove(mTemporaryPath.c_str());
+      throw error;
+    }
+    if (std::rename(mTemporaryPath.c_str(), mPath.c_str()) != 0) {
+      auto error = systemError("Unable to replace", mPath);
+      std::remove(mTemporaryPath.c_str());
+      throw error;
+    }
+    return mRunCount;
+  }
+
+ private:
+  void writeOrThrow(const void* data, size_t size)
+  {
+    if (size > 0 && std::fwrite(data, size, 1, mFile) != 1) {
+      throw systemError("Unable to write", mTemporaryPath);
+    }
+  }
+
+  /// Sort the records already written in the file, through a writable mapping of it
+  void sortRecords()
+  {
+    if (std::fflush(mFile) != 0) {
+      throw systemError("Unable to write", mTemporaryPath);
+    }
+    auto mappedSize = sizeof(SnapshotHeader) + mRunCount * sizeof(SnapshotRecord);
+    auto address = mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE, MAP_SHARED, fileno(mFile), 0);
+    if (address == MAP_FAILED) {
+      throw systemError("Unable to map", mTemporaryPath);
+    }
+    auto* records = reinterpret_cast<SnapshotRecord*>(static_cast<SnapshotHeader*>(address) + 1);
+    std::sort(records, records + mRunCount, [](const SnapshotRecord& left, const SnapshotRecord& right) {
+      return left.runNumber < right.runNumber;
+    });
+    munmap(address, mappedSize);
+  }
+
+  std::string mPath;
+  std::string mTemporaryPath;
+  std::FILE* mFile = nullptr;
+  StringsWriter mStrings;
+  size_t mRunCount = 0;
+  int32_t mLastRunNumber = 0;
+  bool mSorted = true;
+};
+} // namespace
+
+RunSnapshot::RunSnapshot(const std::string& path) : mPath(path)
+{
+  auto fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw systemError("Unable to open", path);
+  }
+  struct stat fileStatus {
+  };
+  if (fstat(fd, &fileStatus) != 0) {
+    close(fd);
+    throw systemError("Unable to stat", path);
+  }
+  mSize = static_cast<size_t>(fileStatus.st_size);
+  if (mSize < sizeof(SnapshotHeader)) {
+    close(fd);
+    throw std::runtime_error("File " + path + " is not a runs snapshot");
+  }
+  auto address = mmap(nullptr, mSize, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (address == MAP_FAILED) {
+    throw systemError("Unable to map", path);
+  }
+  mData = address;
+
+  const auto* header = static_cast<const SnapshotHeader*>(mData);
+  auto recordsEnd = sizeof(SnapshotHeader) + header->runCount * sizeof(SnapshotRecord);
+  if (header->magic != MAGIC || header->version != VERSION || header->recordSize != sizeof(SnapshotRecord)
+      || header->runCount > mSize / sizeof(SnapshotRecord) || header->stringsOffset < recordsEnd
+      || header->stringsOffset > mSize || header->stringsSize > mSize - header->stringsOffset) {
+    munmap(const_cast<void*>(mData), mSize);
+    throw std::runtime_error("File " + path + " is not a runs snapshot of this version");
+  }
+}
+
+RunSnapshot::~RunSnapshot()
+{
+  munmap(const_cast<void*>(mData), mSize);
+}
+
+void RunSnapshot::write(const std::string& path, std::vector<Run> runs)
+{
+  SnapshotWriter writer(path);
+  for (const auto& run : runs) {
+    writer.add(run);
+  }
+  writer.commit();
+}
+
+size_t RunSnapshot::write(const std::string& path, RunStream& runs)
+{
+  SnapshotWriter writer(path);
+  for (const auto& run : runs) {
+    writer.add(run);
+  }
+  return writer.commit();
+}
+
+size_t RunSnapshot::size() const
+{
+  return static_cast<const SnapshotHeader*>(mData)->runCount;
+}
+
+Run RunSnapshot::at(size_t index) const
+{
+  if (index >= size()) {
+    throw std::out_of_range("Run index " + std::to_string(index) + " out of the " + std::to_string(size()) + " runs of snapshot " + mPath);
+  }
+
+  const auto* header = static_cast<const SnapshotHeader*>(mData);
+  const auto* records = reinterpret_cast<const SnapshotRecord*>(header + 1);
+  const auto* strings = static_cast<const char*>(mData) + header->stringsOffset;
+  const auto& record = records[index];
+
+  auto getString = [&](const StringRef& ref) -> std::optional<std::string> {
+    if (ref.length == ABSENT) {
+      return std::nullopt;
+    }
+    if (ref.offset > header->stringsSize || ref.length > header->stringsSize - ref.offset) {
+      throw std::runtime_error("Runs snapshot " + mPath + " is corrupted");
+    }
+    return std::string(strings + ref.offset, ref.length);
+  };
+
+  Run run;
+  run.runNumber = record.runNumber;
+  run.environmentId = getString(record.environmentId);
+  run.runType = getString(record.runType);
+  run.runQuality = getString(record.runQuality);
+  run.timeO2Start = getIfPresent(record.presentFields, TIME_O2_START, record.timeO2Start);
+  run.timeO2End = getIfPresent(record.presentFields, TIME_O2_END, record.timeO2End);
+  run.timeTrgStart = getIfPresent(record.presentFields, TIME_TRG_START, record.timeTrgStart);
+  run.timeTrgEnd = getIfPresent(record.presentFields, TIME_TRG_END, record.timeTrgEnd);
+  run.triggerValue = getString(record.triggerValue);
+  run.lhcPeriod = getString(record.lhcPeriod);
+  run.pdpBeamType = getString(record.pdpBeamType);
+  run.nDetectors = getIfPresent(record.presentFields, N_DETECTORS, record.nDetectors);
+  run.nFlps = getIfPresent(record.presentFields, N_FLPS, record.nFlps);
+  run.nEpns = getIfPresent(record.presentFields, N_EPNS, record.nEpns);
+  run.fillNumber = getIfPresent(record.presentFields, FILL_NUMBER, record.fillNumber);
+
+  auto detectors = getString(record.detectors).value_or("");
+  size_t start = 0;
+  while (start < detectors.size()) {
+    auto end = std::min(detectors.find(',', start), detectors.size());
+    run.detectors.push_back(detectors.substr(start, end - start));
+    start = end + 1;
+  }
+  return run;
+}
+
+std::optional<Run> RunSnapshot::find(int32_t runNumber) const
+{
+  const auto* records = reinterpret_cast<const SnapshotRecord*>(static_cast<const SnapshotHeader*>(mData) + 1);
+  const auto* recordsEnd = records + size();
+  const auto* record = std::lower_bound(records, recordsEnd, runNumber, [](const SnapshotRecord& candidate, int32_t searched) {
+    return candidate.runNumber < searched;
+  });
+  if (record == recordsEnd || record->runNumber != runNumber) {
+    return std::nullopt;
+  }
+  return at(static_cast<size_t>(record - records));
+}
+} // namespace o2::bkp::api
@@ -0,0 +1,38 @@
+//  Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+//  See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+//  All rights not expressly granted are reserved.
+//
+//  This software is distributed under the terms of the GNU General Public
+//  License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+//  In applying this license CERN does not waive the privileges and immunities
+//  granted to it by virtue of its status as an Intergovernmental Organization
+//  or submit itself to any jurisdiction.
+
+#include "BookkeepingApi/TraceScope.h"
+
+#include <utility>
+
+namespace o2::bkp::api
+{
+namespace
+{
+thread_local const TraceScope* innermostScope = nullptr;
+} // namespace
+
+TraceScope::TraceScope(std::string traceparent) : mTraceparent(std::move(traceparent)), mOuter(innermostScope)
+{
+  innermostScope = this;
+}
+
+TraceScope::~TraceScope()
+{
+  innermostScope = mOuter;
+}
+
+const std::string& TraceScope::current()
+{
+  static const std::string none;
+  return innermostScope ? innermostScope->mTraceparent : none;
+}
+} // namespace o2::bkp::api
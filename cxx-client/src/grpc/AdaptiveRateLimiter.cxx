@@ -0,0 +1,108 @@
+//  Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+//  See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+//  All rights not expressly granted are reserved.
+//
+//  This software is distributed under the terms of the GNU General Public
+//  License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+//  In applying this license CERN does not waive the privileges and immunities
+//  granted to it by virtue of its status as an Intergovernmental Organization
+//  or submit itself to any jurisdiction.
+
+#include "AdaptiveRateLimiter.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+
+namespace o2::bkp::api::grpc
+{
+namespace
+{
+/// Overload signals received within this delay after a decrease belong to the same congestion event
+constexpr std::chrono::milliseconds DECREASE_COOLDOWN{ 100 };
+
+bool isOverloadSignal(::grpc::StatusCode code)
+{
+  return code == ::grpc::StatusCode::RESOURCE_EXHAUSTED
+         || code == ::grpc::StatusCode::UNAVAILABLE
+         || code == ::grpc::StatusCode::DEADLINE_EXCEEDED;
+}
+} // namespace
+
+AdaptiveRateLimiter::AdaptiveRateLimiter(std::string serviceName, const RateLimiterOptions& options)
+  : mServiceName(std::move(serviceName)),
+    mOptions(options),
+    mRate(std::clamp(options.initialRate, options.minRate, options.maxRate)),
+    mTokens(options.burst),
+    mLastRefill(Clock::now()),
+    mLastDecrease(mLastRefill - DECREASE_COOLDOWN)
+{
+}
+
+void AdaptiveRateLimiter::refill(Clock::time_point now)
+{
+  std::chrono::duration<double> elapsed = now - mLastRefill;
+  mTokens = std::min(mOptions.burst, mTokens + elapsed.count() * mRate);
+  mLastRefill = now;
+}
+
+void AdaptiveRateLimiter::acquire()
+{
+  auto wait = reserve();
+  if (wait.count() > 0) {
+    std::this_thread::sleep_for(wait);
+  }
+}
+
+std::chrono::nanoseconds AdaptiveRateLimiter::reserve()
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  refill(Clock::now());
+
+  // Tokens are reserved even when not available yet, the debt defines how long this call has to wait
+  std::chrono::duration<double> wait((1 - mTokens) / mRate);
+  if (wait > mOptions.maxWait) {
+    mRejectedCalls++;
+    throw std::runtime_error(
+      "Bookkeeping " + mServiceName + " is overloaded, call rejected by the client rate limiter (current rate: "
+      + std::to_string(mRate) + " calls/s)");
+  }
+  mTokens -= 1;
+  if (wait.count() <= 0) {
+    return std::chrono::nanoseconds::zero();
+  }
+  mThrottledCalls++;
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(wait);
+}
+
+void AdaptiveRateLimiter::onCompletion(const ::grpc::Status& status)
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  auto now = Clock::now();
+  refill(now);
+
+  if (status.ok()) {
+    // Each success is worth 1/rate second of traffic, so the rate grows by additiveIncrease every second
+    mRate = std::min(mOptions.maxRate, mRate + mOptions.additiveIncrease / mRate);
+  } else if (isOverloadSignal(status.error_code()) && now - mLastDecrease >= DECREASE_COOLDOWN) {
+    mRate = std::max(mOptions.minRate, mRate * mOptions.multiplicativeDecrease);
+    mTokens = std::min(mTokens, 0.0);
+    mLastDecrease = now;
+    mBackoffs++;
+  }
+}
+
+RateLimiterState AdaptiveRateLimiter::state() const
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  std::chrono::duration<double> elapsed = Clock::now() - mLastRefill;
+  return {
+    mRate,
+    std::min(mOptions.burst, mTokens + elapsed.count() * mRate),
+    mThrottledCalls,
+    mRejectedCalls,
+    mBackoffs,
+  };
+}
+} // namespace o2::bkp::api::grpc
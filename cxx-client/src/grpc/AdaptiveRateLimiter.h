@@ -0,0 +1,69 @@
+//  Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+//  See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+//  All rights not expressly granted are reserved.
+//
+//  This software is distributed under the terms of the GNU General Public
+//  License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+//  In applying this license CERN does not waive the privileges and immunities
+//  granted to it by virtue of its status as an Intergovernmental Organization
+//  or submit itself to any jurisdiction.
+
+#ifndef CXX_CLIENT_GRPC_ADAPTIVERATELIMITER_H
+#define CXX_CLIENT_GRPC_ADAPTIVERATELIMITER_H
+
+#include "BookkeepingApi/BkpClientOptions.h"
+#include "BookkeepingApi/RateLimiterState.h"
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <grpcpp/support/status.h>
+
+namespace o2::bkp::api::grpc
+{
+/**
+ * Token bucket whose rate follows an AIMD (additive increase, multiplicative decrease) law driven by calls' status
+ *
+ * Calls take a token before reaching the server and wait if none is available, or fail immediately if the wait would
+ * exceed the configured budget, so that an overloaded server sees the load of its clients decrease instead of
+ * receiving retries at full rate.
+ */
+class AdaptiveRateLimiter
+{
+ public:
+  AdaptiveRateLimiter(std::string serviceName, const RateLimiterOptions& options);
+
+  /// Take a token, waiting for it if needed, throw std::runtime_error if it can not be obtained in time
+  void acquire();
+
+  /// Take a token without waiting for it, return how long the call must be delayed, throw std::runtime_error if it
+  /// can not be obtained in time
+  std::chrono::nanoseconds reserve();
+
+  /// Adapt the rate to the status of a call that went through the limiter
+  void onCompletion(const ::grpc::Status& status);
+
+  RateLimiterState state() const;
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  /// Add the tokens earned since the last refill, lock must be held
+  void refill(Clock::time_point now);
+
+  std::string mServiceName;
+  RateLimiterOptions mOptions;
+
+  mutable std::mutex mMutex;
+  double mRate;
+  double mTokens;
+  Clock::time_point mLastRefill;
+  Clock::time_point mLastDecrease;
+  uint64_t mThrottledCalls = 0;
+  uint64_t mRejectedCalls = 0;
+  uint64_t mBackoffs = 0;
+};
+} // namespace o2::bkp::api::grpc
+
+#endif // CXX_CLIENT_GRPC_ADAPTIVERATELIMITER_H
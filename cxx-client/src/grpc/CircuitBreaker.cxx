@@ -0,0 +1,84 @@
+//  Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+//  See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+//  All rights not expressly granted are reserved.
+//
+//  This software is distributed under the terms of the GNU General Public
+//  License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+//  In applying this license CERN does not waive the privileges and immunities
+//  granted to it by virtue of its status as an Intergovernmental Organization
+//  or submit itself to any jurisdiction.
+
+#include "CircuitBreaker.h"
+
+namespace o2::bkp::api::grpc
+{
+namespace
+{
+/// Only failures meaning that the server could not be reached count, application errors prove that it is up
+bool isUnreachableSignal(::grpc::StatusCode code)
+{
+  return code == ::grpc::StatusCode::UNAVAILABLE || code == ::grpc::StatusCode::DEADLINE_EXCEEDED;
+}
+} // namespace
+
+CircuitBreaker::CircuitBreaker(const CircuitBreakerOptions& options) : mOptions(options)
+{
+}
+
+CircuitBreaker::Admission CircuitBreaker::admit()
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  switch (mState) {
+    case CircuitBreakerState::CLOSED:
+      return Admission::ALLOWED;
+    case CircuitBreakerState::OPEN:
+      if (Clock::now() - mOpenedAt < mOptions.openDuration) {
+        return Admission::REFUSED;
+      }
+      mState = CircuitBreakerState::HALF_OPEN;
+      mProbeInFlight = true;
+      return Admission::PROBE;
+    case CircuitBreakerState::HALF_OPEN:
+      // Only one probe at a time, the others keep failing fast until it completes
+      if (mProbeInFlight) {
+        return Admission::REFUSED;
+      }
+      mProbeInFlight = true;
+      return Admission::PROBE;
+  }
+  return Admission::ALLOWED;
+}
+
+void CircuitBreaker::onCompletion(const ::grpc::Status& status)
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  if (!isUnreachableSignal(status.error_code())) {
+    mState = CircuitBreakerState::CLOSED;
+    mConsecutiveFailures = 0;
+    mProbeInFlight = false;
+    return;
+  }
+
+  mConsecutiveFailures++;
+  if (mState == CircuitBreakerState::HALF_OPEN || mConsecutiveFailures >= mOptions.failureThreshold) {
+    mState = CircuitBreakerState::OPEN;
+    mOpenedAt = Clock::now();
+    mProbeInFlight = false;
+  }
+}
+
+void CircuitBreaker::onCancellation()
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  if (mState == CircuitBreakerState::HALF_OPEN) {
+    mProbeInFlight = false;
+  }
+}
+
+CircuitBreakerState CircuitBreaker::state() const
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  return mState;
+}
+} // namespace o2::bkp::api::grpc
@@ -0,0 +1,64 @@
+//  Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+//  See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+//  All rights not expressly granted are reserved.
+//
+//  This software is distributed under the terms of the GNU General Public
+//  License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+//  In applying this license CERN does not waive the privileges and immunities
+//  granted to it by virtue of its status as an Intergovernmental Organization
+//  or submit itself to any jurisdiction.
+
+#ifndef CXX_CLIENT_GRPC_CIRCUITBREAKER_H
+#define CXX_CLIENT_GRPC_CIRCUITBREAKER_H
+
+#include "BookkeepingApi/BkpClientOptions.h"
+#include "BookkeepingApi/CircuitBreakerState.h"
+
+#include <chrono>
+#include <mutex>
+#include <grpcpp/support/status.h>
+
+namespace o2::bkp::api::grpc
+{
+/// Circuit breaker protecting callers from waiting on an unreachable server, shared by all the services of a channel
+class CircuitBreaker
+{
+ public:
+  /// Decision taken by the breaker for a given call
+  enum class Admission {
+    /// The call must fail immediately
+    REFUSED,
+    /// The call can reach the server
+    ALLOWED,
+    /// The call is the one probing whether the server is reachable again
+    PROBE,
+  };
+
+  explicit CircuitBreaker(const CircuitBreakerOptions& options);
+
+  /// Decide if a call can reach the server
+  Admission admit();
+
+  /// Update the breaker with the status of a call that has been allowed
+  void onCompletion(const ::grpc::Status& status);
+
+  /// Notify that a call that has been allowed will not be sent after all
+  void onCancellation();
+
+  CircuitBreakerState state() const;
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  CircuitBreakerOptions mOptions;
+
+  mutable std::mutex mMutex;
+  CircuitBreakerState mState = CircuitBreakerState::CLOSED;
+  uint32_t mConsecutiveFailures = 0;
+  Clock::time_point mOpenedAt;
+  bool mProbeInFlight = false;
+};
+} // namespace o2::bkp::api::grpc
+
+#endif // CXX_CLIENT_GRPC_CIRCUITBREAKER_H
@@ -0,0 +1,77 @@
+//  Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+//  See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+//  All rights not expressly granted are reserved.
+//
+//  This software is distributed under the terms of the GNU General Public
+//  License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+//  In applying this license CERN does not waive the privileges and immunities
+//  granted to it by virtue of its status as an Intergovernmental Organization
+//  or submit itself to any jurisdiction.
+
+
+#include "ConnectivityWatcher.h"
+
+#include <chrono>
+
+namespace o2::bkp::api::grpc
+{
+namespace
+{
+/// Watches are renewed at this interval even without change, to notice the end of the watcher
+constexpr std::chrono::milliseconds WATCH_TIMEOUT{ 200 };
+} // namespace
+
+ConnectivityWatcher::ConnectivityWatcher(std::vector<std::string> uris, std::vector<std::shared_ptr<::grpc::ChannelInterface>> channels, Callback callback)
+  : mUris(std::move(uris)), mChannels(std::move(channels)), mCallback(std::move(callback))
+{
+  for (size_t channelIndex = 0; channelIndex < mChannels.size(); channelIndex++) {
+    mLastStates.push_back(mChannels[channelIndex]->GetState(false));
+    watch(channelIndex);
+  }
+  mThread = std::thread([this]() { run(); });
+}
+
+ConnectivityWatcher::~ConnectivityWatcher()
+{
+  mStopping = true;
+  mThread.join();
+}
+
+void ConnectivityWatcher::watch(size_t channelIndex)
+{
+  mChannels[channelIndex]->NotifyOnStateChange(
+    mLastStates[channelIndex],
+    std::chrono::system_clock::now() + WATCH_TIMEOUT,
+    &mCompletionQueue,
+    reinterpret_cast<void*>(channelIndex));
+}
+
+void ConnectivityWatcher::run()
+{
+  void* tag;
+  bool changed;
+  // Pending watches all time out, so the queue can be shut down once it stopped renewing them
+  size_t pendingWatches = mChannels.size();
+  while (pendingWatches > 0 && mCompletionQueue.Next(&tag, &changed)) {
+    auto channelIndex = reinterpret_cast<size_t>(tag);
+    if (changed) {
+      auto state = mChannels[channelIndex]->GetState(false);
+      if (state != mLastStates[channelIndex]) {
+        mLastStates[channelIndex] = state;
+        // ConnectivityState follows the order of grpc_connectivity_state
+        mCallback(mUris[channelIndex], static_cast<ConnectivityState>(state));
+      }
+    }
+
+    if (mStopping) {
+      pendingWatches--;
+    } else {
+      watch(channelIndex);
+    }
+  }
+  mCompletionQueue.Shutdown();
+  while (mCompletionQueue.Next(&tag, &changed)) {
+  }
+}
+} // namespace o2::bkp::api::grpc
@@ -0,0 +1,59 @@
+//  Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+//  See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+//  All rights not expressly granted are reserved.
+//
+//  This software is distributed under the terms of the GNU General Public
+//  License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+//  In applying this license CERN does not waive the privileges and immunities
+//  granted to it by virtue of its status as an Intergovernmental Organization
+//  or submit itself to any jurisdiction.
+
+
+#ifndef CXX_CLIENT_GRPC_CONNECTIVITYWATCHER_H
+#define CXX_CLIENT_GRPC_CONNECTIVITYWATCHER_H
+
+#include "BookkeepingApi/ConnectivityState.h"
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <grpcpp/channel.h>
+#include <grpcpp/completion_queue.h>
+
+namespace o2::bkp::api::grpc
+{
+/// Report the connectivity state changes of a set of channels, from a single thread polling a completion queue
+class ConnectivityWatcher
+{
+ public:
+  using Callback = std::function<void(const std::string& uri, ConnectivityState state)>;
+
+  /// Start watching the given channels, indexed like their URIs
+  ConnectivityWatcher(std::vector<std::string> uris, std::vector<std::shared_ptr<::grpc::ChannelInterface>> channels, Callback callback);
+  ~ConnectivityWatcher();
+
+  ConnectivityWatcher(const ConnectivityWatcher&) = delete;
+  ConnectivityWatcher& operator=(const ConnectivityWatcher&) = delete;
+
+ private:
+  /// Register for the next state change of a given channel
+  void watch(size_t channelIndex);
+
+  void run();
+
+  std::vector<std::string> mUris;
+  std::vector<std::shared_ptr<::grpc::ChannelInterface>> mChannels;
+  std::vector<grpc_connectivity_state> mLastStates;
+  Callback mCallback;
+
+  ::grpc::CompletionQueue mCompletionQueue;
+  std::atomic<bool> mStopping{ false };
+  std::thread mThread;
+};
+} // namespace o2::bkp::api::grpc
+
+#endif // CXX_CLIENT_GRPC_CONNECTIVITYWATCHER_H
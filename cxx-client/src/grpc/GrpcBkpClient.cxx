@@ -11,18 +11,18 @@
 
 #include "GrpcBkpClient.h"
 #include <memory>
+#include <thread>
 #include <grpc++/grpc++.h>
 #include "grpc/services/GrpcFlpServiceClient.h"
 #include "grpc/services/GrpcDplProcessExecutionClient.h"
 #include "grpc/services/GrpcQcFlagServiceClient.h"
 #include "grpc/services/GrpcCtpTriggerCountersServiceClient.h"
 #include "grpc/services/GrpcRunServiceClient.h"
-
-using grpc::Channel;
+#include "grpc/services/GrpcLhcFillServiceClient.h"
+#include "grpc/services/GrpcLogServiceClient.h"
+#include "grpc/services/GrpcEnvironmentServiceClient.h"
 
 using grpc::ClientContext;
-using grpc::CreateChannel;
-using grpc::InsecureChannelCredentials;
 using o2::bkp::api::FlpServiceClient;
 using o2::bookkeeping::Flp;
 using o2::bookkeeping::FlpService;
@@ -34,19 +34,94 @@ namespace o2::bkp::api::grpc
 {
 using services::GrpcCtpTriggerCountersServiceClient;
 using services::GrpcDplProcessExecutionClient;
+using services::GrpcEnvironmentServiceClient;
 using services::GrpcFlpServiceClient;
+using services::GrpcLhcFillServiceClient;
+using services::GrpcLogServiceClient;
 using services::GrpcQcFlagServiceClient;
 using services::GrpcRunServiceClient;
 
-GrpcBkpClient::GrpcBkpClient(const string& uri, const std::function<std::unique_ptr<ClientContext>()>& clientContextFactory)
+GrpcBkpClient::GrpcBkpClient(const std::vector<string>& uris, const std::function<std::unique_ptr<ClientContext>()>& clientContextFactory, const BkpClientOptions& options)
+  : mInFlightCalls(std::make_shared<InFlightCalls>()),
+    mShutdownOptions(options.shutdown)
+{
+  std::shared_ptr<TrafficCapture> capture;
+  if (!options.capture.path.empty()) {
+    capture = std::make_shared<TrafficCapture>(options.capture);
+  }
+  mEndpointPool = std::make_shared<GrpcEndpointPool>(uris, options.priorityLanes, options.loadBalancing, options.circuitBreaker, std::move(capture));
+  auto criticalChannels = mEndpointPool->channels(TrafficClass::CRITICAL);
+  auto bulkChannels = mEndpointPool->channels(TrafficClass::BULK);
+  if (options.connection.onStateChange) {
+    mConnectivityWatcher = std::make_unique<ConnectivityWatcher>(uris, criticalChannels, options.connection.onStateChange);
+  }
+  if (options.connection.prewarm) {
+    mEndpointPool->connect();
+  }
+  if (options.priorityLanes.enabled) {
+    mTrafficScheduler = std::make_shared<TrafficScheduler>(options.priorityLanes);
+  }
+  if (options.tracing.enabled) {
+    mTracer = std::make_shared<Tracer>(options.tracing);
+  }
+
+  mFlpClient = make_unique<GrpcFlpServiceClient>(
+    bulkChannels,
+    createCallExecutor("flp", TrafficClass::BULK, clientContextFactory, options));
+  mDplProcessExecutionClient = make_unique<GrpcDplProcessExecutionClient>(
+    criticalChannels,
+    createCallExecutor("dplProcessExecution", TrafficClass::CRITICAL, clientContextFactory, options));
+  mQcFlagClient = make_unique<GrpcQcFlagServiceClient>(
+    criticalChannels,
+    createCallExecutor("qcFlag", TrafficClass::CRITICAL, clientContextFactory, options));
+  mCtpTriggerCountersClient = make_unique<GrpcCtpTriggerCountersServiceClient>(
+    bulkChannels,
+    createCallExecutor("ctpTriggerCounters", TrafficClass::BULK, clientContextFactory, options));
+  mRunClient = make_unique<GrpcRunServiceClient>(
+    criticalChannels,
+    createCallExecutor("run", TrafficClass::CRITICAL, clientContextFactory, options));
+  mLhcFillClient = make_unique<GrpcLhcFillServiceClient>(
+    criticalChannels,
+    createCallExecutor("lhcFill", TrafficClass::CRITICAL, clientContextFactory, options));
+  // Attachments uploads are large, they must not hold the connection used by critical calls
+  mLogClient = make_unique<GrpcLogServiceClient>(
+    bulkChannels,
+    createCallExecutor("log", TrafficClass::BULK, clientContextFactory, options));
+  mEnvironmentClient = make_unique<GrpcEnvironmentServiceClient>(
+    criticalChannels,
+    createCallExecutor("environment", TrafficClass::CRITICAL, clientContextFactory, options));
+}
+
+unique_ptr<GrpcCallExecutor> GrpcBkpClient::createCallExecutor(
+  const string& serviceName,
+  TrafficClass trafficClass,
+  const std::function<std::unique_ptr<ClientContext>()>& clientContextFactory,
+  const BkpClientOptions& options)
 {
-  auto channel = CreateChannel(uri, InsecureChannelCredentials());
+  std::shared_ptr<AdaptiveRateLimiter> rateLimiter;
+  if (options.rateLimiter.enabled) {
+    rateLimiter = std::make_shared<AdaptiveRateLimiter>(serviceName, options.rateLimiter);
+    mRateLimiters.emplace(serviceName, rateLimiter);
+  }
+  return make_unique<GrpcCallExecutor>(serviceName, clientContextFactory, rateLimiter, options.circuitBreaker, options.retry, options.callTiming, trafficClass, mTrafficScheduler, mEndpointPool, mTracer, mInFlightCalls);
+}
 
-  mFlpClient = make_unique<GrpcFlpServiceClient>(channel, clientContextFactory);
-  mDplProcessExecutionClient = make_unique<GrpcDplProcessExecutionClient>(channel, clientContextFactory);
-  mQcFlagClient = make_unique<GrpcQcFlagServiceClient>(channel, clientContextFactory);
-  mCtpTriggerCountersClient = make_unique<GrpcCtpTriggerCountersServiceClient>(channel, clientContextFactory);
-  mRunClient = make_unique<GrpcRunServiceClient>(channel, clientContextFactory);
+GrpcBkpClient::~GrpcBkpClient()
+{
+  auto report = shutdown(std::chrono::system_clock::now() + mShutdownOptions.budget);
+  if (!report.drained() && mShutdownOptions.onAbandoned) {
+    mShutdownOptions.onAbandoned(report);
+  }
+  // The abandoned calls have been cancelled, the executors must outlive their completion. When the client is destroyed
+  // by the completion of one of its calls, that call only needs its registration which keeps the calls alive.
+  mInFlightCalls->waitUntilDrained();
+  if (mInFlightCalls->completing()) {
+    // gRPC channels must not be destroyed by one of their callbacks, they are released once the completion is over
+    std::thread([endpointPool = mEndpointPool, inFlightCalls = mInFlightCalls]() mutable {
+      inFlightCalls->waitUntilDrained();
+      endpointPool.reset();
+    }).detach();
+  }
 }
 
 const unique_ptr<FlpServiceClient>& GrpcBkpClient::flp() const
@@ -78,4 +153,49 @@ const unique_ptr<RunServiceClient>& GrpcBkpClient::run() const
 {
   return mRunClient;
 }
+
+const unique_ptr<LhcFillServiceClient>& GrpcBkpClient::lhcFill() const
+{
+  return mLhcFillClient;
+}
+
+const unique_ptr<LogServiceClient>& GrpcBkpClient::log() const
+{
+  return mLogClient;
+}
+
+const unique_ptr<EnvironmentServiceClient>& GrpcBkpClient::environment() const
+{
+  return mEnvironmentClient;
+}
+
+std::map<string, RateLimiterState> GrpcBkpClient::rateLimiterStates() const
+{
+  std::map<string, RateLimiterState> states;
+  for (const auto& [serviceName, rateLimiter] : mRateLimiters) {
+    states.emplace(serviceName, rateLimiter->state());
+  }
+  return states;
+}
+
+std::vector<EndpointState> GrpcBkpClient::endpointStates() const
+{
+  return mEndpointPool->states();
+}
+
+bool GrpcBkpClient::waitUntilConnected(std::chrono::milliseconds budget)
+{
+  return mEndpointPool->waitUntilConnected(std::chrono::system_clock::now() + budget);
+}
+
+ShutdownReport GrpcBkpClient::shutdown(std::chrono::system_clock::time_point deadline)
+{
+  mInFlightCalls->close();
+  return { mInFlightCalls->drain(deadline) };
+}
+
+CircuitBreakerState GrpcBkpClient::circuitBreakerState() const
+{
+  return mEndpointPool->circuitBreakerState();
+}
 } // namespace o2::bkp::api::grpc
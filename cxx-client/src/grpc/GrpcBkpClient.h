@@ -14,9 +14,20 @@
 
 #include "flp.grpc.pb.h"
 #include "BookkeepingApi/BkpClient.h"
+#include "BookkeepingApi/BkpClientOptions.h"
+#include "grpc/AdaptiveRateLimiter.h"
+#include "grpc/ConnectivityWatcher.h"
+#include "grpc/GrpcCallExecutor.h"
+#include "grpc/GrpcEndpointPool.h"
+#include "grpc/InFlightCalls.h"
+#include "grpc/Tracer.h"
+#include "grpc/TrafficScheduler.h"
 
 #include <functional>
+#include <map>
 #include <memory>
+#include <string>
+#include <vector>
 
 namespace o2::bkp::api::grpc
 {
@@ -24,8 +35,12 @@ namespace o2::bkp::api::grpc
 class GrpcBkpClient : public o2::bkp::api::BkpClient
 {
  public:
-  explicit GrpcBkpClient(const std::string& uri, const std::function<std::unique_ptr<::grpc::ClientContext> ()>& clientContextFactory);
-  ~GrpcBkpClient() override = default;
+  /// Create a client balancing its calls over the given endpoints
+  explicit GrpcBkpClient(
+    const std::vector<std::string>& uris,
+    const std::function<std::unique_ptr<::grpc::ClientContext> ()>& clientContextFactory,
+    const BkpClientOptions& options = {});
+  ~GrpcBkpClient() override;
 
   const std::unique_ptr<FlpServiceClient>& flp() const override;
 
@@ -40,12 +55,45 @@ class GrpcBkpClient : public o2::bkp::api::BkpClient
 
   const std::unique_ptr<RunServiceClient>& run() const override;
 
+  const std::unique_ptr<LhcFillServiceClient>& lhcFill() const override;
+
+  const std::unique_ptr<LogServiceClient>& log() const override;
+
+  const std::unique_ptr<EnvironmentServiceClient>& environment() const override;
+
+  std::map<std::string, RateLimiterState> rateLimiterStates() const override;
+
+  CircuitBreakerState circuitBreakerState() const override;
+
+  std::vector<EndpointState> endpointStates() const override;
+
+  bool waitUntilConnected(std::chrono::milliseconds budget) override;
+
+  ShutdownReport shutdown(std::chrono::system_clock::time_point deadline) override;
+
  private:
+  /// Create the call executor of a given service in the given traffic class, registering its rate limiter if any
+  std::unique_ptr<GrpcCallExecutor> createCallExecutor(
+    const std::string& serviceName,
+    TrafficClass trafficClass,
+    const std::function<std::unique_ptr<::grpc::ClientContext> ()>& clientContextFactory,
+    const BkpClientOptions& options);
+
+  std::map<std::string, std::shared_ptr<AdaptiveRateLimiter>> mRateLimiters;
+  std::shared_ptr<TrafficScheduler> mTrafficScheduler;
+  std::shared_ptr<GrpcEndpointPool> mEndpointPool;
+  std::shared_ptr<Tracer> mTracer;
+  std::shared_ptr<InFlightCalls> mInFlightCalls;
+  ShutdownOptions mShutdownOptions;
+  std::unique_ptr<ConnectivityWatcher> mConnectivityWatcher;
   std::unique_ptr<::o2::bkp::api::FlpServiceClient> mFlpClient;
   std::unique_ptr<::o2::bkp::api::DplProcessExecutionClient> mDplProcessExecutionClient;
   std::unique_ptr<::o2::bkp::api::QcFlagServiceClient> mQcFlagClient;
   std::unique_ptr<::o2::bkp::api::CtpTriggerCountersServiceClient> mCtpTriggerCountersClient;
   std::unique_ptr<::o2::bkp::api::RunServiceClient> mRunClient;
+  std::unique_ptr<::o2::bkp::api::LhcFillServiceClient> mLhcFillClient;
+  std::unique_ptr<::o2::bkp::api::LogServiceClient> mLogClient;
+  std::unique_ptr<::o2::bkp::api::EnvironmentServiceClient> mEnvironmentClient;
 };
 } // namespace o2::bkp::api::grpc
 
@@ -0,0 +1,355 @@
+//  Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+//  See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+//  All rights not expressly granted are reserved.
+//
+//  This software is distributed under the terms of the GNU General Public
+//  License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+//  In applying this license CERN does not waive the privileges and immunities
+//  granted to it by virtue of its status as an Intergovernmental Organization
+//  or submit itself to any jurisdiction.
+
+#include "GrpcCallExecutor.h"
+#include "BookkeepingApi/TraceScope.h"
+
+#include <stdexcept>
+#include <thread>
+
+namespace o2::bkp::api::grpc
+{
+GrpcCallExecutor::GrpcCallExecutor(
+  std::string serviceName,
+  const std::function<std::unique_ptr<::grpc::ClientContext>()>& clientContextFactory,
+  std::shared_ptr<AdaptiveRateLimiter> rateLimiter,
+  const CircuitBreakerOptions& circuitBreakerOptions,
+  const RetryOptions& retryOptions,
+  const CallTimingOptions& callTimingOptions,
+  TrafficClass trafficClass,
+  std::shared_ptr<TrafficScheduler> trafficScheduler,
+  std::shared_ptr<GrpcEndpointPool> endpointPool,
+  std::shared_ptr<Tracer> tracer,
+  std::shared_ptr<InFlightCalls> inFlightCalls)
+  : mServiceName(std::move(serviceName)),
+    mClientContextFactory(clientContextFactory),
+    mRateLimiter(std::move(rateLimiter)),
+    mCircuitBreakerFallback(circuitBreakerOptions.fallback),
+    mCircuitBreakerProbeTimeout(circuitBreakerOptions.probeTimeout),
+    mRetryOptions(retryOptions),
+    mOnCallTiming(callTimingOptions.onCall),
+    mTrafficClass(trafficClass),
+    mTrafficScheduler(std::move(trafficScheduler)),
+    mEndpointPool(std::move(endpointPool)),
+    mTracer(std::move(tracer)),
+    mInFlightCalls(std::move(inFlightCalls))
+{
+}
+
+void GrpcCallExecutor::execute(const char* methodName, const std::function<::grpc::Status(::grpc::ClientContext*, size_t endpoint)>& call, RetryEndpoint retryEndpoint, CallKind kind)
+{
+  auto registration = mInFlightCalls->enter(mServiceName, methodName, OnShutdown::DRAIN);
+  std::chrono::duration<double, std::milli> backoff = mRetryOptions.initialBackoff;
+  std::optional<size_t> firstEndpoint;
+  for (uint32_t attempt = 1;; attempt++) {
+    ::grpc::Status status;
+    size_t endpoint;
+    if (!executeAttempt(methodName, kind, call, registration, firstEndpoint, endpoint, status)) {
+      return;
+    }
+    if (retryEndpoint == RetryEndpoint::FIRST) {
+      firstEndpoint = endpoint;
+    }
+
+    auto error = complete(endpoint, status);
+    if (!error) {
+      return;
+    }
+    if (!shouldRetry(status, attempt, retryEndpoint, kind)) {
+      std::rethrow_exception(error);
+    }
+    std::this_thread::sleep_for(backoff);
+    backoff *= mRetryOptions.backoffMultiplier;
+  }
+}
+
+bool GrpcCallExecutor::executeAttempt(const char* methodName, CallKind kind, const std::function<::grpc::Status(::grpc::ClientContext*, size_t endpoint)>& call, InFlightCalls::Registration& registration, std::optional<size_t> endpoint, size_t& usedEndpoint, ::grpc::Status& status)
+{
+  // An attempt refused by the circuit breaker has no timing
+  setLastCallTiming({});
+  auto admission = admit(methodName, kind, endpoint);
+  if (admission.decision == CircuitBreaker::Admission::REFUSED) {
+    return false;
+  }
+
+  if (mRateLimiter) {
+    try {
+      mRateLimiter->acquire();
+    } catch (const std::runtime_error&) {
+      mEndpointPool->onCancellation(admission);
+      throw;
+    }
+  }
+
+  auto context = createContext(admission);
+  if (!registration.attach(context.get())) {
+    abandon(methodName, admission);
+  }
+  auto span = startSpan(TraceScope::current(), *context);
+  TrafficScheduler::Slot trafficSlot(mTrafficScheduler.get(), mTrafficClass);
+  usedEndpoint = admission.endpoint ? mEndpointPool->acquire(*admission.endpoint) : mEndpointPool->acquire();
+  auto callStart = std::chrono::steady_clock::now();
+  try {
+    status = call(context.get(), usedEndpoint);
+  } catch (...) {
+    // Failed before reaching the server, nothing must stay attached to the call
+    registration.attach(nullptr);
+    mEndpointPool->release(usedEndpoint, ::grpc::Status::CANCELLED, std::chrono::steady_clock::duration::zero());
+    endSpan(span, methodName, ::grpc::Status::CANCELLED);
+    mEndpointPool->onCancellation(admission);
+    throw;
+  }
+  registration.attach(nullptr);
+  auto callDuration = std::chrono::steady_clock::now() - callStart;
+  mEndpointPool->release(usedEndpoint, status, callDuration);
+  trafficSlot.release();
+  endSpan(span, methodName, status);
+  // Last, as it runs the call timing listener of the user
+  setLastCallTiming(recordTiming(methodName, *context, callDuration));
+  return true;
+}
+
+bool GrpcCallExecutor::shouldRetry(const ::grpc::Status& status, uint32_t attempt, RetryEndpoint retryEndpoint, CallKind kind) const
+{
+  // Only the requests carrying an idempotency key are pinned to their first endpoint
+  auto safeToRepeat = kind == CallKind::READ || retryEndpoint == RetryEndpoint::FIRST || mRetryOptions.retryWritesWithoutKey;
+  auto code = status.error_code();
+  return safeToRepeat && attempt < mRetryOptions.maxAttempts && (code == ::grpc::StatusCode::UNAVAILABLE || code == ::grpc::StatusCode::DEADLINE_EXCEEDED);
+}
+
+void GrpcCallExecutor::executeAsync(const char* methodName, AsyncCall call, Completion onDone, RetryEndpoint retryEndpoint, CallKind kind)
+{
+  auto state = std::make_shared<AsyncCallState>();
+  state->methodName = methodName;
+  state->retryEndpoint = retryEndpoint;
+  state->kind = kind;
+  state->call = std::move(call);
+  state->onDone = std::move(onDone);
+  state->backoff = mRetryOptions.initialBackoff;
+  if (mTracer) {
+    state->traceparent = TraceScope::current();
+  }
+  try {
+    state->registration = mInFlightCalls->enter(mServiceName, methodName, OnShutdown::DRAIN);
+  } catch (const std::runtime_error&) {
+    state->onDone(std::current_exception());
+    return;
+  }
+  attemptAsync(std::move(state));
+}
+
+void GrpcCallExecutor::attemptAsync(std::shared_ptr<AsyncCallState> state)
+{
+  std::chrono::nanoseconds delay{};
+  state->timing = {};
+  try {
+    state->admission = admit(state->methodName, state->kind, state->firstEndpoint);
+    if (state->admission.decision == CircuitBreaker::Admission::REFUSED) {
+      completeAsync(*state, nullptr);
+      return;
+    }
+    if (mRateLimiter) {
+      try {
+        delay = mRateLimiter->reserve();
+      } catch (const std::runtime_error&) {
+        mEndpointPool->onCancellation(state->admission);
+        throw;
+      }
+    }
+    state->context = createContext(state->admission);
+    if (!state->registration->attach(state->context.get())) {
+      abandon(state->methodName, state->admission);
+    }
+    state->span = startSpan(state->traceparent, *state->context);
+  } catch (...) {
+    completeAsync(*state, std::current_exception());
+    return;
+  }
+
+  if (delay.count() == 0) {
+    startAsync(std::move(state));
+    return;
+  }
+
+  // The alarm's callback owns the state until it fires, it then gives it back to the call to break the cycle
+  state->delay = std::make_unique<::grpc::Alarm>();
+  auto alarm = state->delay.get();
+  alarm->Set(std::chrono::system_clock::now() + delay, [this, state](bool) mutable { startAsync(std::move(state)); });
+}
+
+std::optional<GrpcCallExecutor::StreamingCall> GrpcCallExecutor::startStreaming(const char* methodName, OnShutdown onShutdown, CallKind kind)
+{
+  auto registration = mInFlightCalls->enter(mServiceName, methodName, onShutdown);
+  auto admission = admit(methodName, kind, std::nullopt);
+  if (admission.decision == CircuitBreaker::Admission::REFUSED) {
+    return std::nullopt;
+  }
+
+  if (mRateLimiter) {
+    try {
+      mRateLimiter->acquire();
+    } catch (const std::runtime_error&) {
+      mEndpointPool->onCancellation(admission);
+      throw;
+    }
+  }
+
+  StreamingCall call;
+  call.context = createContext(admission);
+  if (!registration.attach(call.context.get())) {
+    abandon(methodName, admission);
+  }
+  call.registration = std::move(registration);
+  call.endpoint = admission.endpoint ? mEndpointPool->acquire(*admission.endpoint) : mEndpointPool->acquire();
+  call.methodName = methodName;
+  call.span = startSpan(TraceScope::current(), *call.context);
+  call.start = std::chrono::steady_clock::now();
+  return call;
+}
+
+void GrpcCallExecutor::finishStreaming(StreamingCall& call, const ::grpc::Status& status)
+{
+  // A long stream is not a slow call, only its failure counts against the endpoint
+  mEndpointPool->release(call.endpoint, status, std::chrono::steady_clock::duration::zero());
+  endSpan(call.span, call.methodName, status);
+  auto callDuration = std::chrono::steady_clock::now() - call.start;
+  call.registration.reset();
+  auto error = complete(call.endpoint, status);
+  setLastCallTiming(recordTiming(call.methodName, *call.context, callDuration));
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+GrpcEndpointPool::Admission GrpcCallExecutor::admit(const char* methodName, CallKind kind, std::optional<size_t> endpoint)
+{
+  auto admission = mEndpointPool->admit(endpoint);
+  if (admission.decision == CircuitBreaker::Admission::REFUSED) {
+    if (!mCircuitBreakerFallback || kind == CallKind::READ) {
+      throw std::runtime_error("Bookkeeping is unreachable, " + mServiceName + "/" + methodName + " call refused by the open circuit breaker");
+    }
+    mCircuitBreakerFallback(mServiceName, methodName);
+  }
+  return admission;
+}
+
+std::unique_ptr<::grpc::ClientContext> GrpcCallExecutor::createContext(const GrpcEndpointPool::Admission& admission)
+{
+  auto context = mClientContextFactory();
+  if (admission.decision == CircuitBreaker::Admission::PROBE) {
+    // Give the channel a chance to reconnect instead of failing right away on its previous connection failure
+    context->set_wait_for_ready(true);
+    context->set_deadline(std::chrono::system_clock::now() + mCircuitBreakerProbeTimeout);
+  }
+  return context;
+}
+
+std::optional<CallSpan> GrpcCallExecutor::startSpan(const std::string& parentTraceparent, ::grpc::ClientContext& context)
+{
+  if (!mTracer) {
+    return std::nullopt;
+  }
+  auto span = mTracer->start(parentTraceparent);
+  Tracer::inject(span, context);
+  return span;
+}
+
+void GrpcCallExecutor::endSpan(const std::optional<CallSpan>& span, const char* methodName, const ::grpc::Status& status)
+{
+  if (span) {
+    mTracer->end(*span, mServiceName, methodName, status);
+  }
+}
+
+CallTiming GrpcCallExecutor::recordTiming(const char* methodName, const ::grpc::ClientContext& context, std::chrono::steady_clock::duration total)
+{
+  CallTiming timing;
+  timing.total = std::chrono::duration_cast<std::chrono::microseconds>(total);
+  timing.server = getServerTiming(context);
+  if (mOnCallTiming) {
+    mOnCallTiming(mServiceName, methodName, timing);
+  }
+  return timing;
+}
+
+void GrpcCallExecutor::abandon(const char* methodName, const GrpcEndpointPool::Admission& admission)
+{
+  // Admitted but never sent
+  mEndpointPool->onCancellation(admission);
+  throw std::runtime_error("Bookkeeping client is shut down, " + mServiceName + "/" + methodName + " call abandoned");
+}
+
+std::exception_ptr GrpcCallExecutor::complete(size_t endpoint, const ::grpc::Status& status)
+{
+  if (mRateLimiter) {
+    mRateLimiter->onCompletion(status);
+  }
+  mEndpointPool->onCompletion(endpoint, status);
+
+  if (status.ok()) {
+    return nullptr;
+  }
+  return std::make_exception_ptr(std::runtime_error(status.error_message()));
+}
+
+void GrpcCallExecutor::startAsync(std::shared_ptr<AsyncCallState> state)
+{
+  auto start = [this, state]() {
+    auto endpoint = state->admission.endpoint ? mEndpointPool->acquire(*state->admission.endpoint) : mEndpointPool->acquire();
+    if (state->retryEndpoint == RetryEndpoint::FIRST) {
+      state->firstEndpoint = endpoint;
+    }
+    auto callStart = std::chrono::steady_clock::now();
+    state->call(state->context.get(), endpoint, [this, state, endpoint, callStart](::grpc::Status status) {
+      state->registration->attach(nullptr);
+      auto callDuration = std::chrono::steady_clock::now() - callStart;
+      mEndpointPool->release(endpoint, status, callDuration);
+      // Released before running any callback of the user, which may throw or start other calls
+      if (mTrafficScheduler) {
+        mTrafficScheduler->leave(mTrafficClass);
+      }
+      endSpan(state->span, state->methodName, status);
+      state->timing = recordTiming(state->methodName, *state->context, callDuration);
+
+      auto error = complete(endpoint, status);
+      if (!error || !shouldRetry(status, state->attempt, state->retryEndpoint, state->kind)) {
+        completeAsync(*state, error);
+        return;
+      }
+      state->attempt++;
+      auto backoff = state->backoff;
+      state->backoff = std::chrono::duration_cast<std::chrono::nanoseconds>(backoff * mRetryOptions.backoffMultiplier);
+      // Same ownership as the rate limiter delay, with its own alarm as that one may still be running its callback
+      state->backoffAlarm = std::make_unique<::grpc::Alarm>();
+      auto alarm = state->backoffAlarm.get();
+      alarm->Set(std::chrono::system_clock::now() + backoff, [this, state](bool) mutable { attemptAsync(std::move(state)); });
+    });
+  };
+
+  if (mTrafficScheduler) {
+    mTrafficScheduler->enterAsync(mTrafficClass, std::move(start));
+  } else {
+    start();
+  }
+}
+
+void GrpcCallExecutor::completeAsync(AsyncCallState& state, std::exception_ptr error)
+{
+  {
+    InFlightCalls::Continuation continuation(*state.registration);
+    setLastCallTiming(state.timing);
+    state.onDone(error);
+  }
+  // The context holds the channel of the call, which must not be released by the completion if it destroyed the client
+  state.context.reset();
+  state.registration.reset();
+}
+} // namespace o2::bkp::api::grpc
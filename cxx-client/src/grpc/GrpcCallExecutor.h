@@ -0,0 +1,244 @@
+//  Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+//  See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+//  All rights not expressly granted are reserved.
+//
+//  This software is distributed under the terms of the GNU General Public
+//  License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+//  In applying this license CERN does not waive the privileges and immunities
+//  granted to it by virtue of its status as an Intergovernmental Organization
+//  or submit itself to any jurisdiction.
+
+#ifndef CXX_CLIENT_GRPC_GRPCCALLEXECUTOR_H
+#define CXX_CLIENT_GRPC_GRPCCALLEXECUTOR_H
+
+#include "BookkeepingApi/Completion.h"
+#include "grpc/AdaptiveRateLimiter.h"
+#include "grpc/CircuitBreaker.h"
+#include "grpc/GrpcEndpointPool.h"
+#include "grpc/InFlightCalls.h"
+#include "grpc/ServerTiming.h"
+#include "grpc/Tracer.h"
+#include "grpc/TrafficScheduler.h"
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+#include <grpcpp/alarm.h>
+#include <grpcpp/client_context.h>
+#include <grpcpp/support/status.h>
+
+namespace o2::bkp::api::grpc
+{
+/// Request and response of an asynchronous call, kept alive until the call completes
+template <typename Request, typename Response>
+struct CallMessages {
+  Request request;
+  Response response;
+};
+
+/// Stubs of a service, one per endpoint channel, only created on the first call to the service
+template <typename Service>
+class LazyStubs
+{
+ public:
+  explicit LazyStubs(std::vector<std::shared_ptr<::grpc::ChannelInterface>> channels) : mChannels(std::move(channels)) {}
+
+  typename Service::Stub* operator[](size_t endpoint)
+  {
+    std::call_once(mCreated, [this]() {
+      for (const auto& channel : mChannels) {
+        mStubs.push_back(Service::NewStub(channel));
+      }
+    });
+    return mStubs[endpoint].get();
+  }
+
+ private:
+  std::vector<std::shared_ptr<::grpc::ChannelInterface>> mChannels;
+  std::once_flag mCreated;
+  std::vector<std::unique_ptr<typename Service::Stub>> mStubs;
+};
+
+/// Endpoint the retries of a call are sent to
+enum class RetryEndpoint {
+  /// Any endpoint, chosen by the endpoint pool as for a new call
+  ANY,
+  /// The endpoint of the first attempt, whose server deduplicates the requests carrying the same idempotency key
+  FIRST
+};
+
+/// What a call does with bookkeeping, deciding how it completes when refused by the open circuit breaker
+enum class CallKind {
+  /// Writes to bookkeeping, the fallback is used if there is one and the call returns with a default response
+  WRITE,
+  /// Reads from bookkeeping, the call fails even with a fallback as a default response would be taken for its data
+  READ
+};
+
+/// Run the gRPC calls of a service client, applying to each of them the policies configured for this service
+class GrpcCallExecutor
+{
+ public:
+  GrpcCallExecutor(
+    std::string serviceName,
+    const std::function<std::unique_ptr<::grpc::ClientContext>()>& clientContextFactory,
+    std::shared_ptr<AdaptiveRateLimiter> rateLimiter,
+    const CircuitBreakerOptions& circuitBreakerOptions,
+    const RetryOptions& retryOptions,
+    const CallTimingOptions& callTimingOptions,
+    TrafficClass trafficClass,
+    std::shared_ptr<TrafficScheduler> trafficScheduler,
+    std::shared_ptr<GrpcEndpointPool> endpointPool,
+    std::shared_ptr<Tracer> tracer,
+    std::shared_ptr<InFlightCalls> inFlightCalls);
+
+  /**
+   * Run a call with a freshly created context
+   *
+   * If the circuit breakers of all the endpoints are open, the call is not run and the fallback is used if there is one
+   * and the call writes. A call failing because the server is unreachable is retried as configured. Throw
+   * std::runtime_error if the call fails, is refused without fallback or because the client is shut down.
+   *
+   * @param methodName the name of the gRPC method called
+   * @param call the function doing the actual call using the given context, on the stub of the given endpoint
+   * @param retryEndpoint the endpoint the retries of the call are sent to, FIRST for the requests carrying an
+   *                      idempotency key
+   * @param kind whether the call writes to or reads from bookkeeping
+   */
+  void execute(const char* methodName, const std::function<::grpc::Status(::grpc::ClientContext*, size_t endpoint)>& call, RetryEndpoint retryEndpoint = RetryEndpoint::ANY, CallKind kind = CallKind::WRITE);
+
+  /// Start a call using the gRPC callback API with the given context on the stub of the given endpoint, onStatus must
+  /// be called once it completed
+  using AsyncCall = std::function<void(::grpc::ClientContext* context, size_t endpoint, std::function<void(::grpc::Status)> onStatus)>;
+
+  /**
+   * Run a call without blocking the caller, applying the same policies as execute
+   *
+   * A call delayed by the rate limiter or waiting for a bulk slot is started later from a gRPC thread. onDone is
+   * called exactly once, with the error execute would have thrown if any, possibly before this function returns.
+   *
+   * @param methodName the name of the gRPC method called
+   * @param call the function starting the actual call using the given context
+   * @param onDone the completion receiving the outcome of the call
+   * @param retryEndpoint the endpoint the retries of the call are sent to
+   * @param kind whether the call writes to or reads from bookkeeping
+   */
+  void executeAsync(const char* methodName, AsyncCall call, Completion onDone, RetryEndpoint retryEndpoint = RetryEndpoint::ANY, CallKind kind = CallKind::WRITE);
+
+  /// Server streaming call started by startStreaming, in flight until given to finishStreaming
+  struct StreamingCall {
+    std::unique_ptr<::grpc::ClientContext> context;
+    size_t endpoint;
+    const char* methodName;
+    std::chrono::steady_clock::time_point start;
+    std::optional<CallSpan> span;
+    std::optional<InFlightCalls::Registration> registration;
+  };
+
+  /**
+   * Prepare a server streaming call, applying the circuit breaker and rate limiter policies to the call as a whole
+   *
+   * Streams are not retried, as part of the responses may already have been consumed, and do not go through the bulk
+   * traffic admission. Throw std::runtime_error if the call is refused without fallback or because the client is shut
+   * down.
+   *
+   * @param methodName the name of the gRPC method called
+   * @param onShutdown whether a shutdown of the client waits for the stream or cancels it right away
+   * @param kind whether the stream writes to or reads from bookkeeping
+   * @return the context and endpoint to open the stream with, or nothing if the call was refused and the fallback used
+   */
+  std::optional<StreamingCall> startStreaming(const char* methodName, OnShutdown onShutdown, CallKind kind = CallKind::WRITE);
+
+  /// Report the final status of a streaming call to the policies, throw std::runtime_error if it failed
+  ///
+  /// The timing of the stream, from its start to its end, is then available through CallTiming::last.
+  void finishStreaming(StreamingCall& call, const ::grpc::Status& status);
+
+ private:
+  /// Asynchronous call waiting for its turn or in flight
+  struct AsyncCallState {
+    const char* methodName;
+    AsyncCall call;
+    Completion onDone;
+    std::unique_ptr<::grpc::ClientContext> context;
+    std::unique_ptr<::grpc::Alarm> delay;
+    uint32_t attempt = 1;
+    RetryEndpoint retryEndpoint;
+    CallKind kind;
+    /// Decision of the circuit breakers for the current attempt
+    GrpcEndpointPool::Admission admission;
+    /// Endpoint of the first attempt, once started
+    std::optional<size_t> firstEndpoint;
+    std::chrono::nanoseconds backoff;
+    std::unique_ptr<::grpc::Alarm> backoffAlarm;
+    /// Trace scope current when the call was started, as its attempts may be started from other threads
+    std::string traceparent;
+    std::optional<CallSpan> span;
+    std::optional<InFlightCalls::Registration> registration;
+    /// Timing of the last attempt, given to the completion through CallTiming::last
+    CallTiming timing;
+  };
+
+  /// Run a single attempt of a call, return false if it was refused by the circuit breaker and the fallback was used
+  ///
+  /// The attempt is sent to the given endpoint if any, else to the one chosen by the endpoint pool.
+  bool executeAttempt(const char* methodName, CallKind kind, const std::function<::grpc::Status(::grpc::ClientContext*, size_t endpoint)>& call, InFlightCalls::Registration& registration, std::optional<size_t> endpoint, size_t& usedEndpoint, ::grpc::Status& status);
+
+  /// Whether a call which failed with the given status on the given attempt must be retried, writes without
+  /// idempotency key only if configured so
+  bool shouldRetry(const ::grpc::Status& status, uint32_t attempt, RetryEndpoint retryEndpoint, CallKind kind) const;
+
+  /// Start a single attempt of an asynchronous call, waiting for its rate limiter delay
+  void attemptAsync(std::shared_ptr<AsyncCallState> state);
+
+  /// Ask the circuit breakers for a call to the given endpoint or to any, run the fallback if it is refused and throw if
+  /// there is none or the call reads
+  GrpcEndpointPool::Admission admit(const char* methodName, CallKind kind, std::optional<size_t> endpoint);
+
+  /// Create the context of a call admitted by the circuit breakers
+  std::unique_ptr<::grpc::ClientContext> createContext(const GrpcEndpointPool::Admission& admission);
+
+  /// Start the span of a call attempt and propagate it through its context, nothing if tracing is disabled
+  std::optional<CallSpan> startSpan(const std::string& parentTraceparent, ::grpc::ClientContext& context);
+
+  /// End the span of a call attempt, if any
+  void endSpan(const std::optional<CallSpan>& span, const char* methodName, const ::grpc::Status& status);
+
+  /// Give up a call admitted while it is being abandoned by the shutdown of the client, by throwing std::runtime_error
+  [[noreturn]] void abandon(const char* methodName, const GrpcEndpointPool::Admission& admission);
+
+  /// Build the timing of a completed attempt from its trailers and report it to the call timing listener, if any
+  CallTiming recordTiming(const char* methodName, const ::grpc::ClientContext& context, std::chrono::steady_clock::duration total);
+
+  /// Update the policies with the status of a call sent to the given endpoint and convert it to the error reported to
+  /// the caller, if any
+  std::exception_ptr complete(size_t endpoint, const ::grpc::Status& status);
+
+  /// Start an asynchronous call once its rate limiter delay is over
+  void startAsync(std::shared_ptr<AsyncCallState> state);
+
+  /// Give its outcome to the caller of an asynchronous call, then unregister it
+  static void completeAsync(AsyncCallState& state, std::exception_ptr error);
+
+  std::string mServiceName;
+  std::function<std::unique_ptr<::grpc::ClientContext>()> mClientContextFactory;
+  std::shared_ptr<AdaptiveRateLimiter> mRateLimiter;
+  std::function<void(const std::string&, const std::string&)> mCircuitBreakerFallback;
+  std::chrono::milliseconds mCircuitBreakerProbeTimeout;
+  RetryOptions mRetryOptions;
+  std::function<void(const std::string&, const std::string&, const CallTiming&)> mOnCallTiming;
+  TrafficClass mTrafficClass;
+  std::shared_ptr<TrafficScheduler> mTrafficScheduler;
+  std::shared_ptr<GrpcEndpointPool> mEndpointPool;
+  std::shared_ptr<Tracer> mTracer;
+  std::shared_ptr<InFlightCalls> mInFlightCalls;
+};
+} // namespace o2::bkp::api::grpc
+
+#endif // CXX_CLIENT_GRPC_GRPCCALLEXECUTOR_H
@@ -0,0 +1,270 @@
+//  Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+//  See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+//  All rights not expressly granted are reserved.
+//
+//  This software is distributed under the terms of the GNU General Public
+//  License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+//  In applying this license CERN does not waive the privileges and immunities
+//  granted to it by virtue of its status as an Intergovernmental Organization
+//  or submit itself to any jurisdiction.
+
+
+#include "GrpcEndpointPool.h"
+
+#include <algorithm>
+
+#include <grpcpp/create_channel.h>
+#include <grpcpp/security/credentials.h>
+#include <grpcpp/support/channel_arguments.h>
+
+namespace o2::bkp::api::grpc
+{
+namespace
+{
+/// Let gRPC balance over all the addresses a single URI resolves to (for example a DNS name with several records)
+constexpr char ROUND_ROBIN_SERVICE_CONFIG[] = R"({"loadBalancingConfig": [{"round_robin": {}}]})";
+
+bool isUnreachableSignal(::grpc::StatusCode code)
+{
+  return code == ::grpc::StatusCode::UNAVAILABLE || code == ::grpc::StatusCode::DEADLINE_EXCEEDED;
+}
+} // namespace
+
+GrpcEndpointPool::GrpcEndpointPool(
+  const std::vector<std::string>& uris,
+  const PriorityLanesOptions& priorityLanesOptions,
+  const LoadBalancingOptions& options,
+  const CircuitBreakerOptions& circuitBreakerOptions,
+  std::shared_ptr<TrafficCapture> capture)
+  : mOptions(options)
+{
+  ::grpc::ChannelArguments channelArguments;
+  channelArguments.SetServiceConfigJSON(ROUND_ROBIN_SERVICE_CONFIG);
+  // Bound gRPC's reconnection backoff (2 minutes by default) so that a returning endpoint is seen by the probes soon
+  // after its ejection period
+  auto maxReconnectBackoff = static_cast<int>(options.ejectionDuration.count());
+  channelArguments.SetInt(GRPC_ARG_INITIAL_RECONNECT_BACKOFF_MS, std::min(maxReconnectBackoff, 1000));
+  channelArguments.SetInt(GRPC_ARG_MAX_RECONNECT_BACKOFF_MS, maxReconnectBackoff);
+  if (priorityLanesOptions.enabled) {
+    // Each lane gets its own connection: HTTP/2 streams of a shared connection would compete for its flow control window
+    channelArguments.SetInt(GRPC_ARG_USE_LOCAL_SUBCHANNEL_POOL, 1);
+  }
+
+  auto createChannel = [&](const std::string& uri) {
+    if (!capture) {
+      return ::grpc::CreateCustomChannel(uri, ::grpc::InsecureChannelCredentials(), channelArguments);
+    }
+    std::vector<std::unique_ptr<::grpc::experimental::ClientInterceptorFactoryInterface>> interceptorFactories;
+    interceptorFactories.push_back(createCaptureInterceptorFactory(capture));
+    return ::grpc::experimental::CreateCustomChannelWithInterceptors(
+      uri, ::grpc::InsecureChannelCredentials(), channelArguments, std::move(interceptorFactories));
+  };
+
+  for (const auto& uri : uris) {
+    Endpoint endpoint;
+    endpoint.uri = uri;
+    endpoint.criticalChannel = createChannel(uri);
+    endpoint.bulkChannel = priorityLanesOptions.enabled ? createChannel(uri) : endpoint.criticalChannel;
+    if (circuitBreakerOptions.enabled) {
+      endpoint.circuitBreaker = std::make_unique<CircuitBreaker>(circuitBreakerOptions);
+    }
+    mEndpoints.push_back(std::move(endpoint));
+  }
+
+  // With a single endpoint there is nothing to eject it in favor of
+  if (mEndpoints.size() > 1) {
+    mProbeThread = std::thread([this]() { probeEjectedEndpoints(); });
+  }
+}
+
+GrpcEndpointPool::~GrpcEndpointPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mStopping = true;
+  }
+  mStopRequested.notify_all();
+  if (mProbeThread.joinable()) {
+    mProbeThread.join();
+  }
+}
+
+std::vector<std::shared_ptr<::grpc::ChannelInterface>> GrpcEndpointPool::channels(TrafficClass trafficClass) const
+{
+  std::vector<std::shared_ptr<::grpc::ChannelInterface>> channels;
+  for (const auto& endpoint : mEndpoints) {
+    channels.push_back(trafficClass == TrafficClass::CRITICAL ? endpoint.criticalChannel : endpoint.bulkChannel);
+  }
+  return channels;
+}
+
+void GrpcEndpointPool::connect()
+{
+  for (const auto& endpoint : mEndpoints) {
+    endpoint.criticalChannel->GetState(true);
+    if (endpoint.bulkChannel != endpoint.criticalChannel) {
+      endpoint.bulkChannel->GetState(true);
+    }
+  }
+}
+
+bool GrpcEndpointPool::waitUntilConnected(std::chrono::system_clock::time_point deadline)
+{
+  // Start all of them first so that the connections are established in parallel
+  connect();
+  auto connected = true;
+  for (const auto& endpoint : mEndpoints) {
+    connected = endpoint.criticalChannel->WaitForConnected(deadline) && connected;
+    if (endpoint.bulkChannel != endpoint.criticalChannel) {
+      connected = endpoint.bulkChannel->WaitForConnected(deadline) && connected;
+    }
+  }
+  return connected;
+}
+
+GrpcEndpointPool::Admission GrpcEndpointPool::admit(std::optional<size_t> endpoint)
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  if (!mEndpoints.front().circuitBreaker) {
+    return { CircuitBreaker::Admission::ALLOWED, endpoint };
+  }
+  if (endpoint) {
+    return { mEndpoints[*endpoint].circuitBreaker->admit(), endpoint };
+  }
+
+  // A refusal leaves a breaker unchanged, only the one admitting the call counts it
+  for (auto candidate : preferenceOrder()) {
+    auto decision = mEndpoints[candidate].circuitBreaker->admit();
+    if (decision != CircuitBreaker::Admission::REFUSED) {
+      mNextEndpoint = (candidate + 1) % mEndpoints.size();
+      return { decision, candidate };
+    }
+  }
+  return { CircuitBreaker::Admission::REFUSED, std::nullopt };
+}
+
+void GrpcEndpointPool::onCancellation(const Admission& admission)
+{
+  if (admission.endpoint && mEndpoints[*admission.endpoint].circuitBreaker) {
+    mEndpoints[*admission.endpoint].circuitBreaker->onCancellation();
+  }
+}
+
+void GrpcEndpointPool::onCompletion(size_t endpoint, const ::grpc::Status& status)
+{
+  if (mEndpoints[endpoint].circuitBreaker) {
+    mEndpoints[endpoint].circuitBreaker->onCompletion(status);
+  }
+}
+
+CircuitBreakerState GrpcEndpointPool::circuitBreakerState() const
+{
+  auto state = CircuitBreakerState::OPEN;
+  for (const auto& endpoint : mEndpoints) {
+    auto endpointState = endpoint.circuitBreaker ? endpoint.circuitBreaker->state() : CircuitBreakerState::CLOSED;
+    if (endpointState == CircuitBreakerState::CLOSED) {
+      return CircuitBreakerState::CLOSED;
+    }
+    if (endpointState == CircuitBreakerState::HALF_OPEN) {
+      state = CircuitBreakerState::HALF_OPEN;
+    }
+  }
+  return state;
+}
+
+size_t GrpcEndpointPool::acquire()
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  auto chosen = preferenceOrder().front();
+  mNextEndpoint = (chosen + 1) % mEndpoints.size();
+  mEndpoints[chosen].outstandingCalls++;
+  mEndpoints[chosen].calls++;
+  return chosen;
+}
+
+size_t GrpcEndpointPool::acquire(size_t endpoint)
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  mEndpoints[endpoint].outstandingCalls++;
+  mEndpoints[endpoint].calls++;
+  return endpoint;
+}
+
+void GrpcEndpointPool::release(size_t endpointIndex, const ::grpc::Status& status, Clock::duration duration)
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  auto& endpoint = mEndpoints[endpointIndex];
+  endpoint.outstandingCalls--;
+
+  auto slow = mOptions.slowCallThreshold.count() > 0 && duration > mOptions.slowCallThreshold;
+  if (!isUnreachableSignal(status.error_code()) && !slow) {
+    endpoint.consecutiveFailures = 0;
+    return;
+  }
+
+  endpoint.failedCalls++;
+  endpoint.consecutiveFailures++;
+  if (mEndpoints.size() > 1 && !endpoint.ejected && endpoint.consecutiveFailures >= mOptions.ejectionFailureThreshold) {
+    endpoint.ejected = true;
+    endpoint.ejectedUntil = Clock::now() + mOptions.ejectionDuration;
+    endpoint.consecutiveFailures = 0;
+    endpoint.ejections++;
+  }
+}
+
+std::vector<EndpointState> GrpcEndpointPool::states() const
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  std::vector<EndpointState> states;
+  for (const auto& endpoint : mEndpoints) {
+    states.push_back({ endpoint.uri, endpoint.outstandingCalls, endpoint.ejected, endpoint.calls, endpoint.failedCalls, endpoint.ejections });
+  }
+  return states;
+}
+
+std::vector<size_t> GrpcEndpointPool::preferenceOrder() const
+{
+  // Starting after the previous choice, so that the stable sort rotates over the endpoints on ties
+  auto endpointCount = mEndpoints.size();
+  std::vector<size_t> order;
+  for (size_t offset = 0; offset < endpointCount; offset++) {
+    order.push_back((mNextEndpoint + offset) % endpointCount);
+  }
+  // When all of them are ejected, keep trying the one closest to its reinstatement rather than failing every call
+  std::stable_sort(order.begin(), order.end(), [this](size_t left, size_t right) {
+    const auto& leftEndpoint = mEndpoints[left];
+    const auto& rightEndpoint = mEndpoints[right];
+    if (leftEndpoint.ejected != rightEndpoint.ejected) {
+      return !leftEndpoint.ejected;
+    }
+    if (leftEndpoint.ejected) {
+      return leftEndpoint.ejectedUntil < rightEndpoint.ejectedUntil;
+    }
+    return leftEndpoint.outstandingCalls < rightEndpoint.outstandingCalls;
+  });
+  return order;
+}
+
+void GrpcEndpointPool::probeEjectedEndpoints()
+{
+  std::unique_lock<std::mutex> lock(mMutex);
+  while (!mStopRequested.wait_for(lock, mOptions.probeInterval, [this]() { return mStopping; })) {
+    auto now = Clock::now();
+    for (auto& endpoint : mEndpoints) {
+      if (!endpoint.ejected || endpoint.ejectedUntil > now) {
+        continue;
+      }
+      // Asking for the state also makes an idle or disconnected channel try to connect, ready for the next probe
+      auto ready = endpoint.criticalChannel->GetState(true) == GRPC_CHANNEL_READY;
+      if (endpoint.bulkChannel != endpoint.criticalChannel) {
+        ready = endpoint.bulkChannel->GetState(true) == GRPC_CHANNEL_READY && ready;
+      }
+      if (ready) {
+        endpoint.ejected = false;
+        endpoint.consecutiveFailures = 0;
+      }
+    }
+  }
+}
+} // namespace o2::bkp::api::grpc
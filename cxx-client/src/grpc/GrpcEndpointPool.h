@@ -0,0 +1,139 @@
+//  Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+//  See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+//  All rights not expressly granted are reserved.
+//
+//  This software is distributed under the terms of the GNU General Public
+//  License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+//  In applying this license CERN does not waive the privileges and immunities
+//  granted to it by virtue of its status as an Intergovernmental Organization
+//  or submit itself to any jurisdiction.
+
+
+#ifndef CXX_CLIENT_GRPC_GRPCENDPOINTPOOL_H
+#define CXX_CLIENT_GRPC_GRPCENDPOINTPOOL_H
+
+#include "BookkeepingApi/BkpClientOptions.h"
+#include "BookkeepingApi/EndpointState.h"
+#include "grpc/CircuitBreaker.h"
+#include "grpc/TrafficCapture.h"
+#include "grpc/TrafficScheduler.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+#include <grpcpp/channel.h>
+#include <grpcpp/support/status.h>
+
+namespace o2::bkp::api::grpc
+{
+/**
+ * Bookkeeping endpoints a client balances its calls over
+ *
+ * Each call goes to the endpoint with the least outstanding calls, in turn when several are equal. An endpoint whose
+ * consecutive calls fail because it is unreachable or answers slower than the configured threshold is ejected: it gets
+ * no call until its ejection period is over and a probe of its connection succeeded.
+ *
+ * When enabled, each endpoint also has its own circuit breaker: a call is only refused once the breakers of all the
+ * endpoints it may be sent to are open.
+ */
+class GrpcEndpointPool
+{
+ public:
+  /// Create the channels of the given endpoints, capturing their unary calls to the given capture if any
+  GrpcEndpointPool(
+    const std::vector<std::string>& uris,
+    const PriorityLanesOptions& priorityLanesOptions,
+    const LoadBalancingOptions& options,
+    const CircuitBreakerOptions& circuitBreakerOptions,
+    std::shared_ptr<TrafficCapture> capture = nullptr);
+  ~GrpcEndpointPool();
+
+  GrpcEndpointPool(const GrpcEndpointPool&) = delete;
+  GrpcEndpointPool& operator=(const GrpcEndpointPool&) = delete;
+
+  /// Channels used by the given traffic class, indexed by endpoint
+  std::vector<std::shared_ptr<::grpc::ChannelInterface>> channels(TrafficClass trafficClass) const;
+
+  /// Start establishing the connections of all the channels without waiting for them
+  void connect();
+
+  /// Wait until the connections of all the channels are established or the deadline passed, starting them if needed
+  ///
+  /// @return true if all the channels are ready
+  bool waitUntilConnected(std::chrono::system_clock::time_point deadline);
+
+  /// Decision of the circuit breakers for a new call
+  struct Admission {
+    CircuitBreaker::Admission decision;
+    /// Endpoint the call must be sent to, none if any endpoint can be acquired
+    std::optional<size_t> endpoint;
+  };
+
+  /// Ask the circuit breaker of the given endpoint for a call, or the breakers of all the endpoints in their order of
+  /// preference if none is given, the call being refused only if they are all open
+  Admission admit(std::optional<size_t> endpoint);
+
+  /// Notify that a call admitted by admit will not be sent after all
+  void onCancellation(const Admission& admission);
+
+  /// Update the circuit breaker of the given endpoint with the status of a call it admitted
+  void onCompletion(size_t endpoint, const ::grpc::Status& status);
+
+  /// Open only if the circuit breakers of all the endpoints are open, closed if any of them is
+  CircuitBreakerState circuitBreakerState() const;
+
+  /// Choose the endpoint of a new call and count it as outstanding
+  size_t acquire();
+
+  /// Count a call sent to the given endpoint as outstanding, even if it is ejected
+  size_t acquire(size_t endpoint);
+
+  /// Release an endpoint chosen by acquire, accounting for the status and the duration of the call
+  void release(size_t endpoint, const ::grpc::Status& status, std::chrono::steady_clock::duration duration);
+
+  std::vector<EndpointState> states() const;
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Endpoint {
+    std::string uri;
+    std::shared_ptr<::grpc::Channel> criticalChannel;
+    std::shared_ptr<::grpc::Channel> bulkChannel;
+    uint32_t outstandingCalls = 0;
+    uint32_t consecutiveFailures = 0;
+    bool ejected = false;
+    Clock::time_point ejectedUntil;
+    uint64_t calls = 0;
+    uint64_t failedCalls = 0;
+    uint64_t ejections = 0;
+    /// Null if the circuit breakers are disabled
+    std::unique_ptr<CircuitBreaker> circuitBreaker;
+  };
+
+  /// Endpoints in service by least outstanding calls, rotating on ties, then the ejected ones by closest reinstatement
+  std::vector<size_t> preferenceOrder() const;
+
+  /// Periodically probe the connection of the ejected endpoints to reinstate the healthy ones
+  void probeEjectedEndpoints();
+
+  LoadBalancingOptions mOptions;
+
+  mutable std::mutex mMutex;
+  std::vector<Endpoint> mEndpoints;
+  size_t mNextEndpoint = 0;
+
+  bool mStopping = false;
+  std::condition_variable mStopRequested;
+  std::thread mProbeThread;
+};
+} // namespace o2::bkp::api::grpc
+
+#endif // CXX_CLIENT_GRPC_GRPCENDPOINTPOOL_H
@@ -0,0 +1,156 @@
+//  Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+//  See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+//  All rights not expressly granted are reserved.
+//
+//  This software is distributed under the terms of the GNU General Public
+//  License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+//  In applying this license CERN does not waive the privileges and immunities
+//  granted to it by virtue of its status as an Intergovernmental Organization
+//  or submit itself to any jurisdiction.
+
+
+#ifndef CXX_CLIENT_GRPC_GRPCSUBSCRIPTION_H
+#define CXX_CLIENT_GRPC_GRPCSUBSCRIPTION_H
+
+#include "BookkeepingApi/Subscription.h"
+#include "grpc/GrpcCallExecutor.h"
+#include "grpc/LeftRightValue.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <grpcpp/support/sync_stream.h>
+
+namespace o2::bkp::api::grpc
+{
+/// Subscription fed by a gRPC server stream, read by a dedicated thread
+template <typename T, typename Message>
+class GrpcSubscription : public Subscription<T>
+{
+ public:
+  /// Open the stream with the given context, on the stub of the given endpoint
+  using OpenStream = std::function<std::unique_ptr<::grpc::ClientReader<Message>>(::grpc::ClientContext* context, size_t endpoint)>;
+
+  GrpcSubscription(GrpcCallExecutor* callExecutor, const char* methodName, OpenStream openStream, std::function<T(const Message&)> convert, OnChange<T> onChange)
+    : mCallExecutor(callExecutor),
+      mMethodName(methodName),
+      mOpenStream(std::move(openStream)),
+      mConvert(std::move(convert)),
+      mOnChange(std::move(onChange))
+  {
+    mThread = std::thread([this]() { receive(); });
+  }
+
+  ~GrpcSubscription() override
+  {
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mStopping = true;
+      if (mContext != nullptr) {
+        mContext->TryCancel();
+      }
+    }
+    mStopRequested.notify_all();
+    mThread.join();
+  }
+
+  std::optional<T> latest() const override { return mLatest.read(); }
+
+  uint64_t version() const override { return mVersion.load(); }
+
+  bool connected() const override { return mConnected.load(); }
+
+ private:
+  static constexpr std::chrono::milliseconds INITIAL_BACKOFF{ 100 };
+  static constexpr std::chrono::milliseconds MAX_BACKOFF{ 5000 };
+
+  /// Keep the stream open until the subscription is destroyed
+  void receive()
+  {
+    auto backoff = INITIAL_BACKOFF;
+    while (true) {
+      if (receiveUntilInterrupted()) {
+        backoff = INITIAL_BACKOFF;
+      }
+
+      std::unique_lock<std::mutex> lock(mMutex);
+      if (mStopRequested.wait_for(lock, backoff, [this]() { return mStopping; })) {
+        return;
+      }
+      backoff = std::min(backoff * 2, MAX_BACKOFF);
+    }
+  }
+
+  /// Open the stream and read it until it ends, return whether at least one message has been received
+  bool receiveUntilInterrupted()
+  {
+    std::optional<GrpcCallExecutor::StreamingCall> call;
+    try {
+      call = mCallExecutor->startStreaming(mMethodName, OnShutdown::CANCEL, CallKind::READ);
+    } catch (const std::runtime_error&) {
+      // Refused by the circuit breaker or the rate limiter, try again later
+      return false;
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      if (mStopping) {
+        call->context->TryCancel();
+      }
+      mContext = call->context.get();
+    }
+
+    auto reader = mOpenStream(call->context.get(), call->endpoint);
+    auto received = false;
+    Message message;
+    while (reader->Read(&message)) {
+      received = true;
+      mConnected.store(true);
+      auto value = mConvert(message);
+      mLatest.write(value);
+      mVersion.fetch_add(1);
+      if (mOnChange) {
+        mOnChange(value);
+      }
+    }
+    mConnected.store(false);
+
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mContext = nullptr;
+    }
+    try {
+      mCallExecutor->finishStreaming(*call, reader->Finish());
+    } catch (const std::runtime_error&) {
+      // Interrupted, opened again after the backoff
+    }
+    return received;
+  }
+
+  GrpcCallExecutor* mCallExecutor;
+  const char* mMethodName;
+  OpenStream mOpenStream;
+  std::function<T(const Message&)> mConvert;
+  OnChange<T> mOnChange;
+
+  LeftRightValue<std::optional<T>> mLatest;
+  std::atomic<uint64_t> mVersion{ 0 };
+  std::atomic<bool> mConnected{ false };
+
+  std::mutex mMutex;
+  std::condition_variable mStopRequested;
+  bool mStopping = false;
+  /// Context of the stream currently open, to cancel it when stopping
+  ::grpc::ClientContext* mContext = nullptr;
+  std::thread mThread;
+};
+} // namespace o2::bkp::api::grpc
+
+#endif // CXX_CLIENT_GRPC_GRPCSUBSCRIPTION_H
@@ -0,0 +1,43 @@
+//  Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+//  See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+//  All rights not expressly granted are reserved.
+//
+//  This software is distributed under the terms of the GNU General Public
+//  License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+//  In applying this license CERN does not waive the privileges and immunities
+//  granted to it by virtue of its status as an Intergovernmental Organization
+//  or submit itself to any jurisdiction.
+
+
+#include "IdempotencyKey.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <random>
+
+namespace o2::bkp::api::grpc
+{
+std::string createIdempotencyKey()
+{
+  thread_local std::mt19937_64 generator{ (static_cast<uint64_t>(std::random_device{}()) << 32) ^ std::random_device{}() };
+  auto high = generator();
+  auto low = generator();
+
+  // Version 4 and RFC 4122 variant bits
+  high = (high & 0xFFFFFFFFFFFF0FFFULL) | 0x0000000000004000ULL;
+  low = (low & 0x3FFFFFFFFFFFFFFFULL) | 0x8000000000000000ULL;
+
+  char key[37];
+  std::snprintf(
+    key,
+    sizeof(key),
+    "%08x-%04x-%04x-%04x-%012llx",
+    static_cast<uint32_t>(high >> 32),
+    static_cast<uint32_t>((high >> 16) & 0xFFFF),
+    static_cast<uint32_t>(high & 0xFFFF),
+    static_cast<uint32_t>(low >> 48),
+    static_cast<unsigned long long>(low & 0xFFFFFFFFFFFFULL));
+  return key;
+}
+} // namespace o2::bkp::api::grpc
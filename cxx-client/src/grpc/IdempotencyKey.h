@@ -0,0 +1,25 @@
+//  Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+//  See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+//  All rights not expressly granted are reserved.
+//
+//  This software is distributed under the terms of the GNU General Public
+//  License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+//  In applying this license CERN does not waive the privileges and immunities
+//  granted to it by virtue of its status as an Intergovernmental Organization
+//  or submit itself to any jurisdiction.
+
+
+#ifndef CXX_CLIENT_GRPC_IDEMPOTENCYKEY_H
+#define CXX_CLIENT_GRPC_IDEMPOTENCYKEY_H
+
+#include <string>
+
+namespace o2::bkp::api::grpc
+{
+/// Create a random (version 4) UUID identifying a creation request, sent again as is by its retries so that the server
+/// only applies it once
+std::string createIdempotencyKey();
+} // namespace o2::bkp::api::grpc
+
+#endif // CXX_CLIENT_GRPC_IDEMPOTENCYKEY_H
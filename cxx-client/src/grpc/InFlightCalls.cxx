@@ -0,0 +1,165 @@
+//  Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+//  See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+//  All rights not expressly granted are reserved.
+//
+//  This software is distributed under the terms of the GNU General Public
+//  License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+//  In applying this license CERN does not waive the privileges and immunities
+//  granted to it by virtue of its status as an Intergovernmental Organization
+//  or submit itself to any jurisdiction.
+
+#include "InFlightCalls.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+namespace o2::bkp::api::grpc
+{
+namespace
+{
+/// Calls whose completion is being run by the current thread, innermost last
+thread_local std::vector<std::pair<const InFlightCalls*, uint64_t>> continuations;
+} // namespace
+
+InFlightCalls::Registration::Registration(Registration&& other) noexcept : mCalls(std::move(other.mCalls)), mId(other.mId)
+{
+  other.mCalls = nullptr;
+}
+
+InFlightCalls::Registration& InFlightCalls::Registration::operator=(Registration&& other) noexcept
+{
+  if (this != &other) {
+    if (mCalls != nullptr) {
+      mCalls->leave(mId);
+    }
+    mCalls = std::move(other.mCalls);
+    mId = other.mId;
+    other.mCalls = nullptr;
+  }
+  return *this;
+}
+
+InFlightCalls::Registration::~Registration()
+{
+  if (mCalls != nullptr) {
+    mCalls->leave(mId);
+  }
+}
+
+bool InFlightCalls::Registration::attach(::grpc::ClientContext* context)
+{
+  return mCalls->attach(mId, context);
+}
+
+InFlightCalls::Continuation::Continuation(const Registration& registration)
+{
+  continuations.emplace_back(registration.mCalls.get(), registration.mId);
+}
+
+InFlightCalls::Continuation::~Continuation()
+{
+  continuations.pop_back();
+}
+
+InFlightCalls::Registration InFlightCalls::enter(const std::string& serviceName, const char* methodName, OnShutdown onShutdown)
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  if (mAbandoned || (mClosed && (completingCalls().empty() || onShutdown == OnShutdown::CANCEL))) {
+    throw std::runtime_error("Bookkeeping client is shut down, " + serviceName + "/" + methodName + " call refused");
+  }
+
+  auto id = mNextId++;
+  mCalls.emplace(id, Call{ serviceName + "/" + methodName, onShutdown });
+  if (onShutdown == OnShutdown::DRAIN) {
+    mCallsToDrain++;
+  }
+  return Registration(shared_from_this(), id);
+}
+
+bool InFlightCalls::attach(uint64_t id, ::grpc::ClientContext* context)
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  auto& call = mCalls.at(id);
+  if (call.abandoned) {
+    return false;
+  }
+  call.context = context;
+  return true;
+}
+
+void InFlightCalls::leave(uint64_t id)
+{
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto call = mCalls.find(id);
+    if (call->second.onShutdown == OnShutdown::DRAIN) {
+      mCallsToDrain--;
+    }
+    mCalls.erase(call);
+  }
+  mCallLeft.notify_all();
+}
+
+void InFlightCalls::close()
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  mClosed = true;
+  for (auto& [id, call] : mCalls) {
+    if (call.onShutdown == OnShutdown::CANCEL && !call.abandoned) {
+      call.abandoned = true;
+      if (call.context != nullptr) {
+        call.context->TryCancel();
+      }
+    }
+  }
+}
+
+std::vector<uint64_t> InFlightCalls::completingCalls() const
+{
+  std::vector<uint64_t> ids;
+  for (const auto& [calls, id] : continuations) {
+    if (calls == this) {
+      ids.push_back(id);
+    }
+  }
+  return ids;
+}
+
+bool InFlightCalls::completing() const
+{
+  return !completingCalls().empty();
+}
+
+std::map<std::string, uint32_t> InFlightCalls::drain(std::chrono::system_clock::time_point deadline)
+{
+  // The calls being completed by this thread only leave once the shutdown returns
+  auto ownCalls = completingCalls();
+  std::unique_lock<std::mutex> lock(mMutex);
+  std::map<std::string, uint32_t> abandonedCalls;
+  if (mCallLeft.wait_until(lock, deadline, [this, &ownCalls]() { return mCallsToDrain == ownCalls.size(); })) {
+    return abandonedCalls;
+  }
+
+  mAbandoned = true;
+  for (auto& [id, call] : mCalls) {
+    if (call.onShutdown == OnShutdown::DRAIN && !call.abandoned
+        && std::find(ownCalls.begin(), ownCalls.end(), id) == ownCalls.end()) {
+      call.abandoned = true;
+      abandonedCalls[call.name]++;
+      if (call.context != nullptr) {
+        call.context->TryCancel();
+      }
+    }
+  }
+  return abandonedCalls;
+}
+
+void InFlightCalls::waitUntilDrained()
+{
+  auto ownCalls = completingCalls().size();
+  std::unique_lock<std::mutex> lock(mMutex);
+  mCallLeft.wait(lock, [this, ownCalls]() { return mCallsToDrain == ownCalls; });
+}
+} // namespace o2::bkp::api::grpc
@@ -0,0 +1,132 @@
+//  Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+//  See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+//  All rights not expressly granted are reserved.
+//
+//  This software is distributed under the terms of the GNU General Public
+//  License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+//  In applying this license CERN does not waive the privileges and immunities
+//  granted to it by virtue of its status as an Intergovernmental Organization
+//  or submit itself to any jurisdiction.
+
+#ifndef CXX_CLIENT_GRPC_INFLIGHTCALLS_H
+#define CXX_CLIENT_GRPC_INFLIGHTCALLS_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <grpcpp/client_context.h>
+
+namespace o2::bkp::api::grpc
+{
+/// How a shutdown of the client treats a call still in flight
+enum class OnShutdown {
+  /// Waited for until the deadline, then cancelled
+  DRAIN,
+  /// Cancelled right away, as it only reads from bookkeeping for as long as the caller keeps it open
+  CANCEL,
+};
+
+/**
+ * Calls of a client from their start to their completion, retries included, so that a shutdown can wait for them
+ *
+ * Once closed, new calls are refused except the ones started by the completion of a call in flight (such as the status
+ * of an environment reported while the previous one was being sent), which are part of the work being drained.
+ */
+class InFlightCalls : public std::enable_shared_from_this<InFlightCalls>
+{
+ public:
+  class Continuation;
+
+  /// Registration of a call, unregistering it when destroyed
+  ///
+  /// The registration keeps the calls alive, as a completion may destroy the client the calls belong to.
+  class Registration
+  {
+   public:
+    Registration(std::shared_ptr<InFlightCalls> calls, uint64_t id) : mCalls(std::move(calls)), mId(id) {}
+    Registration(Registration&& other) noexcept;
+    Registration& operator=(Registration&& other) noexcept;
+    ~Registration();
+
+    /// Set the context of the current attempt, to be cancelled if the call is abandoned, nullptr once it completed
+    ///
+    /// @return false if the call has already been abandoned and must not be attempted
+    bool attach(::grpc::ClientContext* context);
+
+   private:
+    friend class Continuation;
+
+    std::shared_ptr<InFlightCalls> mCalls;
+    uint64_t mId;
+  };
+
+  /// Completion of a call being run on the current thread, during which the calls it starts are accepted once closed
+  ///
+  /// A shutdown run by the completion itself, such as the destructor of the client when its last handle is dropped by
+  /// a callback, does not wait for the call being completed.
+  class Continuation
+  {
+   public:
+    explicit Continuation(const Registration& registration);
+    ~Continuation();
+    Continuation(const Continuation&) = delete;
+    Continuation& operator=(const Continuation&) = delete;
+  };
+
+  /// Register a call, throw std::runtime_error if it is refused because the client is shut down
+  Registration enter(const std::string& serviceName, const char* methodName, OnShutdown onShutdown);
+
+  /// Whether the current thread is running the completion of one of the calls
+  bool completing() const;
+
+  /// Refuse the new calls and cancel the ones to cancel right away
+  void close();
+
+  /**
+   * Wait for the calls to drain to complete, at most until the deadline
+   *
+   * The calls still in flight at the deadline are cancelled and from then on all calls are refused, continuations
+   * included. The calls being completed by the current thread are not waited for. Must be called once closed.
+   *
+   * @return the number of calls cancelled at the deadline, per "service/method"
+   */
+  std::map<std::string, uint32_t> drain(std::chrono::system_clock::time_point deadline);
+
+  /// Wait for the completion of the calls to drain, which are only promptly completing once cancelled by drain
+  ///
+  /// The calls being completed by the current thread are not waited for.
+  void waitUntilDrained();
+
+ private:
+  struct Call {
+    std::string name;
+    OnShutdown onShutdown;
+    ::grpc::ClientContext* context = nullptr;
+    bool abandoned = false;
+  };
+
+  bool attach(uint64_t id, ::grpc::ClientContext* context);
+
+  void leave(uint64_t id);
+
+  /// Return the ids of the calls being completed by the current thread
+  std::vector<uint64_t> completingCalls() const;
+
+  std::mutex mMutex;
+  std::condition_variable mCallLeft;
+  std::map<uint64_t, Call> mCalls;
+  uint64_t mNextId = 0;
+  /// Number of calls in mCalls to drain
+  size_t mCallsToDrain = 0;
+  bool mClosed = false;
+  bool mAbandoned = false;
+};
+} // namespace o2::bkp::api::grpc
+
+#endif // CXX_CLIENT_GRPC_INFLIGHTCALLS_H
@@ -0,0 +1,73 @@
+//  Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+//  See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+//  All rights not expressly granted are reserved.
+//
+//  This software is distributed under the terms of the GNU General Public
+//  License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+//  In applying this license CERN does not waive the privileges and immunities
+//  granted to it by virtue of its status as an Intergovernmental Organization
+//  or submit itself to any jurisdiction.
+
+
+#ifndef CXX_CLIENT_GRPC_LEFTRIGHTVALUE_H
+#define CXX_CLIENT_GRPC_LEFTRIGHTVALUE_H
+
+#include <atomic>
+#include <thread>
+
+namespace o2::bkp::api::grpc
+{
+/**
+ * Value written by a single thread and read by any number of threads without ever waiting (left-right algorithm)
+ *
+ * Two copies of the value are kept: readers always read the one not being written, announcing themselves on one of
+ * two read indicators. The writer updates the other copy, switches the readers to it, then waits for the readers still
+ * on the previous copy to leave before updating it too.
+ */
+template <typename T>
+class LeftRightValue
+{
+ public:
+  /// Copy the current value, never waits
+  T read() const
+  {
+    auto versionIndex = mVersionIndex.load();
+    mReaders[versionIndex].fetch_add(1);
+    T value = mInstances[mReadIndex.load()];
+    mReaders[versionIndex].fetch_sub(1);
+    return value;
+  }
+
+  /// Replace the value, must only be called by a single thread at a time
+  void write(const T& value)
+  {
+    auto readIndex = mReadIndex.load();
+    mInstances[1 - readIndex] = value;
+    mReadIndex.store(1 - readIndex);
+
+    // New readers only read the copy just written, wait for the ones that may still be on the previous one
+    auto versionIndex = mVersionIndex.load();
+    waitForReaders(1 - versionIndex);
+    mVersionIndex.store(1 - versionIndex);
+    waitForReaders(versionIndex);
+
+    mInstances[readIndex] = value;
+  }
+
+ private:
+  void waitForReaders(int versionIndex) const
+  {
+    while (mReaders[versionIndex].load() != 0) {
+      std::this_thread::yield();
+    }
+  }
+
+  T mInstances[2];
+  std::atomic<int> mReadIndex{ 0 };
+  std::atomic<int> mVersionIndex{ 0 };
+  mutable std::atomic<uint32_t> mReaders[2]{ { 0 }, { 0 } };
+};
+} // namespace o2::bkp::api::grpc
+
+#endif // CXX_CLIENT_GRPC_LEFTRIGHTVALUE_H
@@ -0,0 +1,109 @@
+//  Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+//  See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+//  All rights not expressly granted are reserved.
+//
+//  This software is distributed under the terms of the GNU General Public
+//  License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+//  In applying this license CERN does not waive the privileges and immunities
+//  granted to it by virtue of its status as an Intergovernmental Organization
+//  or submit itself to any jurisdiction.
+
+#include "ServerTiming.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <string>
+
+namespace o2::bkp::api
+{
+namespace
+{
+thread_local CallTiming lastCallTiming;
+} // namespace
+
+const CallTiming& CallTiming::last()
+{
+  return lastCallTiming;
+}
+
+namespace grpc
+{
+namespace
+{
+std::string_view trim(std::string_view value)
+{
+  auto first = value.find_first_not_of(' ');
+  if (first == std::string_view::npos) {
+    return {};
+  }
+  return value.substr(first, value.find_last_not_of(' ') - first + 1);
+}
+
+/// Parse the duration parameter of a metric such as "handler;dur=12.25", return false if it has none
+bool parseDuration(std::string_view parameters, std::chrono::microseconds& duration)
+{
+  constexpr std::string_view durationParameter = "dur=";
+  auto position = parameters.find(durationParameter);
+  if (position == std::string_view::npos) {
+    return false;
+  }
+  std::string milliseconds(parameters.substr(position + durationParameter.size()));
+  char* end = nullptr;
+  auto value = std::strtod(milliseconds.c_str(), &end);
+  if (end == milliseconds.c_str() || !std::isfinite(value)) {
+    return false;
+  }
+  duration = std::chrono::microseconds(std::llround(value * 1000));
+  return true;
+}
+} // namespace
+
+std::optional<ServerTiming> parseServerTiming(std::string_view value)
+{
+  ServerTiming timing;
+  auto known = false;
+  while (!value.empty()) {
+    auto separator = value.find(',');
+    auto metric = trim(value.substr(0, separator));
+    value = separator == std::string_view::npos ? std::string_view{} : value.substr(separator + 1);
+
+    auto parametersStart = metric.find(';');
+    auto name = trim(metric.substr(0, parametersStart));
+    auto parameters = parametersStart == std::string_view::npos ? std::string_view{} : metric.substr(parametersStart + 1);
+    std::chrono::microseconds* duration = nullptr;
+    if (name == "queue") {
+      duration = &timing.queue;
+    } else if (name == "auth") {
+      duration = &timing.auth;
+    } else if (name == "handler") {
+      duration = &timing.handler;
+    } else if (name == "db") {
+      duration = &timing.db;
+    }
+    if (duration != nullptr && parseDuration(parameters, *duration)) {
+      known = true;
+    }
+  }
+  if (!known) {
+    return std::nullopt;
+  }
+  return timing;
+}
+
+std::optional<ServerTiming> getServerTiming(const ::grpc::ClientContext& context)
+{
+  const auto& trailers = context.GetServerTrailingMetadata();
+  auto trailer = trailers.find(SERVER_TIMING_TRAILER);
+  if (trailer == trailers.end()) {
+    return std::nullopt;
+  }
+  return parseServerTiming(std::string_view(trailer->second.data(), trailer->second.size()));
+}
+
+void setLastCallTiming(const CallTiming& timing)
+{
+  lastCallTiming = timing;
+}
+} // namespace grpc
+} // namespace o2::bkp::api
@@ -0,0 +1,39 @@
+//  Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+//  See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+//  All rights not expressly granted are reserved.
+//
+//  This software is distributed under the terms of the GNU General Public
+//  License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+//  In applying this license CERN does not waive the privileges and immunities
+//  granted to it by virtue of its status as an Intergovernmental Organization
+//  or submit itself to any jurisdiction.
+
+#ifndef CXX_CLIENT_GRPC_SERVERTIMING_H
+#define CXX_CLIENT_GRPC_SERVERTIMING_H
+
+#include "BookkeepingApi/CallTiming.h"
+
+#include <optional>
+#include <string_view>
+#include <grpcpp/client_context.h>
+
+namespace o2::bkp::api::grpc
+{
+/// Trailer in which bookkeeping reports the timing of a call, formatted as the HTTP Server-Timing header
+constexpr const char* SERVER_TIMING_TRAILER = "server-timing";
+
+/// Parse a server timing trailer such as "queue;dur=0.02, auth;dur=1.3, handler;dur=12.25, db;dur=9.8", durations being
+/// in milliseconds, unknown metrics being ignored
+///
+/// @return the parsed timing, none if no known metric has a valid duration
+std::optional<ServerTiming> parseServerTiming(std::string_view value);
+
+/// Return the timing reported in the trailers of a completed call, if any
+std::optional<ServerTiming> getServerTiming(const ::grpc::ClientContext& context);
+
+/// Set the timing returned by CallTiming::last on the current thread
+void setLastCallTiming(const CallTiming& timing);
+} // namespace o2::bkp::api::grpc
+
+#endif // CXX_CLIENT_GRPC_SERVERTIMING_H
@@ -0,0 +1,161 @@
+//  Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+//  See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+//  All rights not expressly granted are reserved.
+//
+//  This software is distributed under the terms of the GNU General Public
+//  License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+//  In applying this license CERN does not waive the privileges and immunities
+//  granted to it by virtue of its status as an Intergovernmental Organization
+//  or submit itself to any jurisdiction.
+
+#include "Tracer.h"
+
+#include <cinttypes>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+
+namespace o2::bkp::api::grpc
+{
+namespace
+{
+std::mt19937_64& randomGenerator()
+{
+  thread_local std::mt19937_64 generator{ (static_cast<uint64_t>(std::random_device{}()) << 32) ^ std::random_device{}() };
+  return generator;
+}
+
+/// Random non-zero identifier, as 16 lowercase hexadecimal characters
+std::string createId()
+{
+  uint64_t value;
+  do {
+    value = randomGenerator()();
+  } while (value == 0);
+
+  char id[17];
+  std::snprintf(id, sizeof(id), "%016" PRIx64, value);
+  return id;
+}
+
+/// Whether the given part of a trace context is made of lowercase hexadecimal characters, not all zeros
+bool isValidId(const std::string& traceparent, size_t offset, size_t length)
+{
+  bool nonZero = false;
+  for (size_t i = offset; i < offset + length; i++) {
+    auto c = traceparent[i];
+    if (!((c >= '0' && c <= '9') || (c >= 'a' && c <= 'f'))) {
+      return false;
+    }
+    nonZero = nonZero || c != '0';
+  }
+  return nonZero;
+}
+
+/// Whether the given trace context is a version 00 traceparent: 00-<32 hex trace id>-<16 hex span id>-<2 hex flags>
+bool isValidTraceparent(const std::string& traceparent)
+{
+  return traceparent.size() == 55 && traceparent.compare(0, 3, "00-") == 0 && traceparent[35] == '-' && traceparent[52] == '-'
+         && isValidId(traceparent, 3, 32) && isValidId(traceparent, 36, 16)
+         && (isValidId(traceparent, 53, 2) || traceparent.compare(53, 2, "00") == 0);
+}
+
+int64_t toMicroseconds(std::chrono::system_clock::duration duration)
+{
+  return std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+}
+} // namespace
+
+Tracer::Tracer(const TracingOptions& options)
+  : mSampleRatio(options.sampleRatio),
+    mMaxBufferedSpans(options.maxBufferedSpans),
+    mFlushInterval(options.flushInterval),
+    mFile(nullptr, &std::fclose)
+{
+  if (options.exportPath.empty()) {
+    return;
+  }
+
+  mFile.reset(std::fopen(options.exportPath.c_str(), "a"));
+  if (!mFile) {
+    throw std::runtime_error("Failed to open the trace export file " + options.exportPath);
+  }
+  mThread = std::thread([this]() { run(); });
+}
+
+Tracer::~Tracer()
+{
+  if (!mThread.joinable()) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mStopping = true;
+  }
+  mStopRequested.notify_one();
+  mThread.join();
+}
+
+CallSpan Tracer::start(const std::string& parentTraceparent) const
+{
+  CallSpan span;
+  if (isValidTraceparent(parentTraceparent)) {
+    span.traceId = parentTraceparent.substr(3, 32);
+    span.parentSpanId = parentTraceparent.substr(36, 16);
+    span.sampled = std::stoi(parentTraceparent.substr(53, 2), nullptr, 16) & 0x01;
+  } else {
+    span.traceId = createId() + createId();
+    span.sampled = std::uniform_real_distribution<double>{ 0, 1 }(randomGenerator()) < mSampleRatio;
+  }
+  span.spanId = createId();
+  span.start = std::chrono::system_clock::now();
+  return span;
+}
+
+void Tracer::inject(const CallSpan& span, ::grpc::ClientContext& context)
+{
+  context.AddMetadata("traceparent", "00-" + span.traceId + "-" + span.spanId + (span.sampled ? "-01" : "-00"));
+}
+
+void Tracer::end(const CallSpan& span, const std::string& serviceName, const char* methodName, const ::grpc::Status& status)
+{
+  if (!span.sampled || !mFile) {
+    return;
+  }
+
+  auto end = std::chrono::system_clock::now();
+  std::string line = "{\"traceId\":\"" + span.traceId + "\",\"spanId\":\"" + span.spanId + "\",\"parentSpanId\":";
+  line += span.parentSpanId.empty() ? "null" : "\"" + span.parentSpanId + "\"";
+  line += ",\"name\":\"" + serviceName + "/" + methodName + "\",\"kind\":\"client\"";
+  line += ",\"startUs\":" + std::to_string(toMicroseconds(span.start.time_since_epoch()));
+  line += ",\"durationUs\":" + std::to_string(toMicroseconds(end - span.start));
+  line += ",\"status\":" + std::to_string(status.error_code()) + "}\n";
+
+  std::lock_guard<std::mutex> lock(mMutex);
+  // Losing spans is better than slowing down or blocking the calls when the disk can not keep up
+  if (mBuffered.size() < mMaxBufferedSpans) {
+    mBuffered.push_back(std::move(line));
+  }
+}
+
+void Tracer::run()
+{
+  std::vector<std::string> lines;
+  bool stopping = false;
+  while (!stopping) {
+    {
+      std::unique_lock<std::mutex> lock(mMutex);
+      mStopRequested.wait_for(lock, mFlushInterval, [this]() { return mStopping; });
+      stopping = mStopping;
+      lines.swap(mBuffered);
+    }
+
+    for (const auto& line : lines) {
+      std::fwrite(line.data(), 1, line.size(), mFile.get());
+    }
+    std::fflush(mFile.get());
+    lines.clear();
+  }
+}
+} // namespace o2::bkp::api::grpc
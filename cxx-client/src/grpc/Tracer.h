@@ -0,0 +1,78 @@
+//  Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+//  See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+//  All rights not expressly granted are reserved.
+//
+//  This software is distributed under the terms of the GNU General Public
+//  License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+//  In applying this license CERN does not waive the privileges and immunities
+//  granted to it by virtue of its status as an Intergovernmental Organization
+//  or submit itself to any jurisdiction.
+
+#ifndef CXX_CLIENT_GRPC_TRACER_H
+#define CXX_CLIENT_GRPC_TRACER_H
+
+#include "BookkeepingApi/BkpClientOptions.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <grpcpp/client_context.h>
+#include <grpcpp/support/status.h>
+
+namespace o2::bkp::api::grpc
+{
+/// Span of a single attempt of a call, from its admission to its completion
+struct CallSpan {
+  std::string traceId;
+  std::string spanId;
+  /// Span of the caller, empty if the call is the root of its trace
+  std::string parentSpanId;
+  bool sampled = false;
+  std::chrono::system_clock::time_point start;
+};
+
+/// Propagate W3C trace contexts to the server and export the spans of the sampled calls as JSON lines
+class Tracer
+{
+ public:
+  /// Open the export file if any, throw std::runtime_error if it can not be opened
+  explicit Tracer(const TracingOptions& options);
+  ~Tracer();
+
+  Tracer(const Tracer&) = delete;
+  Tracer& operator=(const Tracer&) = delete;
+
+  /// Start the span of a call attempt, as a child of the given trace context if it is valid or else of a new trace
+  CallSpan start(const std::string& parentTraceparent) const;
+
+  /// Add the trace context of a span to the metadata of its call
+  static void inject(const CallSpan& span, ::grpc::ClientContext& context);
+
+  /// End the span of a call attempt with its status, queuing it for export if it is sampled
+  void end(const CallSpan& span, const std::string& serviceName, const char* methodName, const ::grpc::Status& status);
+
+ private:
+  /// Write the queued spans every flush interval, and the remaining ones once stopping
+  void run();
+
+  double mSampleRatio;
+  size_t mMaxBufferedSpans;
+  std::chrono::milliseconds mFlushInterval;
+  std::unique_ptr<std::FILE, int (*)(std::FILE*)> mFile;
+
+  std::mutex mMutex;
+  std::vector<std::string> mBuffered;
+  bool mStopping = false;
+  std::condition_variable mStopRequested;
+  std::thread mThread;
+};
+} // namespace o2::bkp::api::grpc
+
+#endif // CXX_CLIENT_GRPC_TRACER_H
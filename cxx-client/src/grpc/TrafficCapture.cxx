@@ -0,0 +1,302 @@
+//  Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+//  See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+//  All rights not expressly granted are reserved.
+//
+//  This software is distributed under the terms of the GNU General Public
+//  License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+//  In applying this license CERN does not waive the privileges and immunities
+//  granted to it by virtue of its status as an Intergovernmental Organization
+//  or submit itself to any jurisdiction.
+
+#include "TrafficCapture.h"
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+
+namespace o2::bkp::api::grpc
+{
+namespace
+{
+constexpr size_t CAPTURE_MAGIC_SIZE = sizeof(CAPTURE_MAGIC) - 1;
+
+void appendLittleEndian(std::string& bytes, uint64_t value, size_t size)
+{
+  for (size_t byteIndex = 0; byteIndex < size; byteIndex++) {
+    bytes.push_back(static_cast<char>((value >> (8 * byteIndex)) & 0xFF));
+  }
+}
+
+uint64_t readLittleEndian(const char* bytes, size_t size)
+{
+  uint64_t value = 0;
+  for (size_t byteIndex = 0; byteIndex < size; byteIndex++) {
+    value |= static_cast<uint64_t>(static_cast<uint8_t>(bytes[byteIndex])) << (8 * byteIndex);
+  }
+  return value;
+}
+
+/// Record the request of a unary call, in the form serialized for sending so that it is only serialized once
+class CaptureInterceptor : public ::grpc::experimental::Interceptor
+{
+ public:
+  CaptureInterceptor(TrafficCapture& capture, const char* method) : mCapture(capture), mMethod(method) {}
+
+  void Intercept(::grpc::experimental::InterceptorBatchMethods* methods) override
+  {
+    if (methods->QueryInterceptionHookPoint(::grpc::experimental::InterceptionHookPoints::PRE_SEND_MESSAGE)) {
+      if (auto* request = methods->GetSerializedSendMessage()) {
+        mCapture.record(mMethod, *request);
+      }
+    }
+    methods->Proceed();
+  }
+
+ private:
+  TrafficCapture& mCapture;
+  const char* mMethod;
+};
+
+class CaptureInterceptorFactory : public ::grpc::experimental::ClientInterceptorFactoryInterface
+{
+ public:
+  explicit CaptureInterceptorFactory(std::shared_ptr<TrafficCapture> capture) : mCapture(std::move(capture)) {}
+
+  ::grpc::experimental::Interceptor* CreateClientInterceptor(::grpc::experimental::ClientRpcInfo* info) override
+  {
+    // Streams are interactive (watches, uploads), they can not be replayed as a sequence of independent requests
+    if (info->type() != ::grpc::experimental::ClientRpcInfo::Type::UNARY) {
+      return nullptr;
+    }
+    return new CaptureInterceptor(*mCapture, info->method());
+  }
+
+ private:
+  std::shared_ptr<TrafficCapture> mCapture;
+};
+
+/// Open the capture file for writing, locked for as long as it is open so that no other client captures to it
+std::FILE* openCaptureFile(const std::string& path)
+{
+  auto fd = open(path.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+  if (fd < 0) {
+    throw std::runtime_error("Failed to create the capture file " + path + ": " + std::strerror(errno));
+  }
+  if (flock(fd, LOCK_EX | LOCK_NB) != 0) {
+    auto error = errno == EWOULDBLOCK ? std::string("another client is capturing to it") : std::strerror(errno);
+    close(fd);
+    throw std::runtime_error("Failed to create the capture file " + path + ": " + error);
+  }
+  // Truncated once locked, not to destroy the capture of another client
+  std::FILE* file = ftruncate(fd, 0) == 0 ? fdopen(fd, "wb") : nullptr;
+  if (file == nullptr) {
+    auto error = std::strerror(errno);
+    close(fd);
+    throw std::runtime_error("Failed to create the capture file " + path + ": " + error);
+  }
+  return file;
+}
+} // namespace
+
+TrafficCapture::TrafficCapture(const CaptureOptions& options)
+  : mFile(openCaptureFile(options.path), &std::fclose),
+    mOnError(options.onError),
+    mMaxBufferedBytes(options.maxBufferedBytes),
+    mFlushInterval(options.flushInterval)
+{
+  if (std::fwrite(CAPTURE_MAGIC, 1, CAPTURE_MAGIC_SIZE, mFile.get()) != CAPTURE_MAGIC_SIZE) {
+    throw std::runtime_error("Failed to create the capture file " + options.path);
+  }
+  mThread = std::thread([this]() { run(); });
+}
+
+TrafficCapture::~TrafficCapture()
+{
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mStopping = true;
+  }
+  mStopRequested.notify_one();
+  mThread.join();
+}
+
+void TrafficCapture::record(const char* method, const ::grpc::ByteBuffer& request)
+{
+  auto sentAtNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+  auto size = request.Length();
+
+  std::lock_guard<std::mutex> lock(mMutex);
+  if (mFailed) {
+    return;
+  }
+  if (mPendingBytes + size > mMaxBufferedBytes) {
+    mDropped++;
+    return;
+  }
+  mPendingBytes += size;
+  // Copying the buffer only references its slices
+  mPending.push_back({ method, sentAtNs, request });
+}
+
+void TrafficCapture::run()
+{
+  std::vector<PendingRequest> requests;
+  bool stopping = false;
+  while (!stopping) {
+    uint64_t dropped;
+    {
+      std::unique_lock<std::mutex> lock(mMutex);
+      mStopRequested.wait_for(lock, mFlushInterval, [this]() { return mStopping; });
+      stopping = mStopping;
+      requests.swap(mPending);
+      mPendingBytes = 0;
+      dropped = mDropped;
+      mDropped = 0;
+    }
+
+    for (auto& request : requests) {
+      writeRequest(request);
+    }
+    if (dropped > 0) {
+      std::string content;
+      appendLittleEndian(content, dropped, 8);
+      writeRecord(CaptureRecordKind::DROPPED, content);
+    }
+    checkWrite(std::fflush(mFile.get()) == 0);
+    requests.clear();
+
+    if (!mWriteError.empty()) {
+      // The file ends with the records written so far, a partial last one being ignored by the reader
+      {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mFailed = true;
+        mPending.clear();
+        mPendingBytes = 0;
+      }
+      if (mOnError) {
+        mOnError(mWriteError);
+      }
+      return;
+    }
+  }
+}
+
+bool TrafficCapture::checkWrite(bool succeeded)
+{
+  if (succeeded) {
+    return true;
+  }
+  if (mWriteError.empty()) {
+    mWriteError = std::string("Failed to write the capture file: ") + std::strerror(errno);
+  }
+  return false;
+}
+
+void TrafficCapture::writeRequest(PendingRequest& request)
+{
+  auto methodId = mMethodIds.find(request.method);
+  if (methodId == mMethodIds.end()) {
+    methodId = mMethodIds.emplace(request.method, static_cast<uint16_t>(mMethodIds.size())).first;
+    std::string content;
+    appendLittleEndian(content, methodId->second, 2);
+    writeRecord(CaptureRecordKind::METHOD, content + request.method);
+  }
+
+  std::vector<::grpc::Slice> message;
+  if (!request.message.Dump(&message).ok()) {
+    return;
+  }
+  std::string content;
+  appendLittleEndian(content, methodId->second, 2);
+  appendLittleEndian(content, static_cast<uint64_t>(request.sentAtNs), 8);
+  writeRecord(CaptureRecordKind::REQUEST, content, message);
+}
+
+void TrafficCapture::writeRecord(CaptureRecordKind kind, const std::string& content, const std::vector<::grpc::Slice>& payload)
+{
+  uint64_t size = 1 + content.size();
+  for (const auto& slice : payload) {
+    size += slice.size();
+  }
+
+  std::string header;
+  appendLittleEndian(header, size, 4);
+  header.push_back(static_cast<char>(kind));
+  header += content;
+  if (!mWriteError.empty() || !checkWrite(std::fwrite(header.data(), 1, header.size(), mFile.get()) == header.size())) {
+    return;
+  }
+  for (const auto& slice : payload) {
+    if (!checkWrite(std::fwrite(slice.begin(), 1, slice.size(), mFile.get()) == slice.size())) {
+      return;
+    }
+  }
+}
+
+std::unique_ptr<::grpc::experimental::ClientInterceptorFactoryInterface> createCaptureInterceptorFactory(std::shared_ptr<TrafficCapture> capture)
+{
+  return std::make_unique<CaptureInterceptorFactory>(std::move(capture));
+}
+
+CaptureReader::CaptureReader(const std::string& path) : mFile(std::fopen(path.c_str(), "rb"), &std::fclose), mPath(path)
+{
+  if (!mFile) {
+    throw std::runtime_error("Failed to open the capture file " + path);
+  }
+  char magic[CAPTURE_MAGIC_SIZE];
+  if (std::fread(magic, 1, CAPTURE_MAGIC_SIZE, mFile.get()) != CAPTURE_MAGIC_SIZE || std::memcmp(magic, CAPTURE_MAGIC, CAPTURE_MAGIC_SIZE) != 0) {
+    throw std::runtime_error(path + " is not a capture file");
+  }
+}
+
+bool CaptureReader::next(CapturedRequest& request)
+{
+  while (true) {
+    char sizeBytes[4];
+    if (std::fread(sizeBytes, 1, sizeof(sizeBytes), mFile.get()) != sizeof(sizeBytes)) {
+      return false;
+    }
+    std::string record(readLittleEndian(sizeBytes, sizeof(sizeBytes)), '\0');
+    if (record.empty()) {
+      throw std::runtime_error("Corrupted capture file " + mPath + ": empty record");
+    }
+    if (std::fread(record.data(), 1, record.size(), mFile.get()) != record.size()) {
+      return false;
+    }
+
+    switch (static_cast<CaptureRecordKind>(record[0])) {
+      case CaptureRecordKind::METHOD:
+        if (record.size() < 3) {
+          throw std::runtime_error("Corrupted capture file " + mPath + ": truncated method record");
+        }
+        mMethods[readLittleEndian(&record[1], 2)] = record.substr(3);
+        break;
+      case CaptureRecordKind::REQUEST: {
+        if (record.size() < 11) {
+          throw std::runtime_error("Corrupted capture file " + mPath + ": truncated request record");
+        }
+        auto method = mMethods.find(readLittleEndian(&record[1], 2));
+        if (method == mMethods.end()) {
+          throw std::runtime_error("Corrupted capture file " + mPath + ": request to an undefined method");
+        }
+        request.method = method->second;
+        request.sentAtNs = static_cast<int64_t>(readLittleEndian(&record[3], 8));
+        request.message = record.substr(11);
+        return true;
+      }
+      case CaptureRecordKind::DROPPED:
+        if (record.size() < 9) {
+          throw std::runtime_error("Corrupted capture file " + mPath + ": truncated dropped requests record");
+        }
+        mDropped += readLittleEndian(&record[1], 8);
+        break;
+      default:
+        throw std::runtime_error("Corrupted capture file " + mPath + ": unknown record kind " + std::to_string(record[0]));
+    }
+  }
+}
+} // namespace o2::bkp::api::grpc
@@ -0,0 +1,143 @@
+//  Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+//  See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+//  All rights not expressly granted are reserved.
+//
+//  This software is distributed under the terms of the GNU General Public
+//  License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+//  In applying this license CERN does not waive the privileges and immunities
+//  granted to it by virtue of its status as an Intergovernmental Organization
+//  or submit itself to any jurisdiction.
+
+#ifndef CXX_CLIENT_GRPC_TRAFFICCAPTURE_H
+#define CXX_CLIENT_GRPC_TRAFFICCAPTURE_H
+
+#include "BookkeepingApi/BkpClientOptions.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <grpcpp/support/byte_buffer.h>
+#include <grpcpp/support/client_interceptor.h>
+
+namespace o2::bkp::api::grpc
+{
+/**
+ * Format of the capture files
+ *
+ * A capture file starts with the 8 bytes CAPTURE_MAGIC, followed by records made of their size (4 bytes, not counting
+ * itself), their kind (1 byte) and their content. Integers are little-endian.
+ *  - METHOD: id of the method (2 bytes) then its full name, for example /o2.bookkeeping.RunService/Update
+ *  - REQUEST: id of its method (2 bytes), send time in nanoseconds since epoch (8 bytes) then the serialized request
+ *  - DROPPED: number of requests dropped since the previous DROPPED record (8 bytes)
+ */
+constexpr char CAPTURE_MAGIC[] = "BKPCAP01";
+
+enum class CaptureRecordKind : uint8_t {
+  METHOD = 1,
+  REQUEST = 2,
+  DROPPED = 3,
+};
+
+/// Append the requests of the unary calls of a client to a capture file, written by a background thread
+class TrafficCapture
+{
+ public:
+  /// Create the capture file, throw std::runtime_error if it can not be or another client is capturing to it
+  explicit TrafficCapture(const CaptureOptions& options);
+  ~TrafficCapture();
+
+  TrafficCapture(const TrafficCapture&) = delete;
+  TrafficCapture& operator=(const TrafficCapture&) = delete;
+
+  /// Queue a request sent now to the given method for writing, or drop it if too many bytes are already queued
+  void record(const char* method, const ::grpc::ByteBuffer& request);
+
+ private:
+  struct PendingRequest {
+    std::string method;
+    int64_t sentAtNs;
+    ::grpc::ByteBuffer message;
+  };
+
+  /// Write the queued requests every flush interval, and the remaining ones once stopping
+  void run();
+
+  void writeRequest(PendingRequest& request);
+
+  void writeRecord(CaptureRecordKind kind, const std::string& content, const std::vector<::grpc::Slice>& payload = {});
+
+  /// Return whether a write succeeded, remembering the error of the first failed one
+  bool checkWrite(bool succeeded);
+
+  std::unique_ptr<std::FILE, int (*)(std::FILE*)> mFile;
+  std::function<void(const std::string& error)> mOnError;
+  /// Error of the first failed write, only used by the writer thread
+  std::string mWriteError;
+  size_t mMaxBufferedBytes;
+  std::chrono::milliseconds mFlushInterval;
+  /// Ids of the methods already defined in the file, only used by the writer thread
+  std::map<std::string, uint16_t> mMethodIds;
+
+  std::mutex mMutex;
+  std::vector<PendingRequest> mPending;
+  size_t mPendingBytes = 0;
+  uint64_t mDropped = 0;
+  /// Set once writing failed, from then on requests are not captured anymore
+  bool mFailed = false;
+  bool mStopping = false;
+  std::condition_variable mStopRequested;
+  std::thread mThread;
+};
+
+/// Create the factory of the interceptors capturing the unary calls of a channel to the given capture
+std::unique_ptr<::grpc::experimental::ClientInterceptorFactoryInterface> createCaptureInterceptorFactory(std::shared_ptr<TrafficCapture> capture);
+
+/// Request read from a capture file
+struct CapturedRequest {
+  std::string method;
+  int64_t sentAtNs;
+  std::string message;
+};
+
+/// Read the requests of a capture file in the order they were sent
+class CaptureReader
+{
+ public:
+  /// Open a capture file, throw std::runtime_error if it can not be opened or is not a capture file
+  explicit CaptureReader(const std::string& path);
+
+  /**
+   * Read the next request
+   *
+   * A truncated last record, left by a process killed while capturing, ends the capture. Throw std::runtime_error if
+   * the file is corrupted.
+   *
+   * @return false once all the requests have been read
+   */
+  bool next(CapturedRequest& request);
+
+  /// Number of requests dropped while capturing the requests read so far
+  uint64_t droppedRequests() const
+  {
+    return mDropped;
+  }
+
+ private:
+  std::unique_ptr<std::FILE, int (*)(std::FILE*)> mFile;
+  std::string mPath;
+  std::map<uint16_t, std::string> mMethods;
+  uint64_t mDropped = 0;
+};
+} // namespace o2::bkp::api::grpc
+
+#endif // CXX_CLIENT_GRPC_TRAFFICCAPTURE_H
@@ -0,0 +1,102 @@
+//  Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+//  See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+//  All rights not expressly granted are reserved.
+//
+//  This software is distributed under the terms of the GNU General Public
+//  License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+//  In applying this license CERN does not waive the privileges and immunities
+//  granted to it by virtue of its status as an Intergovernmental Organization
+//  or submit itself to any jurisdiction.
+
+
+#include "TrafficScheduler.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace o2::bkp::api::grpc
+{
+TrafficScheduler::TrafficScheduler(const PriorityLanesOptions& options) : mOptions(options)
+{
+}
+
+TrafficScheduler::Slot::Slot(TrafficScheduler* scheduler, TrafficClass trafficClass)
+  : mScheduler(scheduler), mTrafficClass(trafficClass)
+{
+  if (mScheduler) {
+    mScheduler->enter(mTrafficClass);
+  }
+}
+
+TrafficScheduler::Slot::~Slot()
+{
+  release();
+}
+
+void TrafficScheduler::Slot::release()
+{
+  if (mScheduler) {
+    mScheduler->leave(mTrafficClass);
+    mScheduler = nullptr;
+  }
+}
+
+void TrafficScheduler::enter(TrafficClass trafficClass)
+{
+  std::unique_lock<std::mutex> lock(mMutex);
+  if (trafficClass == TrafficClass::CRITICAL) {
+    mCriticalInFlight++;
+    return;
+  }
+
+  mBulkSlotReleased.wait(lock, [this]() { return hasBulkSlot(); });
+  mBulkInFlight++;
+}
+
+void TrafficScheduler::enterAsync(TrafficClass trafficClass, std::function<void()> onAdmitted)
+{
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (trafficClass == TrafficClass::CRITICAL) {
+      mCriticalInFlight++;
+    } else if (mPendingBulkCalls.empty() && hasBulkSlot()) {
+      mBulkInFlight++;
+    } else {
+      mPendingBulkCalls.push_back(std::move(onAdmitted));
+      return;
+    }
+  }
+  onAdmitted();
+}
+
+bool TrafficScheduler::hasBulkSlot() const
+{
+  auto limit = mCriticalInFlight > 0 ? mOptions.maxBulkInFlightDuringCritical : mOptions.maxBulkInFlight;
+  // Always let one bulk call through, otherwise a zero limit would starve them forever
+  return mBulkInFlight < std::max<uint32_t>(limit, 1);
+}
+
+void TrafficScheduler::leave(TrafficClass trafficClass)
+{
+  std::vector<std::function<void()>> admittedCalls;
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (trafficClass == TrafficClass::CRITICAL) {
+      mCriticalInFlight--;
+    } else {
+      mBulkInFlight--;
+    }
+    while (!mPendingBulkCalls.empty() && hasBulkSlot()) {
+      mBulkInFlight++;
+      admittedCalls.push_back(std::move(mPendingBulkCalls.front()));
+      mPendingBulkCalls.pop_front();
+    }
+  }
+  // The end of a critical call may raise the limit by more than one slot
+  mBulkSlotReleased.notify_all();
+  for (auto& admittedCall : admittedCalls) {
+    admittedCall();
+  }
+}
+} // namespace o2::bkp::api::grpc
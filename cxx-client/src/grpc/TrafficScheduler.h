@@ -0,0 +1,87 @@
+//  Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+//  See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+//  All rights not expressly granted are reserved.
+//
+//  This software is distributed under the terms of the GNU General Public
+//  License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+//  In applying this license CERN does not waive the privileges and immunities
+//  granted to it by virtue of its status as an Intergovernmental Organization
+//  or submit itself to any jurisdiction.
+
+
+#ifndef CXX_CLIENT_GRPC_TRAFFICSCHEDULER_H
+#define CXX_CLIENT_GRPC_TRAFFICSCHEDULER_H
+
+#include "BookkeepingApi/BkpClientOptions.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+
+namespace o2::bkp::api::grpc
+{
+/// Class of traffic a service belongs to
+enum class TrafficClass {
+  /// Run lifecycle and registration calls, whose latency matters for SOR/EOR
+  CRITICAL,
+  /// High-volume counters updates, superseded by the next samples
+  BULK,
+};
+
+/**
+ * Admission of calls in flight per traffic class
+ *
+ * Critical calls are always dispatched immediately. Bulk calls are limited to a given number in flight, reduced while
+ * critical calls are in flight so that they do not compete with them for the connection and the server.
+ */
+class TrafficScheduler
+{
+ public:
+  explicit TrafficScheduler(const PriorityLanesOptions& options);
+
+  /// Slot taken by a blocking call, released when destroyed unless released before
+  class Slot
+  {
+   public:
+    /// Take a slot of the given class, waiting for it if needed, nothing is taken if there is no scheduler
+    Slot(TrafficScheduler* scheduler, TrafficClass trafficClass);
+    ~Slot();
+    Slot(const Slot&) = delete;
+    Slot& operator=(const Slot&) = delete;
+
+    /// Release the slot before the end of its scope
+    void release();
+
+   private:
+    TrafficScheduler* mScheduler;
+    TrafficClass mTrafficClass;
+  };
+
+  /// Register a call of the given class as in flight, waiting for a slot if it is a bulk one
+  void enter(TrafficClass trafficClass);
+
+  /// Register a call of the given class as in flight without blocking, onAdmitted is run once it got a slot, either
+  /// immediately or when a bulk call leaves
+  void enterAsync(TrafficClass trafficClass, std::function<void()> onAdmitted);
+
+  /// Release the slot taken by a call of the given class
+  void leave(TrafficClass trafficClass);
+
+ private:
+  /// Return true if a bulk call can be admitted now, lock must be held
+  bool hasBulkSlot() const;
+
+  PriorityLanesOptions mOptions;
+
+  std::mutex mMutex;
+  std::condition_variable mBulkSlotReleased;
+  uint32_t mCriticalInFlight = 0;
+  uint32_t mBulkInFlight = 0;
+  std::deque<std::function<void()>> mPendingBulkCalls;
+};
+} // namespace o2::bkp::api::grpc
+
+#endif // CXX_CLIENT_GRPC_TRAFFICSCHEDULER_H
@@ -20,16 +20,35 @@ using o2::bookkeeping::CtpTriggerCounterCreateOrUpdateRequest;
 
 namespace o2::bkp::api::grpc::services
 {
-GrpcCtpTriggerCountersServiceClient::GrpcCtpTriggerCountersServiceClient(const std::shared_ptr<::grpc::ChannelInterface>& channel, const std::function<std::unique_ptr<::grpc::ClientContext> ()>& clientContextFactory)
+GrpcCtpTriggerCountersServiceClient::GrpcCtpTriggerCountersServiceClient(const std::vector<std::shared_ptr<::grpc::ChannelInterface>>& channels, std::unique_ptr<GrpcCallExecutor> callExecutor)
+  : mStubs(channels)
 {
-  mStub = o2::bookkeeping::CtpTriggerCountersService::NewStub(channel);
-  mClientContextFactory = clientContextFactory;
+  mCallExecutor = std::move(callExecutor);
 }
 void GrpcCtpTriggerCountersServiceClient::createOrUpdateForRun(uint32_t runNumber, const std::string& className, int64_t timestamp, uint64_t lmb, uint64_t lma, uint64_t l0b, uint64_t l0a, uint64_t l1b, uint64_t l1a)
 {
-  CtpTriggerCounterCreateOrUpdateRequest request{};
+  auto request = createCreateOrUpdateRequest(runNumber, className, timestamp, lmb, lma, l0b, l0a, l1b, l1a);
   Empty response;
 
+  mCallExecutor->execute("CreateOrUpdateForRun", [&](ClientContext* context, size_t endpoint) { return mStubs[endpoint]->CreateOrUpdateForRun(context, request, &response); });
+}
+
+void GrpcCtpTriggerCountersServiceClient::createOrUpdateForRunAsync(uint32_t runNumber, const std::string& className, int64_t timestamp, uint64_t lmb, uint64_t lma, uint64_t l0b, uint64_t l0a, uint64_t l1b, uint64_t l1a, Completion onDone)
+{
+  auto messages = std::make_shared<CallMessages<CtpTriggerCounterCreateOrUpdateRequest, Empty>>();
+  messages->request = createCreateOrUpdateRequest(runNumber, className, timestamp, lmb, lma, l0b, l0a, l1b, l1a);
+
+  mCallExecutor->executeAsync(
+    "CreateOrUpdateForRun",
+    [this, messages](ClientContext* context, size_t endpoint, std::function<void(::grpc::Status)> onStatus) {
+      mStubs[endpoint]->async()->CreateOrUpdateForRun(context, &messages->request, &messages->response, std::move(onStatus));
+    },
+    std::move(onDone));
+}
+
+CtpTriggerCounterCreateOrUpdateRequest GrpcCtpTriggerCountersServiceClient::createCreateOrUpdateRequest(uint32_t runNumber, const std::string& className, int64_t timestamp, uint64_t lmb, uint64_t lma, uint64_t l0b, uint64_t l0a, uint64_t l1b, uint64_t l1a)
+{
+  CtpTriggerCounterCreateOrUpdateRequest request{};
   request.set_runnumber(runNumber);
   request.set_timestamp(timestamp);
   request.set_classname(className);
@@ -39,11 +58,6 @@ void GrpcCtpTriggerCountersServiceClient::createOrUpdateForRun(uint32_t runNumbe
   request.set_l0a(l0a);
   request.set_l1b(l1b);
   request.set_l1a(l1a);
-
-  auto context = mClientContextFactory();
-  auto status = mStub->CreateOrUpdateForRun(context.get(), request, &response);
-  if (!status.ok()) {
-    throw std::runtime_error(status.error_message());
-  }
+  return request;
 }
 } // namespace o2::bkp::api::grpc::services
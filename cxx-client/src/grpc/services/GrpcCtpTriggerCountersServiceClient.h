@@ -17,6 +17,7 @@
 
 #include "ctpTriggerCounters.grpc.pb.h"
 #include "BookkeepingApi/CtpTriggerCountersServiceClient.h"
+#include "grpc/GrpcCallExecutor.h"
 
 namespace o2::bkp::api::grpc::services
 {
@@ -24,14 +25,19 @@ namespace o2::bkp::api::grpc::services
 class GrpcCtpTriggerCountersServiceClient: public CtpTriggerCountersServiceClient
 {
  public:
-  explicit GrpcCtpTriggerCountersServiceClient(const std::shared_ptr<::grpc::ChannelInterface>& channel, const std::function<std::unique_ptr<::grpc::ClientContext> ()>& clientContextFactory);
+  explicit GrpcCtpTriggerCountersServiceClient(const std::vector<std::shared_ptr<::grpc::ChannelInterface>>& channels, std::unique_ptr<GrpcCallExecutor> callExecutor);
   ~GrpcCtpTriggerCountersServiceClient() override = default;
 
   void createOrUpdateForRun(uint32_t runNumber, const std::string& className, int64_t timestamp, uint64_t lmb, uint64_t lma, uint64_t l0b, uint64_t l0a, uint64_t l1b, uint64_t l1a) override;
 
+  void createOrUpdateForRunAsync(uint32_t runNumber, const std::string& className, int64_t timestamp, uint64_t lmb, uint64_t lma, uint64_t l0b, uint64_t l0a, uint64_t l1b, uint64_t l1a, Completion onDone) override;
+
  private:
-  std::unique_ptr<o2::bookkeeping::CtpTriggerCountersService::Stub> mStub;
-  std::function<std::unique_ptr<::grpc::ClientContext> ()> mClientContextFactory;
+  static o2::bookkeeping::CtpTriggerCounterCreateOrUpdateRequest createCreateOrUpdateRequest(uint32_t runNumber, const std::string& className, int64_t timestamp, uint64_t lmb, uint64_t lma, uint64_t l0b, uint64_t l0a, uint64_t l1b, uint64_t l1a);
+
+  /// One stub per endpoint
+  LazyStubs<o2::bookkeeping::CtpTriggerCountersService> mStubs;
+  std::unique_ptr<GrpcCallExecutor> mCallExecutor;
 };
 
 } // namespace o2::bkp::api::grpc::services
@@ -10,6 +10,7 @@
 //  or submit itself to any jurisdiction.
 
 #include "GrpcDplProcessExecutionClient.h"
+#include "grpc/IdempotencyKey.h"
 
 using grpc::ClientContext;
 using o2::bkp::DplProcessType;
@@ -22,10 +23,10 @@ namespace o2::bkp
 
 namespace api::grpc::services
 {
-GrpcDplProcessExecutionClient::GrpcDplProcessExecutionClient(const std::shared_ptr<::grpc::ChannelInterface>& channel, const std::function<std::unique_ptr<::grpc::ClientContext> ()>& clientContextFactory)
+GrpcDplProcessExecutionClient::GrpcDplProcessExecutionClient(const std::vector<std::shared_ptr<::grpc::ChannelInterface>>& channels, std::unique_ptr<GrpcCallExecutor> callExecutor)
+  : mStubs(channels)
 {
-  mStub = DplProcessExecutionService::NewStub(channel);
-  mClientContextFactory = clientContextFactory;
+  mCallExecutor = std::move(callExecutor);
 }
 
 void GrpcDplProcessExecutionClient::registerProcessExecution(
@@ -35,6 +36,41 @@ void GrpcDplProcessExecutionClient::registerProcessExecution(
   std::string deviceId,
   std::string args,
   std::string detector)
+{
+  auto request = createCreationRequest(runNumber, type, hostname, deviceId, args, detector);
+  auto response = std::make_shared<DplProcessExecution>();
+
+  mCallExecutor->execute("Create", [&](ClientContext* context, size_t endpoint) { return mStubs[endpoint]->Create(context, request, response.get()); }, RetryEndpoint::FIRST);
+}
+
+void GrpcDplProcessExecutionClient::registerProcessExecutionAsync(
+  int runNumber,
+  DplProcessType type,
+  std::string hostname,
+  std::string deviceId,
+  std::string args,
+  std::string detector,
+  Completion onDone)
+{
+  auto messages = std::make_shared<CallMessages<DplProcessExecutionCreationRequest, DplProcessExecution>>();
+  messages->request = createCreationRequest(runNumber, type, hostname, deviceId, args, detector);
+
+  mCallExecutor->executeAsync(
+    "Create",
+    [this, messages](ClientContext* context, size_t endpoint, std::function<void(::grpc::Status)> onStatus) {
+      mStubs[endpoint]->async()->Create(context, &messages->request, &messages->response, std::move(onStatus));
+    },
+    std::move(onDone),
+    RetryEndpoint::FIRST);
+}
+
+DplProcessExecutionCreationRequest GrpcDplProcessExecutionClient::createCreationRequest(
+  int runNumber,
+  DplProcessType type,
+  const std::string& hostname,
+  const std::string& deviceId,
+  const std::string& args,
+  const std::string& detector)
 {
   DplProcessExecutionCreationRequest request{};
   request.set_runnumber(runNumber);
@@ -42,15 +78,9 @@ void GrpcDplProcessExecutionClient::registerProcessExecution(
   request.set_processname(deviceId);
   request.set_type(static_cast<o2::bookkeeping::DplProcessType>(type));
   request.set_hostname(hostname);
-
-  auto response = std::make_shared<DplProcessExecution>();
-
-  auto context = mClientContextFactory();
-  auto status = mStub->Create(context.get(), request, response.get());
-
-  if (!status.ok()) {
-    throw std::runtime_error(status.error_message());
-  }
+  request.set_args(args);
+  request.set_idempotencykey(createIdempotencyKey());
+  return request;
 }
 } // namespace api::grpc::services
 
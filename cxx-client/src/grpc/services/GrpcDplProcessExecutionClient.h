@@ -13,6 +13,7 @@
 #define CXX_CLIENT_BOOKKEEPINGAPI_GRPC_SERVICES_GRPCDPLPROCESSEXECUTIONCLIENT_H
 
 #include "BookkeepingApi/DplProcessExecutionClient.h"
+#include "grpc/GrpcCallExecutor.h"
 #include "dplProcessExecution.grpc.pb.h"
 #include "BookkeepingApi/QcFlag.h"
 
@@ -21,7 +22,7 @@ namespace o2::bkp::api::grpc::services
 class GrpcDplProcessExecutionClient : public ::o2::bkp::api::DplProcessExecutionClient
 {
  public:
-  explicit GrpcDplProcessExecutionClient(const std::shared_ptr<::grpc::ChannelInterface>& channel, const std::function<std::unique_ptr<::grpc::ClientContext> ()>& clientContextFactory);
+  explicit GrpcDplProcessExecutionClient(const std::vector<std::shared_ptr<::grpc::ChannelInterface>>& channels, std::unique_ptr<GrpcCallExecutor> callExecutor);
 
   void registerProcessExecution(
     int runNumber,
@@ -31,9 +32,27 @@ class GrpcDplProcessExecutionClient : public ::o2::bkp::api::DplProcessExecution
     std::string args,
     std::string detector) override;
 
+  void registerProcessExecutionAsync(
+    int runNumber,
+    o2::bkp::DplProcessType type,
+    std::string hostname,
+    std::string deviceId,
+    std::string args,
+    std::string detector,
+    Completion onDone) override;
+
  private:
-  std::unique_ptr<o2::bookkeeping::DplProcessExecutionService::Stub> mStub;
-  std::function<std::unique_ptr<::grpc::ClientContext> ()> mClientContextFactory;
+  static o2::bookkeeping::DplProcessExecutionCreationRequest createCreationRequest(
+    int runNumber,
+    o2::bkp::DplProcessType type,
+    const std::string& hostname,
+    const std::string& deviceId,
+    const std::string& args,
+    const std::string& detector);
+
+  /// One stub per endpoint
+  LazyStubs<o2::bookkeeping::DplProcessExecutionService> mStubs;
+  std::unique_ptr<GrpcCallExecutor> mCallExecutor;
 };
 } // namespace o2::bkp::api::grpc::services
 
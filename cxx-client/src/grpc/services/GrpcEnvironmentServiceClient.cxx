@@ -0,0 +1,263 @@
+//  Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+//  See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+//  All rights not expressly granted are reserved.
+//
+//  This software is distributed under the terms of the GNU General Public
+//  License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+//  In applying this license CERN does not waive the privileges and immunities
+//  granted to it by virtue of its status as an Intergovernmental Organization
+//  or submit itself to any jurisdiction.
+//
+
+
+#include "GrpcEnvironmentServiceClient.h"
+
+#include <grpc/compression.h>
+
+using grpc::ClientContext;
+
+using o2::bookkeeping::Environment;
+using o2::bookkeeping::EnvironmentCreationRequest;
+using o2::bookkeeping::EnvironmentUpdateRequest;
+
+namespace o2::bkp::api::grpc::services
+{
+namespace
+{
+/// Environments whose last acknowledged status is kept, the ones which never report a final status being forgotten
+constexpr size_t MAX_TRACKED_ENVIRONMENTS = 1024;
+
+/// Whether an environment with the given status will not report any other one
+bool isFinal(const std::string& status)
+{
+  return status == "DESTROYED" || status == "DONE";
+}
+
+/// Call the given completions, the ones not set are skipped
+void complete(const std::vector<Completion>& completions, std::exception_ptr error)
+{
+  for (const auto& onDone : completions) {
+    if (onDone) {
+      onDone(error);
+    }
+  }
+}
+
+/// Status of a creation attempt, an environment already existing on a retry having been created by a previous attempt
+::grpc::Status acceptExistingOnRetry(const ::grpc::Status& status, uint32_t attempt)
+{
+  return attempt > 1 && status.error_code() == ::grpc::StatusCode::ALREADY_EXISTS ? ::grpc::Status::OK : status;
+}
+} // namespace
+
+GrpcEnvironmentServiceClient::GrpcEnvironmentServiceClient(const std::vector<std::shared_ptr<::grpc::ChannelInterface>>& channels, std::unique_ptr<GrpcCallExecutor> callExecutor)
+  : mStubs(channels), mCallExecutor(std::move(callExecutor))
+{
+}
+
+void GrpcEnvironmentServiceClient::create(std::string id, std::string rawConfiguration, std::optional<std::string> status, std::optional<std::string> statusMessage)
+{
+  forgetSentStatus(id);
+  auto request = createEnvironmentCreationRequest(id, std::move(rawConfiguration), std::move(status), std::move(statusMessage));
+  Environment environment;
+  uint32_t attempt = 0;
+
+  try {
+    mCallExecutor->execute("Create", [&](ClientContext* context, size_t endpoint) {
+      // The raw configuration is large and repetitive text, it shrinks a lot
+      context->set_compression_algorithm(GRPC_COMPRESS_GZIP);
+      return acceptExistingOnRetry(mStubs[endpoint]->Create(context, request, &environment), ++attempt);
+    });
+  } catch (...) {
+    forgetSentStatus(id);
+    throw;
+  }
+  forgetSentStatus(id);
+}
+
+void GrpcEnvironmentServiceClient::createAsync(std::string id, std::string rawConfiguration, std::optional<std::string> status, std::optional<std::string> statusMessage, Completion onDone)
+{
+  forgetSentStatus(id);
+  auto messages = std::make_shared<CallMessages<EnvironmentCreationRequest, Environment>>();
+  messages->request = createEnvironmentCreationRequest(id, std::move(rawConfiguration), std::move(status), std::move(statusMessage));
+
+  mCallExecutor->executeAsync(
+    "Create",
+    [this, messages, attempt = uint32_t{ 0 }](ClientContext* context, size_t endpoint, std::function<void(::grpc::Status)> onStatus) mutable {
+      context->set_compression_algorithm(GRPC_COMPRESS_GZIP);
+      mStubs[endpoint]->async()->Create(context, &messages->request, &messages->response, [attempt = ++attempt, onStatus = std::move(onStatus)](::grpc::Status status) {
+        onStatus(acceptExistingOnRetry(status, attempt));
+      });
+    },
+    [this, id, onDone = std::move(onDone)](std::exception_ptr error) {
+      forgetSentStatus(id);
+      onDone(error);
+    });
+}
+
+void GrpcEnvironmentServiceClient::update(std::string id, std::string status, std::optional<std::string> statusMessage)
+{
+  forgetSentStatus(id);
+  auto request = createEnvironmentUpdateRequest(id, { std::move(status), std::move(statusMessage) });
+  Environment environment;
+
+  try {
+    mCallExecutor->execute("Update", [&](ClientContext* context, size_t endpoint) { return mStubs[endpoint]->Update(context, request, &environment); });
+  } catch (...) {
+    forgetSentStatus(id);
+    throw;
+  }
+  forgetSentStatus(id);
+}
+
+void GrpcEnvironmentServiceClient::updateStatus(std::string id, std::string status, std::optional<std::string> statusMessage, Completion onDone)
+{
+  Status reported{ std::move(status), std::move(statusMessage) };
+  {
+    std::unique_lock<std::mutex> lock(mStatusUpdatesMutex);
+    if (mStatusUpdates.size() >= MAX_TRACKED_ENVIRONMENTS && mStatusUpdates.count(id) == 0) {
+      evictIdleStatusUpdates();
+    }
+    auto& updates = mStatusUpdates[id];
+    updates.lastReport = ++mStatusReports;
+
+    if (updates.pending.has_value()) {
+      // Replaces the status waiting for the one in flight
+      updates.pending = std::move(reported);
+      updates.pendingCompletions.push_back(std::move(onDone));
+      return;
+    }
+    if (updates.inFlight.has_value()) {
+      if (*updates.inFlight == reported) {
+        updates.inFlightCompletions.push_back(std::move(onDone));
+      } else {
+        updates.pending = std::move(reported);
+        updates.pendingCompletions.push_back(std::move(onDone));
+      }
+      return;
+    }
+    if (updates.sent == reported) {
+      lock.unlock();
+      complete({ onDone }, nullptr);
+      return;
+    }
+
+    updates.inFlight = reported;
+    updates.inFlightGeneration = updates.generation;
+    updates.inFlightCompletions.push_back(std::move(onDone));
+  }
+  sendStatus(id, reported);
+}
+
+void GrpcEnvironmentServiceClient::forgetSentStatus(const std::string& id)
+{
+  std::lock_guard<std::mutex> lock(mStatusUpdatesMutex);
+  auto updates = mStatusUpdates.find(id);
+  if (updates == mStatusUpdates.end()) {
+    return;
+  }
+  if (!updates->second.inFlight.has_value()) {
+    mStatusUpdates.erase(updates);
+    return;
+  }
+  updates->second.sent.reset();
+  updates->second.generation++;
+}
+
+void GrpcEnvironmentServiceClient::evictIdleStatusUpdates()
+{
+  while (mStatusUpdates.size() >= MAX_TRACKED_ENVIRONMENTS) {
+    auto oldest = mStatusUpdates.end();
+    for (auto updates = mStatusUpdates.begin(); updates != mStatusUpdates.end(); updates++) {
+      if (!updates->second.inFlight.has_value() && (oldest == mStatusUpdates.end() || updates->second.lastReport < oldest->second.lastReport)) {
+        oldest = updates;
+      }
+    }
+    if (oldest == mStatusUpdates.end()) {
+      // All of them have a status update in flight, they are forgotten once it is acknowledged
+      return;
+    }
+    mStatusUpdates.erase(oldest);
+  }
+}
+
+void GrpcEnvironmentServiceClient::sendStatus(const std::string& id, const Status& status)
+{
+  auto messages = std::make_shared<CallMessages<EnvironmentUpdateRequest, Environment>>();
+  messages->request = createEnvironmentUpdateRequest(id, status);
+
+  mCallExecutor->executeAsync(
+    "Update",
+    [this, messages](ClientContext* context, size_t endpoint, std::function<void(::grpc::Status)> onStatus) {
+      mStubs[endpoint]->async()->Update(context, &messages->request, &messages->response, std::move(onStatus));
+    },
+    [this, id](std::exception_ptr error) { onStatusSent(id, error); });
+}
+
+void GrpcEnvironmentServiceClient::onStatusSent(const std::string& id, std::exception_ptr error)
+{
+  std::vector<Completion> completions;
+  std::vector<Completion> pendingCompletions;
+  std::optional<Status> next;
+  {
+    std::lock_guard<std::mutex> lock(mStatusUpdatesMutex);
+    auto& updates = mStatusUpdates[id];
+    completions = std::move(updates.inFlightCompletions);
+    updates.inFlightCompletions.clear();
+    // After a failure, or if create or update set the status meanwhile, the status known by bookkeeping is unknown: the
+    // next one must be sent whatever it is
+    updates.sent = error || updates.inFlightGeneration != updates.generation ? std::nullopt : updates.inFlight;
+    updates.inFlight.reset();
+
+    if (updates.pending.has_value()) {
+      if (updates.sent == updates.pending) {
+        // Back to the status which has just been sent
+        pendingCompletions = std::move(updates.pendingCompletions);
+      } else {
+        next = updates.pending;
+        updates.inFlight = std::move(updates.pending);
+        updates.inFlightGeneration = updates.generation;
+        updates.inFlightCompletions = std::move(updates.pendingCompletions);
+      }
+      updates.pending.reset();
+      updates.pendingCompletions.clear();
+    }
+
+    if (!updates.inFlight.has_value() && updates.sent.has_value() && isFinal(updates.sent->status)) {
+      mStatusUpdates.erase(id);
+    }
+  }
+
+  complete(completions, error);
+  complete(pendingCompletions, nullptr);
+  if (next.has_value()) {
+    sendStatus(id, *next);
+  }
+}
+
+EnvironmentCreationRequest GrpcEnvironmentServiceClient::createEnvironmentCreationRequest(std::string id, std::string rawConfiguration, std::optional<std::string> status, std::optional<std::string> statusMessage)
+{
+  EnvironmentCreationRequest request;
+  request.set_id(std::move(id));
+  request.set_rawconfiguration(std::move(rawConfiguration));
+  if (status.has_value()) {
+    request.set_status(std::move(*status));
+  }
+  if (statusMessage.has_value()) {
+    request.set_statusmessage(std::move(*statusMessage));
+  }
+  return request;
+}
+
+EnvironmentUpdateRequest GrpcEnvironmentServiceClient::createEnvironmentUpdateRequest(std::string id, const Status& status)
+{
+  EnvironmentUpdateRequest request;
+  request.set_id(std::move(id));
+  request.set_status(status.status);
+  if (status.statusMessage.has_value()) {
+    request.set_statusmessage(*status.statusMessage);
+  }
+  return request;
+}
+} // namespace o2::bkp::api::grpc::services
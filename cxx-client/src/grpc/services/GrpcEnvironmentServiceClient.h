@@ -0,0 +1,97 @@
+//  Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+//  See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+//  All rights not expressly granted are reserved.
+//
+//  This software is distributed under the terms of the GNU General Public
+//  License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+//  In applying this license CERN does not waive the privileges and immunities
+//  granted to it by virtue of its status as an Intergovernmental Organization
+//  or submit itself to any jurisdiction.
+
+
+#ifndef CXX_CLIENT_BOOKKEEPINGAPI_GRPCENVIRONMENTSERVICECLIENT_H
+#define CXX_CLIENT_BOOKKEEPINGAPI_GRPCENVIRONMENTSERVICECLIENT_H
+
+#include "environment.grpc.pb.h"
+#include "BookkeepingApi/EnvironmentServiceClient.h"
+#include "grpc/GrpcCallExecutor.h"
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace o2::bkp::api::grpc::services
+{
+
+class GrpcEnvironmentServiceClient : public EnvironmentServiceClient
+{
+ public:
+  explicit GrpcEnvironmentServiceClient(const std::vector<std::shared_ptr<::grpc::ChannelInterface>>& channels, std::unique_ptr<GrpcCallExecutor> callExecutor);
+  ~GrpcEnvironmentServiceClient() override = default;
+
+  void create(std::string id, std::string rawConfiguration, std::optional<std::string> status, std::optional<std::string> statusMessage) override;
+
+  void createAsync(std::string id, std::string rawConfiguration, std::optional<std::string> status, std::optional<std::string> statusMessage, Completion onDone) override;
+
+  void update(std::string id, std::string status, std::optional<std::string> statusMessage) override;
+
+  void updateStatus(std::string id, std::string status, std::optional<std::string> statusMessage, Completion onDone) override;
+
+ private:
+  /// Status and status message of an environment
+  struct Status {
+    std::string status;
+    std::optional<std::string> statusMessage;
+
+    bool operator==(const Status& other) const { return status == other.status && statusMessage == other.statusMessage; }
+  };
+
+  /// Updates of the status of an environment reported through updateStatus
+  struct StatusUpdates {
+    /// Last status acknowledged by bookkeeping, unknown after a failure
+    std::optional<Status> sent;
+    /// Status being sent, if any, and the completions of the calls it answers
+    std::optional<Status> inFlight;
+    std::vector<Completion> inFlightCompletions;
+    /// Latest status reported while another one was in flight, and the completions of the calls it answers
+    std::optional<Status> pending;
+    std::vector<Completion> pendingCompletions;
+    /// Incremented each time the status is set by create or update, and its value when the status in flight was sent:
+    /// a status sent before is not the one known by bookkeeping once acknowledged
+    uint64_t generation = 0;
+    uint64_t inFlightGeneration = 0;
+    /// Order of the last status reported, the environments idle for the longest are forgotten first
+    uint64_t lastReport = 0;
+  };
+
+  static o2::bookkeeping::EnvironmentCreationRequest createEnvironmentCreationRequest(std::string id, std::string rawConfiguration, std::optional<std::string> status, std::optional<std::string> statusMessage);
+
+  static o2::bookkeeping::EnvironmentUpdateRequest createEnvironmentUpdateRequest(std::string id, const Status& status);
+
+  /// Forget the status last acknowledged for the given environment, as create and update set it without going through
+  /// updateStatus: the next reported status is then sent whatever it is, as is the one in flight once acknowledged
+  void forgetSentStatus(const std::string& id);
+
+  /// Forget the least recently reported environments with no status update in flight, down to the tracked limit
+  void evictIdleStatusUpdates();
+
+  /// Send the status in flight of the given environment
+  void sendStatus(const std::string& id, const Status& status);
+
+  /// Complete the status update in flight of the given environment, then send its pending status if any
+  void onStatusSent(const std::string& id, std::exception_ptr error);
+
+  /// One stub per endpoint
+  LazyStubs<o2::bookkeeping::EnvironmentService> mStubs;
+  std::unique_ptr<GrpcCallExecutor> mCallExecutor;
+
+  std::mutex mStatusUpdatesMutex;
+  std::map<std::string, StatusUpdates> mStatusUpdates;
+  uint64_t mStatusReports = 0;
+};
+
+} // namespace o2::bkp::api::grpc::services
+
+#endif // CXX_CLIENT_BOOKKEEPINGAPI_GRPCENVIRONMENTSERVICECLIENT_H
@@ -24,9 +24,10 @@ using o2::bookkeeping::UpdateCountersRequest;
 
 namespace o2::bkp::api::grpc::services
 {
-GrpcFlpServiceClient::GrpcFlpServiceClient(const std::shared_ptr<::grpc::ChannelInterface>& channel, const std::function<std::unique_ptr<::grpc::ClientContext>()>& clientContextFactory){
-  mStub = o2::bookkeeping::FlpService::NewStub(channel);
-  mClientContextFactory = clientContextFactory;
+GrpcFlpServiceClient::GrpcFlpServiceClient(const std::vector<std::shared_ptr<::grpc::ChannelInterface>>& channels, std::unique_ptr<GrpcCallExecutor> callExecutor)
+  : mStubs(channels)
+{
+  mCallExecutor = std::move(callExecutor);
 }
 
 void GrpcFlpServiceClient::updateReadoutCountersByFlpNameAndRunNumber(
@@ -38,20 +39,46 @@ void GrpcFlpServiceClient::updateReadoutCountersByFlpNameAndRunNumber(
   uint64_t nFairMQBytes)
 {
   o2::bookkeeping::Flp updatedFlp;
-  UpdateCountersRequest request;
+  auto request = createUpdateCountersRequest(flpName, runNumber, nSubtimeframes, nEquipmentBytes, nRecordingBytes, nFairMQBytes);
+
+  mCallExecutor->execute("UpdateCounters", [&](ClientContext* context, size_t endpoint) { return mStubs[endpoint]->UpdateCounters(context, request, &updatedFlp); });
+}
+
+void GrpcFlpServiceClient::updateReadoutCountersByFlpNameAndRunNumberAsync(
+  const std::string& flpName,
+  int32_t runNumber,
+  uint64_t nSubtimeframes,
+  uint64_t nEquipmentBytes,
+  uint64_t nRecordingBytes,
+  uint64_t nFairMQBytes,
+  Completion onDone)
+{
+  auto messages = std::make_shared<CallMessages<UpdateCountersRequest, o2::bookkeeping::Flp>>();
+  messages->request = createUpdateCountersRequest(flpName, runNumber, nSubtimeframes, nEquipmentBytes, nRecordingBytes, nFairMQBytes);
 
+  mCallExecutor->executeAsync(
+    "UpdateCounters",
+    [this, messages](ClientContext* context, size_t endpoint, std::function<void(Status)> onStatus) {
+      mStubs[endpoint]->async()->UpdateCounters(context, &messages->request, &messages->response, std::move(onStatus));
+    },
+    std::move(onDone));
+}
+
+UpdateCountersRequest GrpcFlpServiceClient::createUpdateCountersRequest(
+  const std::string& flpName,
+  int32_t runNumber,
+  uint64_t nSubtimeframes,
+  uint64_t nEquipmentBytes,
+  uint64_t nRecordingBytes,
+  uint64_t nFairMQBytes)
+{
+  UpdateCountersRequest request;
   request.set_flpname(flpName);
   request.set_runnumber(runNumber);
   request.set_nsubtimeframes(nSubtimeframes);
   request.set_nequipmentbytes(nEquipmentBytes);
   request.set_nrecordingbytes(nRecordingBytes);
   request.set_nfairmqbytes(nFairMQBytes);
-
-  auto context = mClientContextFactory();
-  auto status = mStub->UpdateCounters(context.get(), request, &updatedFlp);
-
-  if (!status.ok()) {
-    throw std::runtime_error(status.error_message());
-  }
+  return request;
 }
 } // namespace o2::bkp::api::grpc::services
@@ -17,6 +17,7 @@
 #define BOOKKEEPINGAPI_GRPC_SERVICES_GRPCFLPSERVICECLIENT_H_
 
 #include "BookkeepingApi/FlpServiceClient.h"
+#include "grpc/GrpcCallExecutor.h"
 #include "flp.grpc.pb.h"
 
 namespace o2::bkp::api::grpc::services
@@ -25,7 +26,7 @@ namespace o2::bkp::api::grpc::services
 class GrpcFlpServiceClient : public FlpServiceClient
 {
  public:
-  explicit GrpcFlpServiceClient(const std::shared_ptr<::grpc::ChannelInterface>& channel, const std::function<std::unique_ptr<::grpc::ClientContext> ()>& clientContextFactory);
+  explicit GrpcFlpServiceClient(const std::vector<std::shared_ptr<::grpc::ChannelInterface>>& channels, std::unique_ptr<GrpcCallExecutor> callExecutor);
 
   void updateReadoutCountersByFlpNameAndRunNumber(
     const std::string& flpName,
@@ -35,9 +36,27 @@ class GrpcFlpServiceClient : public FlpServiceClient
     uint64_t nRecordingBytes,
     uint64_t nFairMQBytes) override;
 
+  void updateReadoutCountersByFlpNameAndRunNumberAsync(
+    const std::string& flpName,
+    int32_t runNumber,
+    uint64_t nSubtimeframes,
+    uint64_t nEquipmentBytes,
+    uint64_t nRecordingBytes,
+    uint64_t nFairMQBytes,
+    Completion onDone) override;
+
  private:
-  std::unique_ptr<o2::bookkeeping::FlpService::Stub> mStub;
-  std::function<std::unique_ptr<::grpc::ClientContext> ()> mClientContextFactory;
+  static o2::bookkeeping::UpdateCountersRequest createUpdateCountersRequest(
+    const std::string& flpName,
+    int32_t runNumber,
+    uint64_t nSubtimeframes,
+    uint64_t nEquipmentBytes,
+    uint64_t nRecordingBytes,
+    uint64_t nFairMQBytes);
+
+  /// One stub per endpoint
+  LazyStubs<o2::bookkeeping::FlpService> mStubs;
+  std::unique_ptr<GrpcCallExecutor> mCallExecutor;
 };
 } // namespace o2::bkp::api::grpc::services
 
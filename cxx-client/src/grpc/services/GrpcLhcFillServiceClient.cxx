@@ -0,0 +1,57 @@
+//  Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+//  See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+//  All rights not expressly granted are reserved.
+//
+//  This software is distributed under the terms of the GNU General Public
+//  License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+//  In applying this license CERN does not waive the privileges and immunities
+//  granted to it by virtue of its status as an Intergovernmental Organization
+//  or submit itself to any jurisdiction.
+
+
+#include "GrpcLhcFillServiceClient.h"
+#include "grpc/GrpcSubscription.h"
+
+#include <memory>
+
+using grpc::ClientContext;
+
+using o2::bookkeeping::LastLhcFillWatchRequest;
+using o2::bookkeeping::LhcFillWithRelations;
+
+namespace o2::bkp::api::grpc::services
+{
+GrpcLhcFillServiceClient::GrpcLhcFillServiceClient(const std::vector<std::shared_ptr<::grpc::ChannelInterface>>& channels, std::unique_ptr<GrpcCallExecutor> callExecutor)
+  : mStubs(channels), mCallExecutor(std::move(callExecutor))
+{
+}
+
+std::unique_ptr<Subscription<LhcFill>> GrpcLhcFillServiceClient::watchLast(OnChange<LhcFill> onChange)
+{
+  return std::make_unique<GrpcSubscription<LhcFill, LhcFillWithRelations>>(
+    mCallExecutor.get(),
+    "Watch",
+    [this](ClientContext* context, size_t endpoint) { return mStubs[endpoint]->Watch(context, LastLhcFillWatchRequest{}); },
+    [](const LhcFillWithRelations& lhcFillWithRelations) { return fromGrpcLhcFill(lhcFillWithRelations.lhcfill()); },
+    std::move(onChange));
+}
+
+LhcFill GrpcLhcFillServiceClient::fromGrpcLhcFill(const o2::bookkeeping::LHCFill& grpcLhcFill)
+{
+  LhcFill lhcFill;
+  lhcFill.fillNumber = grpcLhcFill.fillnumber();
+  if (grpcLhcFill.has_stablebeamsstart()) {
+    lhcFill.stableBeamsStart = grpcLhcFill.stablebeamsstart();
+  }
+  if (grpcLhcFill.has_stablebeamsend()) {
+    lhcFill.stableBeamsEnd = grpcLhcFill.stablebeamsend();
+  }
+  if (grpcLhcFill.has_stablebeamsduration()) {
+    lhcFill.stableBeamsDuration = grpcLhcFill.stablebeamsduration();
+  }
+  lhcFill.beamType = grpcLhcFill.beamtype();
+  lhcFill.fillingSchemeName = grpcLhcFill.fillingschemename();
+  return lhcFill;
+}
+} // namespace o2::bkp::api::grpc::services
@@ -0,0 +1,44 @@
+//  Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+//  See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+//  All rights not expressly granted are reserved.
+//
+//  This software is distributed under the terms of the GNU General Public
+//  License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+//  In applying this license CERN does not waive the privileges and immunities
+//  granted to it by virtue of its status as an Intergovernmental Organization
+//  or submit itself to any jurisdiction.
+
+
+#ifndef CXX_CLIENT_BOOKKEEPINGAPI_GRPCLHCFILLSERVICECLIENT_H
+#define CXX_CLIENT_BOOKKEEPINGAPI_GRPCLHCFILLSERVICECLIENT_H
+
+#include "lhcFill.grpc.pb.h"
+#include "BookkeepingApi/LhcFillServiceClient.h"
+#include "grpc/GrpcCallExecutor.h"
+
+#include <memory>
+
+namespace o2::bkp::api::grpc::services
+{
+
+class GrpcLhcFillServiceClient : public LhcFillServiceClient
+{
+ public:
+  explicit GrpcLhcFillServiceClient(const std::vector<std::shared_ptr<::grpc::ChannelInterface>>& channels, std::unique_ptr<GrpcCallExecutor> callExecutor);
+  ~GrpcLhcFillServiceClient() override = default;
+
+  std::unique_ptr<Subscription<LhcFill>> watchLast(OnChange<LhcFill> onChange) override;
+
+  /// Convert an LHC fill received from bookkeeping to its API representation
+  static LhcFill fromGrpcLhcFill(const o2::bookkeeping::LHCFill& grpcLhcFill);
+
+ private:
+  /// One stub per endpoint
+  LazyStubs<o2::bookkeeping::LhcFillService> mStubs;
+  std::unique_ptr<GrpcCallExecutor> mCallExecutor;
+};
+
+} // namespace o2::bkp::api::grpc::services
+
+#endif // CXX_CLIENT_BOOKKEEPINGAPI_GRPCLHCFILLSERVICECLIENT_H
@@ -0,0 +1,293 @@
+//  Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+//  See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+//  All rights not expressly granted are reserved.
+//
+//  This software is distributed under the terms of the GNU General Public
+//  License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+//  In applying this license CERN does not waive the privileges and immunities
+//  granted to it by virtue of its status as an Intergovernmental Organization
+//  or submit itself to any jurisdiction.
+//
+
+
+#include "GrpcLogServiceClient.h"
+#include "grpc/IdempotencyKey.h"
+
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <google/protobuf/io/coded_stream.h>
+#include <grpcpp/generic/generic_stub.h>
+#include <grpcpp/support/byte_buffer.h>
+#include <grpcpp/support/client_callback.h>
+
+using grpc::ByteBuffer;
+using grpc::ClientContext;
+using grpc::Slice;
+
+using o2::bookkeeping::Attachment;
+using o2::bookkeeping::AttachmentUploadRequest;
+using o2::bookkeeping::Log;
+using o2::bookkeeping::LogCreationRequest;
+
+namespace o2::bkp::api::grpc::services
+{
+namespace
+{
+/// Size of the file content sent in each message, well below the default maximal message size of the server
+constexpr size_t ATTACHMENT_CHUNK_SIZE = 1024 * 1024;
+
+constexpr char UPLOAD_ATTACHMENT_METHOD[] = "/o2.bookkeeping.LogService/UploadAttachment";
+
+std::runtime_error systemError(const std::string& what, const std::string& path)
+{
+  return std::runtime_error(what + " attachment " + path + ": " + std::strerror(errno));
+}
+
+/// Read-only mapping of a whole file, unmapped once the last slice pointing into it has been released by gRPC
+class MappedFile
+{
+ public:
+  explicit MappedFile(const std::string& path)
+  {
+    auto fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      throw systemError("Unable to open", path);
+    }
+    struct stat status {
+    };
+    if (fstat(fd, &status) != 0) {
+      close(fd);
+      throw systemError("Unable to stat", path);
+    }
+    mSize = static_cast<size_t>(status.st_size);
+    if (mSize > static_cast<size_t>(std::numeric_limits<int32_t>::max())) {
+      close(fd);
+      throw std::runtime_error("Attachment " + path + " is too large, attachments are limited to 2 GiB");
+    }
+    if (mSize > 0) {
+      mData = mmap(nullptr, mSize, PROT_READ, MAP_SHARED, fd, 0);
+      if (mData == MAP_FAILED) {
+        close(fd);
+        throw systemError("Unable to map", path);
+      }
+      // Pages are read once, in order: let the kernel read ahead and drop them early
+      madvise(mData, mSize, MADV_SEQUENTIAL);
+    }
+    close(fd);
+  }
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  ~MappedFile()
+  {
+    if (mSize > 0) {
+      munmap(mData, mSize);
+    }
+  }
+
+  char* data() const { return static_cast<char*>(mData); }
+  size_t size() const { return mSize; }
+
+  /// Drop the pages of a part of the file already sent from the memory of the process, they are not read again
+  void release(size_t offset, size_t size) const
+  {
+    madvise(data() + offset, size, MADV_DONTNEED);
+  }
+
+ private:
+  void* mData = nullptr;
+  size_t mSize = 0;
+};
+
+/// Part of the mapping referenced by a slice sent to gRPC
+struct MappedChunk {
+  std::shared_ptr<MappedFile> file;
+  size_t offset;
+  size_t size;
+};
+
+/// Message carrying a chunk of the file, made of the encoded field header followed by a slice pointing in the mapping
+///
+/// The chunk is the only field of the message, so the content does not need to go through a protobuf message and is
+/// never copied by the client.
+ByteBuffer chunkMessage(const std::shared_ptr<MappedFile>& file, size_t offset, size_t size)
+{
+  // Tag and length, both encoded as varints of at most 5 bytes
+  uint8_t header[10];
+  auto headerEnd = google::protobuf::io::CodedOutputStream::WriteVarint32ToArray((AttachmentUploadRequest::kChunkFieldNumber << 3) | 2, header);
+  headerEnd = google::protobuf::io::CodedOutputStream::WriteVarint32ToArray(static_cast<uint32_t>(size), headerEnd);
+
+  // Each slice keeps the mapping alive until gRPC is done sending it, its pages are then released so that the memory
+  // used by an upload does not grow with the size of the file
+  Slice slices[] = {
+    Slice(header, headerEnd - header),
+    Slice(
+      file->data() + offset,
+      size,
+      [](void* owner) {
+        auto chunk = static_cast<MappedChunk*>(owner);
+        chunk->file->release(chunk->offset, chunk->size);
+        delete chunk;
+      },
+      new MappedChunk{ file, offset, size }),
+  };
+  return ByteBuffer(slices, 2);
+}
+
+/// Upload of a file, its metadata then its chunks being written one after the other as gRPC is ready for them
+///
+/// Client streaming calls are bidirectional streaming calls for which the server sends a single response, the reactor
+/// reads it while writing.
+class AttachmentUpload : public ::grpc::ClientBidiReactor<ByteBuffer, ByteBuffer>
+{
+ public:
+  AttachmentUpload(std::shared_ptr<MappedFile> file, const AttachmentUploadRequest& metadataRequest)
+    : mFile(std::move(file))
+  {
+    Slice metadata(metadataRequest.SerializeAsString());
+    mRequest = ByteBuffer(&metadata, 1);
+  }
+
+  /// Start the call on the given stub and wait for its completion
+  ::grpc::Status run(::grpc::GenericStub& stub, ClientContext* context)
+  {
+    stub.PrepareBidiStreamingCall(context, UPLOAD_ATTACHMENT_METHOD, {}, this);
+    StartRead(&mResponse);
+    StartWrite(&mRequest);
+    StartCall();
+
+    std::unique_lock<std::mutex> lock(mMutex);
+    mDoneCondition.wait(lock, [this]() { return mDone; });
+    return mStatus;
+  }
+
+  const ByteBuffer& response() const { return mResponse; }
+
+  void OnWriteDone(bool ok) override
+  {
+    if (!ok) {
+      // The call failed or the server answered early, OnDone gets its status
+      return;
+    }
+    if (mOffset == mFile->size()) {
+      StartWritesDone();
+      return;
+    }
+    auto size = std::min(ATTACHMENT_CHUNK_SIZE, mFile->size() - mOffset);
+    mRequest = chunkMessage(mFile, mOffset, size);
+    mOffset += size;
+    StartWrite(&mRequest);
+  }
+
+  void OnReadDone(bool) override {}
+
+  void OnDone(const ::grpc::Status& status) override
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mStatus = status;
+    mDone = true;
+    mDoneCondition.notify_one();
+  }
+
+ private:
+  std::shared_ptr<MappedFile> mFile;
+  size_t mOffset = 0;
+  ByteBuffer mRequest;
+  ByteBuffer mResponse;
+  std::mutex mMutex;
+  std::condition_variable mDoneCondition;
+  bool mDone = false;
+  ::grpc::Status mStatus;
+};
+
+std::string baseName(const std::string& path)
+{
+  auto separator = path.find_last_of('/');
+  return separator == std::string::npos ? path : path.substr(separator + 1);
+}
+} // namespace
+
+GrpcLogServiceClient::GrpcLogServiceClient(const std::vector<std::shared_ptr<::grpc::ChannelInterface>>& channels, std::unique_ptr<GrpcCallExecutor> callExecutor)
+  : mChannels(channels), mStubs(channels), mCallExecutor(std::move(callExecutor))
+{
+}
+
+int GrpcLogServiceClient::createLog(std::string title, std::string text, std::vector<int> runNumbers, std::optional<int> parentLogId)
+{
+  auto request = createLogCreationRequest(std::move(title), std::move(text), runNumbers, parentLogId);
+  Log log;
+
+  mCallExecutor->execute("Create", [&](ClientContext* context, size_t endpoint) { return mStubs[endpoint]->Create(context, request, &log); }, RetryEndpoint::FIRST);
+  return log.id();
+}
+
+void GrpcLogServiceClient::createLogAsync(std::string title, std::string text, std::vector<int> runNumbers, std::optional<int> parentLogId, ResultCompletion<int> onDone)
+{
+  auto messages = std::make_shared<CallMessages<LogCreationRequest, Log>>();
+  messages->request = createLogCreationRequest(std::move(title), std::move(text), runNumbers, parentLogId);
+
+  mCallExecutor->executeAsync(
+    "Create",
+    [this, messages](ClientContext* context, size_t endpoint, std::function<void(::grpc::Status)> onStatus) {
+      mStubs[endpoint]->async()->Create(context, &messages->request, &messages->response, std::move(onStatus));
+    },
+    [messages, onDone = std::move(onDone)](std::exception_ptr error) { onDone(error ? 0 : messages->response.id(), error); },
+    RetryEndpoint::FIRST);
+}
+
+int GrpcLogServiceClient::uploadAttachment(int logId, const std::string& filePath, const std::string& mimeType)
+{
+  auto file = std::make_shared<MappedFile>(filePath);
+
+  AttachmentUploadRequest metadataRequest;
+  auto metadata = metadataRequest.mutable_metadata();
+  metadata->set_logid(logId);
+  metadata->set_originalname(baseName(filePath));
+  metadata->set_mimetype(mimeType);
+
+  auto call = mCallExecutor->startStreaming("UploadAttachment", OnShutdown::DRAIN);
+  if (!call.has_value()) {
+    return 0;
+  }
+  ::grpc::GenericStub stub(mChannels[call->endpoint]);
+  AttachmentUpload upload(std::move(file), metadataRequest);
+  mCallExecutor->finishStreaming(*call, upload.run(stub, call->context.get()));
+
+  std::vector<Slice> slices;
+  upload.response().Dump(&slices);
+  std::string serializedAttachment;
+  for (const auto& slice : slices) {
+    serializedAttachment.append(reinterpret_cast<const char*>(slice.begin()), slice.size());
+  }
+  Attachment attachment;
+  if (!attachment.ParseFromString(serializedAttachment)) {
+    throw std::runtime_error("Invalid response to the upload of attachment " + filePath);
+  }
+  return attachment.id();
+}
+
+LogCreationRequest GrpcLogServiceClient::createLogCreationRequest(std::string title, std::string text, const std::vector<int>& runNumbers, std::optional<int> parentLogId)
+{
+  LogCreationRequest request;
+  request.set_title(std::move(title));
+  request.set_text(std::move(text));
+  for (auto runNumber : runNumbers) {
+    request.add_runnumbers(runNumber);
+  }
+  if (parentLogId.has_value()) {
+    request.set_parentlogid(*parentLogId);
+  }
+  request.set_idempotencykey(createIdempotencyKey());
+  return request;
+}
+} // namespace o2::bkp::api::grpc::services
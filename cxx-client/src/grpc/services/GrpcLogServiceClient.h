@@ -0,0 +1,50 @@
+//  Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+//  See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+//  All rights not expressly granted are reserved.
+//
+//  This software is distributed under the terms of the GNU General Public
+//  License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+//  In applying this license CERN does not waive the privileges and immunities
+//  granted to it by virtue of its status as an Intergovernmental Organization
+//  or submit itself to any jurisdiction.
+
+
+#ifndef CXX_CLIENT_BOOKKEEPINGAPI_GRPCLOGSERVICECLIENT_H
+#define CXX_CLIENT_BOOKKEEPINGAPI_GRPCLOGSERVICECLIENT_H
+
+#include "log.grpc.pb.h"
+#include "BookkeepingApi/LogServiceClient.h"
+#include "grpc/GrpcCallExecutor.h"
+
+#include <memory>
+
+namespace o2::bkp::api::grpc::services
+{
+
+class GrpcLogServiceClient : public LogServiceClient
+{
+ public:
+  explicit GrpcLogServiceClient(const std::vector<std::shared_ptr<::grpc::ChannelInterface>>& channels, std::unique_ptr<GrpcCallExecutor> callExecutor);
+  ~GrpcLogServiceClient() override = default;
+
+  int createLog(std::string title, std::string text, std::vector<int> runNumbers, std::optional<int> parentLogId) override;
+
+  void createLogAsync(std::string title, std::string text, std::vector<int> runNumbers, std::optional<int> parentLogId, ResultCompletion<int> onDone) override;
+
+  /// Return 0 if the upload was refused and handed to the circuit breaker fallback
+  int uploadAttachment(int logId, const std::string& filePath, const std::string& mimeType) override;
+
+ private:
+  static o2::bookkeeping::LogCreationRequest createLogCreationRequest(std::string title, std::string text, const std::vector<int>& runNumbers, std::optional<int> parentLogId);
+
+  /// Channel of each endpoint, the uploads go through a generic stub to send the file content without copying it
+  std::vector<std::shared_ptr<::grpc::ChannelInterface>> mChannels;
+  /// One stub per endpoint
+  LazyStubs<o2::bookkeeping::LogService> mStubs;
+  std::unique_ptr<GrpcCallExecutor> mCallExecutor;
+};
+
+} // namespace o2::bkp::api::grpc::services
+
+#endif // CXX_CLIENT_BOOKKEEPINGAPI_GRPCLOGSERVICECLIENT_H
@@ -10,6 +10,7 @@
 //  or submit itself to any jurisdiction.
 
 #include "GrpcQcFlagServiceClient.h"
+#include "grpc/IdempotencyKey.h"
 
 using grpc::ClientContext;
 
@@ -20,10 +21,10 @@ using o2::bookkeeping::SynchronousQcFlagCreationRequest;
 
 namespace o2::bkp::api::grpc::services
 {
-GrpcQcFlagServiceClient::GrpcQcFlagServiceClient(const std::shared_ptr<::grpc::ChannelInterface>& channel, const std::function<std::unique_ptr<::grpc::ClientContext> ()>& clientContextFactory)
+GrpcQcFlagServiceClient::GrpcQcFlagServiceClient(const std::vector<std::shared_ptr<::grpc::ChannelInterface>>& channels, std::unique_ptr<GrpcCallExecutor> callExecutor)
+  : mStubs(channels)
 {
-  mStub = o2::bookkeeping::QcFlagService::NewStub(channel);
-  mClientContextFactory = clientContextFactory;
+  mCallExecutor = std::move(callExecutor);
 }
 
 std::vector<int> grpc::services::GrpcQcFlagServiceClient::createForDataPass(
@@ -32,9 +33,107 @@ std::vector<int> grpc::services::GrpcQcFlagServiceClient::createForDataPass(
   const std::string& detectorName,
   const std::vector<QcFlag>& qcFlags)
 {
-  DataPassQcFlagCreationRequest request;
+  auto request = createDataPassRequest(runNumber, passName, detectorName, qcFlags);
+  QcFlagCreationResponse response;
+
+  mCallExecutor->execute("CreateForDataPass", [&](ClientContext* context, size_t endpoint) { return mStubs[endpoint]->CreateForDataPass(context, request, &response); }, RetryEndpoint::FIRST);
+
+  auto flagIds = response.flagids();
+  return { flagIds.begin(), flagIds.end() };
+}
+
+std::vector<int> grpc::services::GrpcQcFlagServiceClient::createForSimulationPass(
+  uint32_t runNumber,
+  const std::string& productionName,
+  const std::string& detectorName,
+  const std::vector<QcFlag>& qcFlags)
+{
+  auto request = createSimulationPassRequest(runNumber, productionName, detectorName, qcFlags);
+  QcFlagCreationResponse response;
+
+  mCallExecutor->execute("CreateForSimulationPass", [&](ClientContext* context, size_t endpoint) { return mStubs[endpoint]->CreateForSimulationPass(context, request, &response); }, RetryEndpoint::FIRST);
+
+  auto flagIds = response.flagids();
+  return { flagIds.begin(), flagIds.end() };
+}
+
+std::vector<int> grpc::services::GrpcQcFlagServiceClient::createForSynchronous(
+  uint32_t runNumber,
+  const std::string& detectorName,
+  const std::vector<QcFlag>& qcFlags)
+{
+  auto request = createSynchronousRequest(runNumber, detectorName, qcFlags);
   QcFlagCreationResponse response;
 
+  mCallExecutor->execute("CreateSynchronous", [&](ClientContext* context, size_t endpoint) { return mStubs[endpoint]->CreateSynchronous(context, request, &response); }, RetryEndpoint::FIRST);
+
+  auto flagIds = response.flagids();
+  return { flagIds.begin(), flagIds.end() };
+}
+
+void GrpcQcFlagServiceClient::createForDataPassAsync(
+  uint32_t runNumber,
+  const std::string& passName,
+  const std::string& detectorName,
+  const std::vector<QcFlag>& qcFlags,
+  ResultCompletion<std::vector<int>> onDone)
+{
+  auto messages = std::make_shared<CallMessages<DataPassQcFlagCreationRequest, QcFlagCreationResponse>>();
+  messages->request = createDataPassRequest(runNumber, passName, detectorName, qcFlags);
+
+  mCallExecutor->executeAsync(
+    "CreateForDataPass",
+    [this, messages](ClientContext* context, size_t endpoint, std::function<void(::grpc::Status)> onStatus) {
+      mStubs[endpoint]->async()->CreateForDataPass(context, &messages->request, &messages->response, std::move(onStatus));
+    },
+    completeWithFlagIds({ messages, &messages->response }, std::move(onDone)),
+    RetryEndpoint::FIRST);
+}
+
+void GrpcQcFlagServiceClient::createForSimulationPassAsync(
+  uint32_t runNumber,
+  const std::string& productionName,
+  const std::string& detectorName,
+  const std::vector<QcFlag>& qcFlags,
+  ResultCompletion<std::vector<int>> onDone)
+{
+  auto messages = std::make_shared<CallMessages<SimulationPassQcFlagCreationRequest, QcFlagCreationResponse>>();
+  messages->request = createSimulationPassRequest(runNumber, productionName, detectorName, qcFlags);
+
+  mCallExecutor->executeAsync(
+    "CreateForSimulationPass",
+    [this, messages](ClientContext* context, size_t endpoint, std::function<void(::grpc::Status)> onStatus) {
+      mStubs[endpoint]->async()->CreateForSimulationPass(context, &messages->request, &messages->response, std::move(onStatus));
+    },
+    completeWithFlagIds({ messages, &messages->response }, std::move(onDone)),
+    RetryEndpoint::FIRST);
+}
+
+void GrpcQcFlagServiceClient::createForSynchronousAsync(
+  uint32_t runNumber,
+  const std::string& detectorName,
+  const std::vector<QcFlag>& qcFlags,
+  ResultCompletion<std::vector<int>> onDone)
+{
+  auto messages = std::make_shared<CallMessages<SynchronousQcFlagCreationRequest, QcFlagCreationResponse>>();
+  messages->request = createSynchronousRequest(runNumber, detectorName, qcFlags);
+
+  mCallExecutor->executeAsync(
+    "CreateSynchronous",
+    [this, messages](ClientContext* context, size_t endpoint, std::function<void(::grpc::Status)> onStatus) {
+      mStubs[endpoint]->async()->CreateSynchronous(context, &messages->request, &messages->response, std::move(onStatus));
+    },
+    completeWithFlagIds({ messages, &messages->response }, std::move(onDone)),
+    RetryEndpoint::FIRST);
+}
+
+DataPassQcFlagCreationRequest GrpcQcFlagServiceClient::createDataPassRequest(
+  uint32_t runNumber,
+  const std::string& passName,
+  const std::string& detectorName,
+  const std::vector<QcFlag>& qcFlags)
+{
+  DataPassQcFlagCreationRequest request;
   request.set_runnumber(runNumber);
   request.set_passname(passName);
   request.set_detectorname(detectorName);
@@ -43,26 +142,17 @@ std::vector<int> grpc::services::GrpcQcFlagServiceClient::createForDataPass(
     auto grpcQcFlag = request.add_flags();
     mirrorQcFlagOnGrpcQcFlag(qcFlag, grpcQcFlag);
   }
-
-  auto context = mClientContextFactory();
-  auto status = mStub->CreateForDataPass(context.get(), request, &response);
-  if (!status.ok()) {
-    throw std::runtime_error(status.error_message());
-  }
-
-  auto flagIds = response.flagids();
-  return { flagIds.begin(), flagIds.end() };
+  request.set_idempotencykey(createIdempotencyKey());
+  return request;
 }
 
-std::vector<int> grpc::services::GrpcQcFlagServiceClient::createForSimulationPass(
+SimulationPassQcFlagCreationRequest GrpcQcFlagServiceClient::createSimulationPassRequest(
   uint32_t runNumber,
   const std::string& productionName,
   const std::string& detectorName,
   const std::vector<QcFlag>& qcFlags)
 {
   SimulationPassQcFlagCreationRequest request;
-  QcFlagCreationResponse response;
-
   request.set_runnumber(runNumber);
   request.set_productionname(productionName);
   request.set_detectorname(detectorName);
@@ -71,25 +161,16 @@ std::vector<int> grpc::services::GrpcQcFlagServiceClient::createForSimulationPas
     auto grpcQcFlag = request.add_flags();
     mirrorQcFlagOnGrpcQcFlag(qcFlag, grpcQcFlag);
   }
-
-  auto context = mClientContextFactory();
-  auto status = mStub->CreateForSimulationPass(context.get(), request, &response);
-  if (!status.ok()) {
-    throw std::runtime_error(status.error_message());
-  }
-
-  auto flagIds = response.flagids();
-  return { flagIds.begin(), flagIds.end() };
+  request.set_idempotencykey(createIdempotencyKey());
+  return request;
 }
 
-std::vector<int> grpc::services::GrpcQcFlagServiceClient::createForSynchronous(
+SynchronousQcFlagCreationRequest GrpcQcFlagServiceClient::createSynchronousRequest(
   uint32_t runNumber,
   const std::string& detectorName,
   const std::vector<QcFlag>& qcFlags)
 {
   SynchronousQcFlagCreationRequest request;
-  QcFlagCreationResponse response;
-
   request.set_runnumber(runNumber);
   request.set_detectorname(detectorName);
 
@@ -97,15 +178,20 @@ std::vector<int> grpc::services::GrpcQcFlagServiceClient::createForSynchronous(
     auto grpcQcFlag = request.add_flags();
     mirrorQcFlagOnGrpcQcFlag(qcFlag, grpcQcFlag);
   }
+  request.set_idempotencykey(createIdempotencyKey());
+  return request;
+}
 
-  auto context = mClientContextFactory();
-  auto status = mStub->CreateSynchronous(context.get(), request, &response);
-  if (!status.ok()) {
-    throw std::runtime_error(status.error_message());
-  }
-
-  auto flagIds = response.flagids();
-  return { flagIds.begin(), flagIds.end() };
+Completion GrpcQcFlagServiceClient::completeWithFlagIds(std::shared_ptr<const QcFlagCreationResponse> response, ResultCompletion<std::vector<int>> onDone)
+{
+  return [response = std::move(response), onDone = std::move(onDone)](std::exception_ptr error) {
+    if (error) {
+      onDone({}, error);
+      return;
+    }
+    const auto& flagIds = response->flagids();
+    onDone({ flagIds.begin(), flagIds.end() }, nullptr);
+  };
 }
 
 void GrpcQcFlagServiceClient::mirrorQcFlagOnGrpcQcFlag(const QcFlag& qcFlag, bookkeeping::QcFlag* grpcQcFlag)
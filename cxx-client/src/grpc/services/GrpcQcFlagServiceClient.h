@@ -18,6 +18,7 @@
 #include <memory>
 #include "qcFlag.grpc.pb.h"
 #include "BookkeepingApi/QcFlagServiceClient.h"
+#include "grpc/GrpcCallExecutor.h"
 
 namespace o2::bkp::api::grpc::services
 {
@@ -25,14 +26,25 @@ namespace o2::bkp::api::grpc::services
 class GrpcQcFlagServiceClient : public QcFlagServiceClient
 {
  public:
-  explicit GrpcQcFlagServiceClient(const std::shared_ptr<::grpc::ChannelInterface>& channel, const std::function<std::unique_ptr<::grpc::ClientContext> ()>& clientContextFactory);
+  explicit GrpcQcFlagServiceClient(const std::vector<std::shared_ptr<::grpc::ChannelInterface>>& channels, std::unique_ptr<GrpcCallExecutor> callExecutor);
   ~GrpcQcFlagServiceClient() override = default;
 
   std::vector<int> createForDataPass(uint32_t runNumber, const std::string& passName, const std::string& detectorName, const std::vector<QcFlag>& qcFlags) override;
   std::vector<int> createForSimulationPass(uint32_t runNumber, const std::string& productionName, const std::string& detectorName, const std::vector<QcFlag>& qcFlags) override;
   std::vector<int> createForSynchronous(uint32_t runNumber, const std::string& detectorName, const std::vector<QcFlag>& qcFlags) override;
 
+  void createForDataPassAsync(uint32_t runNumber, const std::string& passName, const std::string& detectorName, const std::vector<QcFlag>& qcFlags, ResultCompletion<std::vector<int>> onDone) override;
+  void createForSimulationPassAsync(uint32_t runNumber, const std::string& productionName, const std::string& detectorName, const std::vector<QcFlag>& qcFlags, ResultCompletion<std::vector<int>> onDone) override;
+  void createForSynchronousAsync(uint32_t runNumber, const std::string& detectorName, const std::vector<QcFlag>& qcFlags, ResultCompletion<std::vector<int>> onDone) override;
+
  private:
+  static o2::bookkeeping::DataPassQcFlagCreationRequest createDataPassRequest(uint32_t runNumber, const std::string& passName, const std::string& detectorName, const std::vector<QcFlag>& qcFlags);
+  static o2::bookkeeping::SimulationPassQcFlagCreationRequest createSimulationPassRequest(uint32_t runNumber, const std::string& productionName, const std::string& detectorName, const std::vector<QcFlag>& qcFlags);
+  static o2::bookkeeping::SynchronousQcFlagCreationRequest createSynchronousRequest(uint32_t runNumber, const std::string& detectorName, const std::vector<QcFlag>& qcFlags);
+
+  /// Wrap a flags ids completion into the completion of the call filling the given response
+  static Completion completeWithFlagIds(std::shared_ptr<const o2::bookkeeping::QcFlagCreationResponse> response, ResultCompletion<std::vector<int>> onDone);
+
   /**
    * Apply all the properties of a given o2::bkp::QcFlag to an existing o2::bookkeeping::QcFlag
    *
@@ -41,8 +53,9 @@ class GrpcQcFlagServiceClient : public QcFlagServiceClient
    */
   static void mirrorQcFlagOnGrpcQcFlag(const QcFlag& qcFlag, bookkeeping::QcFlag* grpcQcFlag);
 
-  std::unique_ptr<o2::bookkeeping::QcFlagService::Stub> mStub;
-  std::function<std::unique_ptr<::grpc::ClientContext> ()> mClientContextFactory;
+  /// One stub per endpoint
+  LazyStubs<o2::bookkeeping::QcFlagService> mStubs;
+  std::unique_ptr<GrpcCallExecutor> mCallExecutor;
 };
 
 } // namespace o2::bkp::api::grpc::services
@@ -11,32 +11,274 @@
 //
 
 #include "GrpcRunServiceClient.h"
+#include "grpc/GrpcSubscription.h"
 
 #include <memory>
+#include <stdexcept>
 
 using grpc::ClientContext;
+using grpc::ClientReader;
 
+using o2::bookkeeping::RunFetchRequest;
 using o2::bookkeeping::RunUpdateRequest;
-using o2::bookkeeping::Run;
+using o2::bookkeeping::LastRunWatchRequest;
+using o2::bookkeeping::RunsFetchRequest;
+using o2::bookkeeping::RunWithRelations;
 
 namespace o2::bkp::api::grpc::services
 {
-GrpcRunServiceClient::GrpcRunServiceClient(const std::shared_ptr<::grpc::ChannelInterface>& channel, const std::function<std::unique_ptr<::grpc::ClientContext> ()>& clientContextFactory)
+namespace
 {
-  mStub = o2::bookkeeping::RunService::NewStub(channel);
-  mClientContextFactory = clientContextFactory;
+/// Runs read from a GetMany server stream
+class GrpcRunStream : public RunStream
+{
+ public:
+  GrpcRunStream(GrpcCallExecutor* callExecutor, GrpcCallExecutor::StreamingCall call, std::unique_ptr<ClientReader<RunWithRelations>> reader)
+    : mCallExecutor(callExecutor), mCall(std::move(call)), mReader(std::move(reader))
+  {
+  }
+
+  ~GrpcRunStream() override
+  {
+    if (!mReader) {
+      return;
+    }
+    // Stopped before its end: the server does not need to fetch the remaining runs
+    mCall.context->TryCancel();
+    try {
+      mCallExecutor->finishStreaming(mCall, mReader->Finish());
+    } catch (...) {
+      // Cancelled on purpose, not a failure to report
+    }
+  }
+
+  bool next(api::Run& run) override
+  {
+    if (!mReader) {
+      return false;
+    }
+    if (mReader->Read(&mRunWithRelations)) {
+      run = GrpcRunServiceClient::fromGrpcRun(mRunWithRelations);
+      return true;
+    }
+    auto reader = std::move(mReader);
+    mCallExecutor->finishStreaming(mCall, reader->Finish());
+    return false;
+  }
+
+ private:
+  GrpcCallExecutor* mCallExecutor;
+  GrpcCallExecutor::StreamingCall mCall;
+  std::unique_ptr<ClientReader<RunWithRelations>> mReader;
+  /// Reused for all the runs, to keep the memory allocated by the previous ones
+  RunWithRelations mRunWithRelations;
+};
+
+/// Name of the field of the gRPC Run message holding the given field
+const char* grpcFieldName(RunField field)
+{
+  switch (field) {
+    case RunField::ENVIRONMENT_ID:
+      return "environmentId";
+    case RunField::RUN_TYPE:
+      return "runType";
+    case RunField::RUN_QUALITY:
+      return "runQuality";
+    case RunField::TIME_O2_START:
+      return "timeO2Start";
+    case RunField::TIME_O2_END:
+      return "timeO2End";
+    case RunField::TIME_TRG_START:
+      return "timeTrgStart";
+    case RunField::TIME_TRG_END:
+      return "timeTrgEnd";
+    case RunField::TRIGGER_VALUE:
+      return "triggerValue";
+    case RunField::LHC_PERIOD:
+      return "lhcPeriod";
+    case RunField::PDP_BEAM_TYPE:
+      return "pdpBeamType";
+    case RunField::N_DETECTORS:
+      return "nDetectors";
+    case RunField::N_FLPS:
+      return "nFlps";
+    case RunField::N_EPNS:
+      return "nEpns";
+    case RunField::DETECTORS:
+      return "detectors";
+  }
+  throw std::invalid_argument("Unknown run field");
+}
+
+std::string removePrefix(const std::string& name, const std::string& prefix)
+{
+  return name.compare(0, prefix.size(), prefix) == 0 ? name.substr(prefix.size()) : name;
+}
+} // namespace
+
+GrpcRunServiceClient::GrpcRunServiceClient(const std::vector<std::shared_ptr<::grpc::ChannelInterface>>& channels, std::unique_ptr<GrpcCallExecutor> callExecutor)
+  : mStubs(channels)
+{
+  mCallExecutor = std::move(callExecutor);
 }
 void GrpcRunServiceClient::setRawCtpTriggerConfiguration(int runNumber, std::string rawCtpTriggerConfiguration) {
-  RunUpdateRequest updateRequest{};
-  Run updatedRun;
+  auto updateRequest = createRawCtpTriggerConfigurationUpdateRequest(runNumber, rawCtpTriggerConfiguration);
+  o2::bookkeeping::Run updatedRun;
 
-  updateRequest.set_runnumber(runNumber);
-  updateRequest.set_rawctptriggerconfiguration(rawCtpTriggerConfiguration);
+  mCallExecutor->execute("Update", [&](ClientContext* context, size_t endpoint) { return mStubs[endpoint]->Update(context, updateRequest, &updatedRun); });
+}
+
+void GrpcRunServiceClient::setRawCtpTriggerConfigurationAsync(int runNumber, std::string rawCtpTriggerConfiguration, Completion onDone)
+{
+  auto messages = std::make_shared<CallMessages<RunUpdateRequest, o2::bookkeeping::Run>>();
+  messages->request = createRawCtpTriggerConfigurationUpdateRequest(runNumber, rawCtpTriggerConfiguration);
+
+  mCallExecutor->executeAsync(
+    "Update",
+    [this, messages](ClientContext* context, size_t endpoint, std::function<void(::grpc::Status)> onStatus) {
+      mStubs[endpoint]->async()->Update(context, &messages->request, &messages->response, std::move(onStatus));
+    },
+    std::move(onDone));
+}
+
+api::Run GrpcRunServiceClient::get(int runNumber, const std::vector<RunField>& fields, bool withLhcFill)
+{
+  auto request = createFetchRequest(runNumber, fields, withLhcFill);
+  RunWithRelations runWithRelations;
+
+  mCallExecutor->execute(
+    "Get",
+    [&](ClientContext* context, size_t endpoint) { return mStubs[endpoint]->Get(context, request, &runWithRelations); },
+    RetryEndpoint::ANY,
+    CallKind::READ);
+  return fromGrpcRun(runWithRelations);
+}
+
+void GrpcRunServiceClient::getAsync(int runNumber, std::vector<RunField> fields, bool withLhcFill, ResultCompletion<api::Run> onDone)
+{
+  auto messages = std::make_shared<CallMessages<RunFetchRequest, RunWithRelations>>();
+  messages->request = createFetchRequest(runNumber, fields, withLhcFill);
+
+  mCallExecutor->executeAsync(
+    "Get",
+    [this, messages](ClientContext* context, size_t endpoint, std::function<void(::grpc::Status)> onStatus) {
+      mStubs[endpoint]->async()->Get(context, &messages->request, &messages->response, std::move(onStatus));
+    },
+    [messages, onDone = std::move(onDone)](std::exception_ptr error) {
+      onDone(error ? api::Run{} : fromGrpcRun(messages->response), error);
+    },
+    RetryEndpoint::ANY,
+    CallKind::READ);
+}
 
-  auto context = mClientContextFactory();
-  auto status = mStub->Update(context.get(), updateRequest, &updatedRun);
-  if (!status.ok()) {
-    throw std::runtime_error(status.error_message());
+std::unique_ptr<RunStream> GrpcRunServiceClient::getMany(const RunsQuery& query)
+{
+  RunsFetchRequest request;
+  if (query.runNumberFrom.has_value()) {
+    request.set_runnumberfrom(*query.runNumberFrom);
+  }
+  if (query.runNumberTo.has_value()) {
+    request.set_runnumberto(*query.runNumberTo);
+  }
+  if (query.lhcPeriod.has_value()) {
+    request.set_lhcperiod(*query.lhcPeriod);
+  }
+  if (query.withLhcFill) {
+    request.add_relations(o2::bookkeeping::RUN_RELATIONS_LHC_FILL);
   }
+
+  // Never empty, as reads are not completed by the fallback
+  auto call = mCallExecutor->startStreaming("GetMany", OnShutdown::CANCEL, CallKind::READ);
+  auto reader = mStubs[call->endpoint]->GetMany(call->context.get(), request);
+  return std::make_unique<GrpcRunStream>(mCallExecutor.get(), std::move(*call), std::move(reader));
+}
+
+std::unique_ptr<Subscription<api::Run>> GrpcRunServiceClient::watchLast(bool withLhcFill, OnChange<api::Run> onChange)
+{
+  LastRunWatchRequest request;
+  if (withLhcFill) {
+    request.add_relations(o2::bookkeeping::RUN_RELATIONS_LHC_FILL);
+  }
+
+  return std::make_unique<GrpcSubscription<api::Run, RunWithRelations>>(
+    mCallExecutor.get(),
+    "Watch",
+    [this, request](ClientContext* context, size_t endpoint) { return mStubs[endpoint]->Watch(context, request); },
+    &GrpcRunServiceClient::fromGrpcRun,
+    std::move(onChange));
+}
+
+api::Run GrpcRunServiceClient::fromGrpcRun(const RunWithRelations& runWithRelations)
+{
+  const auto& grpcRun = runWithRelations.run();
+  api::Run run;
+  run.runNumber = grpcRun.runnumber();
+  if (grpcRun.has_environmentid()) {
+    run.environmentId = grpcRun.environmentid();
+  }
+  if (grpcRun.has_runtype() && grpcRun.runtype() != o2::bookkeeping::RUN_TYPE_NULL) {
+    run.runType = removePrefix(o2::bookkeeping::RunType_Name(grpcRun.runtype()), "RUN_TYPE_");
+  }
+  if (grpcRun.runquality() != o2::bookkeeping::RUN_QUALITY_NULL) {
+    run.runQuality = removePrefix(o2::bookkeeping::RunQuality_Name(grpcRun.runquality()), "RUN_QUALITY_");
+  }
+  if (grpcRun.has_timeo2start()) {
+    run.timeO2Start = grpcRun.timeo2start();
+  }
+  if (grpcRun.has_timeo2end()) {
+    run.timeO2End = grpcRun.timeo2end();
+  }
+  if (grpcRun.has_timetrgstart()) {
+    run.timeTrgStart = grpcRun.timetrgstart();
+  }
+  if (grpcRun.has_timetrgend()) {
+    run.timeTrgEnd = grpcRun.timetrgend();
+  }
+  if (grpcRun.has_triggervalue()) {
+    run.triggerValue = grpcRun.triggervalue();
+  }
+  if (grpcRun.has_lhcperiod()) {
+    run.lhcPeriod = grpcRun.lhcperiod();
+  }
+  if (grpcRun.has_pdpbeamtype()) {
+    run.pdpBeamType = grpcRun.pdpbeamtype();
+  }
+  if (grpcRun.has_ndetectors()) {
+    run.nDetectors = grpcRun.ndetectors();
+  }
+  if (grpcRun.has_nflps()) {
+    run.nFlps = grpcRun.nflps();
+  }
+  if (grpcRun.has_nepns()) {
+    run.nEpns = grpcRun.nepns();
+  }
+  for (auto detector : grpcRun.detectors()) {
+    run.detectors.push_back(removePrefix(o2::bookkeeping::Detector_Name(static_cast<o2::bookkeeping::Detector>(detector)), "DETECTOR_"));
+  }
+  if (runWithRelations.has_lhcfill()) {
+    run.fillNumber = runWithRelations.lhcfill().fillnumber();
+  }
+  return run;
+}
+
+RunFetchRequest GrpcRunServiceClient::createFetchRequest(int runNumber, const std::vector<RunField>& fields, bool withLhcFill)
+{
+  RunFetchRequest request;
+  request.set_runnumber(runNumber);
+  for (auto field : fields) {
+    request.add_fields(grpcFieldName(field));
+  }
+  if (withLhcFill) {
+    request.add_relations(o2::bookkeeping::RUN_RELATIONS_LHC_FILL);
+  }
+  return request;
+}
+
+RunUpdateRequest GrpcRunServiceClient::createRawCtpTriggerConfigurationUpdateRequest(int runNumber, const std::string& rawCtpTriggerConfiguration)
+{
+  RunUpdateRequest updateRequest{};
+  updateRequest.set_runnumber(runNumber);
+  updateRequest.set_rawctptriggerconfiguration(rawCtpTriggerConfiguration);
+  return updateRequest;
 }
 } // namespace o2::bkp::api::grpc::services
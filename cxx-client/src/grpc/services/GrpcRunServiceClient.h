@@ -15,6 +15,7 @@
 
 #include "run.grpc.pb.h"
 #include "BookkeepingApi/RunServiceClient.h"
+#include "grpc/GrpcCallExecutor.h"
 
 #include <memory>
 
@@ -24,14 +25,32 @@ namespace o2::bkp::api::grpc::services
 class GrpcRunServiceClient : public RunServiceClient
 {
  public:
-  explicit GrpcRunServiceClient(const std::shared_ptr<::grpc::ChannelInterface>& channel, const std::function<std::unique_ptr<::grpc::ClientContext> ()>& clientContextFactory);
+  explicit GrpcRunServiceClient(const std::vector<std::shared_ptr<::grpc::ChannelInterface>>& channels, std::unique_ptr<GrpcCallExecutor> callExecutor);
   ~GrpcRunServiceClient() override = default;
 
   void setRawCtpTriggerConfiguration(int runNumber, std::string rawCtpTriggerConfiguration) override;
 
+  void setRawCtpTriggerConfigurationAsync(int runNumber, std::string rawCtpTriggerConfiguration, Completion onDone) override;
+
+  api::Run get(int runNumber, const std::vector<RunField>& fields, bool withLhcFill) override;
+
+  void getAsync(int runNumber, std::vector<RunField> fields, bool withLhcFill, ResultCompletion<api::Run> onDone) override;
+
+  std::unique_ptr<RunStream> getMany(const RunsQuery& query) override;
+
+  std::unique_ptr<Subscription<api::Run>> watchLast(bool withLhcFill, OnChange<api::Run> onChange) override;
+
+  /// Convert a run received from bookkeeping to its API representation
+  static api::Run fromGrpcRun(const o2::bookkeeping::RunWithRelations& runWithRelations);
+
  private:
-  std::unique_ptr<o2::bookkeeping::RunService::Stub> mStub;
-  std::function<std::unique_ptr<::grpc::ClientContext> ()> mClientContextFactory;
+  static o2::bookkeeping::RunFetchRequest createFetchRequest(int runNumber, const std::vector<RunField>& fields, bool withLhcFill);
+
+  static o2::bookkeeping::RunUpdateRequest createRawCtpTriggerConfigurationUpdateRequest(int runNumber, const std::string& rawCtpTriggerConfiguration);
+
+  /// One stub per endpoint
+  LazyStubs<o2::bookkeeping::RunService> mStubs;
+  std::unique_ptr<GrpcCallExecutor> mCallExecutor;
 };
 
 } // namespace o2::bkp::api::grpc::services
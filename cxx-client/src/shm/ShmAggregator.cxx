@@ -0,0 +1,261 @@
+//  Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+//  See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+//  All rights not expressly granted are reserved.
+//
+//  This software is distributed under the terms of the GNU General Public
+//  License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+//  In applying this license CERN does not waive the privileges and immunities
+//  granted to it by virtue of its status as an Intergovernmental Organization
+//  or submit itself to any jurisdiction.
+
+#include "ShmAggregator.h"
+
+#include <iostream>
+#include <thread>
+#include <grpc++/grpc++.h>
+
+using grpc::ClientContext;
+using grpc::CreateChannel;
+using grpc::InsecureChannelCredentials;
+using grpc::Status;
+using o2::bookkeeping::CtpTriggerCounterCreateOrUpdateRequest;
+using o2::bookkeeping::DplProcessExecutionCreationRequest;
+using o2::bookkeeping::RunUpdateRequest;
+using o2::bookkeeping::UpdateCountersRequest;
+
+namespace o2::bkp::api::shm
+{
+namespace
+{
+/// Pause between two polls of an empty ring
+constexpr std::chrono::milliseconds IDLE_POLL_INTERVAL{ 1 };
+
+/// Forwarded requests waiting for their answer at a time, so that a flush does not flood the server
+constexpr size_t MAX_FORWARDS_IN_FLIGHT = 32;
+
+/// Messages of a forwarded request, alive until its call completed
+template <typename Request, typename Response>
+struct ForwardMessages {
+  Request request;
+  Response response;
+};
+} // namespace
+
+ShmAggregator::ShmAggregator(
+  ShmRingBuffer ring,
+  const std::string& uri,
+  const std::function<std::unique_ptr<ClientContext>()>& clientContextFactory,
+  std::chrono::milliseconds flushInterval)
+  : mRing(std::move(ring)), mClientContextFactory(clientContextFactory), mFlushInterval(flushInterval)
+{
+  auto channel = CreateChannel(uri, InsecureChannelCredentials());
+
+  mFlpStub = o2::bookkeeping::FlpService::NewStub(channel);
+  mCtpTriggerCountersStub = o2::bookkeeping::CtpTriggerCountersService::NewStub(channel);
+  mDplProcessExecutionStub = o2::bookkeeping::DplProcessExecutionService::NewStub(channel);
+  mRunStub = o2::bookkeeping::RunService::NewStub(channel);
+}
+
+ShmAggregator::~ShmAggregator()
+{
+  waitForForwards();
+}
+
+void ShmAggregator::run(const std::atomic<bool>& stopRequested)
+{
+  auto nextFlush = std::chrono::steady_clock::now() + mFlushInterval;
+  while (!stopRequested.load(std::memory_order_relaxed)) {
+    auto readRecords = drain();
+    if (std::chrono::steady_clock::now() >= nextFlush) {
+      flush();
+      nextFlush = std::chrono::steady_clock::now() + mFlushInterval;
+    } else if (readRecords == 0) {
+      std::this_thread::sleep_for(IDLE_POLL_INTERVAL);
+    }
+  }
+
+  drain();
+  flush();
+  waitForForwards();
+}
+
+ShmAggregatorStatistics ShmAggregator::statistics() const
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  return mStatistics;
+}
+
+size_t ShmAggregator::drain()
+{
+  size_t readRecords = 0;
+  ShmRecordType type;
+  std::string payload;
+  while (mRing.tryPop(type, payload)) {
+    aggregate(type, payload);
+    readRecords++;
+  }
+  std::lock_guard<std::mutex> lock(mMutex);
+  mStatistics.dropped = mRing.droppedRecords();
+  return readRecords;
+}
+
+void ShmAggregator::aggregate(ShmRecordType type, const std::string& payload)
+{
+  // Only the statistics are shared with the gRPC threads, the pending requests belong to the drain loop
+  std::lock_guard<std::mutex> lock(mMutex);
+  mStatistics.received++;
+  switch (type) {
+    case ShmRecordType::FlpUpdateCounters: {
+      UpdateCountersRequest request;
+      if (request.ParseFromString(payload)) {
+        auto [iterator, inserted] = mPendingFlpCounters.insert_or_assign({ request.flpname(), request.runnumber() }, std::move(request));
+        mStatistics.coalesced += inserted ? 0 : 1;
+        return;
+      }
+      break;
+    }
+    case ShmRecordType::CtpTriggerCountersCreateOrUpdate: {
+      CtpTriggerCounterCreateOrUpdateRequest request;
+      if (request.ParseFromString(payload)) {
+        auto [iterator, inserted] = mPendingCtpTriggerCounters.insert_or_assign({ request.runnumber(), request.classname() }, std::move(request));
+        mStatistics.coalesced += inserted ? 0 : 1;
+        return;
+      }
+      break;
+    }
+    case ShmRecordType::DplProcessExecutionCreate: {
+      DplProcessExecutionCreationRequest request;
+      if (request.ParseFromString(payload)) {
+        mPendingDplProcessExecutions.push_back(std::move(request));
+        return;
+      }
+      break;
+    }
+    case ShmRecordType::RunUpdate: {
+      RunUpdateRequest request;
+      if (request.ParseFromString(payload)) {
+        auto [iterator, inserted] = mPendingRunUpdates.try_emplace(request.runnumber(), request);
+        if (!inserted) {
+          // Fields set by the latest update override the previous ones
+          iterator->second.MergeFrom(request);
+          mStatistics.coalesced++;
+        }
+        return;
+      }
+      break;
+    }
+  }
+
+  mStatistics.failed++;
+  std::cerr << "Ignoring malformed shared memory record of type " << static_cast<uint32_t>(type) << std::endl;
+}
+
+void ShmAggregator::flush()
+{
+  // All the requests of a flush must be answered before the next one, which supersedes the counters anyway
+  auto deadline = std::chrono::system_clock::now() + mFlushInterval;
+
+  // Run updates and processes registration first, they are started before the counters
+  for (auto& [runNumber, request] : mPendingRunUpdates) {
+    auto messages = std::make_shared<ForwardMessages<RunUpdateRequest, o2::bookkeeping::Run>>();
+    messages->request = std::move(request);
+    forward("run update", deadline, [this, messages](ClientContext* context, std::function<void(Status)> onStatus) {
+      mRunStub->async()->Update(context, &messages->request, &messages->response, std::move(onStatus));
+    });
+  }
+  mPendingRunUpdates.clear();
+
+  for (auto& request : mPendingDplProcessExecutions) {
+    auto messages = std::make_shared<ForwardMessages<DplProcessExecutionCreationRequest, o2::bookkeeping::DplProcessExecution>>();
+    messages->request = std::move(request);
+    forward("DPL process execution", deadline, [this, messages](ClientContext* context, std::function<void(Status)> onStatus) {
+      mDplProcessExecutionStub->async()->Create(context, &messages->request, &messages->response, std::move(onStatus));
+    });
+  }
+  mPendingDplProcessExecutions.clear();
+
+  for (auto& [key, request] : mPendingFlpCounters) {
+    auto messages = std::make_shared<ForwardMessages<UpdateCountersRequest, o2::bookkeeping::Flp>>();
+    messages->request = std::move(request);
+    forward("FLP counters", deadline, [this, messages](ClientContext* context, std::function<void(Status)> onStatus) {
+      mFlpStub->async()->UpdateCounters(context, &messages->request, &messages->response, std::move(onStatus));
+    });
+  }
+  mPendingFlpCounters.clear();
+
+  for (auto& [key, request] : mPendingCtpTriggerCounters) {
+    auto messages = std::make_shared<ForwardMessages<CtpTriggerCounterCreateOrUpdateRequest, o2::bookkeeping::Empty>>();
+    messages->request = std::move(request);
+    forward("CTP trigger counters", deadline, [this, messages](ClientContext* context, std::function<void(Status)> onStatus) {
+      mCtpTriggerCountersStub->async()->CreateOrUpdateForRun(context, &messages->request, &messages->response, std::move(onStatus));
+    });
+  }
+  mPendingCtpTriggerCounters.clear();
+
+  startQueuedForwards();
+}
+
+void ShmAggregator::forward(const char* description, std::chrono::system_clock::time_point deadline, ForwardCall call)
+{
+  auto forward = std::make_shared<Forward>();
+  forward->description = description;
+  forward->deadline = deadline;
+  forward->call = std::move(call);
+  std::lock_guard<std::mutex> lock(mMutex);
+  mQueuedForwards.push_back(std::move(forward));
+}
+
+void ShmAggregator::startQueuedForwards()
+{
+  std::vector<std::shared_ptr<Forward>> started;
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto now = std::chrono::system_clock::now();
+    while (!mQueuedForwards.empty() && mForwardsInFlight < MAX_FORWARDS_IN_FLIGHT) {
+      auto forward = std::move(mQueuedForwards.front());
+      mQueuedForwards.pop_front();
+      if (forward->deadline <= now) {
+        mStatistics.failed++;
+        std::cerr << "Failed to forward " << forward->description << ": not started before the end of its flush" << std::endl;
+        continue;
+      }
+      mForwardsInFlight++;
+      started.push_back(std::move(forward));
+    }
+    if (mQueuedForwards.empty() && mForwardsInFlight == 0) {
+      mForwardsDone.notify_all();
+    }
+  }
+
+  // Outside of the lock, as a call may complete right away
+  for (auto& forward : started) {
+    forward->context = mClientContextFactory();
+    forward->context->set_deadline(forward->deadline);
+    forward->call(forward->context.get(), [this, forward](Status status) { onForwarded(*forward, status); });
+  }
+}
+
+void ShmAggregator::onForwarded(Forward& forward, const Status& status)
+{
+  // The context holds the channel, which must not be released by this callback once the aggregator is destroyed
+  forward.context.reset();
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mForwardsInFlight--;
+    if (status.ok()) {
+      mStatistics.forwarded++;
+    } else {
+      mStatistics.failed++;
+      std::cerr << "Failed to forward " << forward.description << ": " << status.error_message() << std::endl;
+    }
+  }
+  startQueuedForwards();
+}
+
+void ShmAggregator::waitForForwards()
+{
+  std::unique_lock<std::mutex> lock(mMutex);
+  mForwardsDone.wait(lock, [this]() { return mQueuedForwards.empty() && mForwardsInFlight == 0; });
+}
+} // namespace o2::bkp::api::shm
@@ -0,0 +1,129 @@
+//  Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+//  See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+//  All rights not expressly granted are reserved.
+//
+//  This software is distributed under the terms of the GNU General Public
+//  License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+//  In applying this license CERN does not waive the privileges and immunities
+//  granted to it by virtue of its status as an Intergovernmental Organization
+//  or submit itself to any jurisdiction.
+
+#ifndef CXX_CLIENT_SHM_SHMAGGREGATOR_H
+#define CXX_CLIENT_SHM_SHMAGGREGATOR_H
+
+#include "shm/ShmRingBuffer.h"
+#include "flp.grpc.pb.h"
+#include "ctpTriggerCounters.grpc.pb.h"
+#include "dplProcessExecution.grpc.pb.h"
+#include "run.grpc.pb.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace o2::bkp::api::shm
+{
+/// Counters describing the activity of the aggregator
+struct ShmAggregatorStatistics {
+  uint64_t received = 0;
+  uint64_t coalesced = 0;
+  uint64_t forwarded = 0;
+  uint64_t failed = 0;
+  uint64_t dropped = 0;
+};
+
+/**
+ * Drain the records written by every process of the node in the shared memory ring and forward them to bookkeeping
+ * through a single gRPC channel
+ *
+ * Between two flushes, counters updates are coalesced (only the latest value per FLP/run or per run/class is kept) and
+ * successive updates of the same run are merged in a single request. The requests of a flush are forwarded without
+ * blocking the drain, a bounded number at a time, and must all be answered within the flush interval: those still
+ * waiting for their turn at the end of it are given up.
+ */
+class ShmAggregator
+{
+ public:
+  ShmAggregator(
+    ShmRingBuffer ring,
+    const std::string& uri,
+    const std::function<std::unique_ptr<::grpc::ClientContext>()>& clientContextFactory,
+    std::chrono::milliseconds flushInterval);
+
+  /// Wait for the forwarded requests still in flight
+  ~ShmAggregator();
+
+  ShmAggregator(const ShmAggregator&) = delete;
+  ShmAggregator& operator=(const ShmAggregator&) = delete;
+
+  /// Drain and forward records until stop is requested, then forward what is still pending and wait for the answers
+  void run(const std::atomic<bool>& stopRequested);
+
+  ShmAggregatorStatistics statistics() const;
+
+ private:
+  /// Move all the records currently available in the ring to the pending requests, return the amount of records read
+  size_t drain();
+
+  /// Start a gRPC call with the given context using the callback API, onStatus being called once it completed
+  using ForwardCall = std::function<void(::grpc::ClientContext* context, std::function<void(::grpc::Status)> onStatus)>;
+
+  /// Request of a flush waiting for its turn or in flight, owning the messages of its call
+  struct Forward {
+    const char* description;
+    std::chrono::system_clock::time_point deadline;
+    ForwardCall call;
+    std::unique_ptr<::grpc::ClientContext> context;
+  };
+
+  /// Queue all the pending requests to be forwarded before the end of the flush interval
+  void flush();
+
+  /// Store a record read from the ring, coalescing it with pending requests when it applies
+  void aggregate(ShmRecordType type, const std::string& payload);
+
+  /// Queue a single request, failures are reported but do not stop the aggregator
+  void forward(const char* description, std::chrono::system_clock::time_point deadline, ForwardCall call);
+
+  /// Start the queued requests while there is room in flight, giving up those whose flush is over
+  void startQueuedForwards();
+
+  /// Account for the status of a forwarded request and start the next ones
+  void onForwarded(Forward& forward, const ::grpc::Status& status);
+
+  /// Wait until no request is queued or in flight
+  void waitForForwards();
+
+  ShmRingBuffer mRing;
+  std::function<std::unique_ptr<::grpc::ClientContext>()> mClientContextFactory;
+  std::chrono::milliseconds mFlushInterval;
+
+  std::unique_ptr<o2::bookkeeping::FlpService::Stub> mFlpStub;
+  std::unique_ptr<o2::bookkeeping::CtpTriggerCountersService::Stub> mCtpTriggerCountersStub;
+  std::unique_ptr<o2::bookkeeping::DplProcessExecutionService::Stub> mDplProcessExecutionStub;
+  std::unique_ptr<o2::bookkeeping::RunService::Stub> mRunStub;
+
+  std::map<int32_t, o2::bookkeeping::RunUpdateRequest> mPendingRunUpdates;
+  std::vector<o2::bookkeeping::DplProcessExecutionCreationRequest> mPendingDplProcessExecutions;
+  std::map<std::pair<std::string, int32_t>, o2::bookkeeping::UpdateCountersRequest> mPendingFlpCounters;
+  std::map<std::pair<uint32_t, std::string>, o2::bookkeeping::CtpTriggerCounterCreateOrUpdateRequest> mPendingCtpTriggerCounters;
+
+  /// Protects the forwards and the statistics, updated from the gRPC threads
+  mutable std::mutex mMutex;
+  std::deque<std::shared_ptr<Forward>> mQueuedForwards;
+  size_t mForwardsInFlight = 0;
+  std::condition_variable mForwardsDone;
+  ShmAggregatorStatistics mStatistics;
+};
+} // namespace o2::bkp::api::shm
+
+#endif // CXX_CLIENT_SHM_SHMAGGREGATOR_H
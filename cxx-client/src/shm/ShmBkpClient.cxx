@@ -0,0 +1,90 @@
+//  Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+//  See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+//  All rights not expressly granted are reserved.
+//
+//  This software is distributed under the terms of the GNU General Public
+//  License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+//  In applying this license CERN does not waive the privileges and immunities
+//  granted to it by virtue of its status as an Intergovernmental Organization
+//  or submit itself to any jurisdiction.
+
+#include "ShmBkpClient.h"
+#include "shm/services/ShmFlpServiceClient.h"
+#include "shm/services/ShmDplProcessExecutionClient.h"
+#include "shm/services/ShmQcFlagServiceClient.h"
+#include "shm/services/ShmCtpTriggerCountersServiceClient.h"
+#include "shm/services/ShmRunServiceClient.h"
+
+using std::make_shared;
+using std::make_unique;
+using std::string;
+using std::unique_ptr;
+
+namespace o2::bkp::api::shm
+{
+using services::ShmCtpTriggerCountersServiceClient;
+using services::ShmDplProcessExecutionClient;
+using services::ShmFlpServiceClient;
+using services::ShmQcFlagServiceClient;
+using services::ShmRunServiceClient;
+
+ShmBkpClient::ShmBkpClient(const string& segmentName)
+{
+  mRing = make_shared<ShmRingBuffer>(ShmRingBuffer::open(segmentName));
+
+  mFlpClient = make_unique<ShmFlpServiceClient>(mRing);
+  mDplProcessExecutionClient = make_unique<ShmDplProcessExecutionClient>(mRing);
+  mQcFlagClient = make_unique<ShmQcFlagServiceClient>();
+  mCtpTriggerCountersClient = make_unique<ShmCtpTriggerCountersServiceClient>(mRing);
+  mRunClient = make_unique<ShmRunServiceClient>(mRing);
+  mLhcFillClient = make_unique<LhcFillServiceClient>();
+  mLogClient = make_unique<LogServiceClient>();
+  mEnvironmentClient = make_unique<EnvironmentServiceClient>();
+}
+
+const unique_ptr<FlpServiceClient>& ShmBkpClient::flp() const
+{
+  return mFlpClient;
+}
+
+const unique_ptr<DplProcessExecutionClient>& ShmBkpClient::dplProcessExecution() const
+{
+  return mDplProcessExecutionClient;
+}
+
+const unique_ptr<QcFlagServiceClient>& ShmBkpClient::qcFlag() const
+{
+  return mQcFlagClient;
+}
+
+const unique_ptr<CtpTriggerCountersServiceClient>& ShmBkpClient::ctpTriggerCounters() const
+{
+  return mCtpTriggerCountersClient;
+}
+
+const unique_ptr<CtpTriggerCountersServiceClient>& ShmBkpClient::triggerCounters() const
+{
+  return mCtpTriggerCountersClient;
+}
+
+const unique_ptr<RunServiceClient>& ShmBkpClient::run() const
+{
+  return mRunClient;
+}
+
+const unique_ptr<LhcFillServiceClient>& ShmBkpClient::lhcFill() const
+{
+  return mLhcFillClient;
+}
+
+const unique_ptr<LogServiceClient>& ShmBkpClient::log() const
+{
+  return mLogClient;
+}
+
+const unique_ptr<EnvironmentServiceClient>& ShmBkpClient::environment() const
+{
+  return mEnvironmentClient;
+}
+} // namespace o2::bkp::api::shm
@@ -0,0 +1,67 @@
+//  Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+//  See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+//  All rights not expressly granted are reserved.
+//
+//  This software is distributed under the terms of the GNU General Public
+//  License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+//  In applying this license CERN does not waive the privileges and immunities
+//  granted to it by virtue of its status as an Intergovernmental Organization
+//  or submit itself to any jurisdiction.
+
+#ifndef CXX_CLIENT_SHM_SHMBKPCLIENT_H
+#define CXX_CLIENT_SHM_SHMBKPCLIENT_H
+
+#include "BookkeepingApi/BkpClient.h"
+#include "shm/ShmRingBuffer.h"
+
+#include <memory>
+#include <string>
+
+namespace o2::bkp::api::shm
+{
+/// Implementation of BookkeepingClient writing records in a node-local shared memory ring drained by the aggregator daemon
+class ShmBkpClient : public o2::bkp::api::BkpClient
+{
+ public:
+  /// Attach to the ring of the given name, throw if the aggregator daemon did not create it
+  explicit ShmBkpClient(const std::string& segmentName);
+  ~ShmBkpClient() override = default;
+
+  const std::unique_ptr<FlpServiceClient>& flp() const override;
+
+  const std::unique_ptr<DplProcessExecutionClient>& dplProcessExecution() const override;
+
+  /// QC flags creation needs the created ids in response and is not available through the shared memory ring
+  const std::unique_ptr<QcFlagServiceClient>& qcFlag() const override;
+
+  /// @deprecated use `ctpTriggerCounters` instead
+  const std::unique_ptr<CtpTriggerCountersServiceClient>& triggerCounters() const override;
+
+  const std::unique_ptr<CtpTriggerCountersServiceClient>& ctpTriggerCounters() const override;
+
+  const std::unique_ptr<RunServiceClient>& run() const override;
+
+  /// Watching needs a stream from bookkeeping and is not available through the shared memory ring
+  const std::unique_ptr<LhcFillServiceClient>& lhcFill() const override;
+
+  /// Logs creation returns the created ids and is not available through the shared memory ring
+  const std::unique_ptr<LogServiceClient>& log() const override;
+
+  /// Environments creation and status updates are not forwarded through the shared memory ring
+  const std::unique_ptr<EnvironmentServiceClient>& environment() const override;
+
+ private:
+  std::shared_ptr<ShmRingBuffer> mRing;
+  std::unique_ptr<::o2::bkp::api::FlpServiceClient> mFlpClient;
+  std::unique_ptr<::o2::bkp::api::DplProcessExecutionClient> mDplProcessExecutionClient;
+  std::unique_ptr<::o2::bkp::api::QcFlagServiceClient> mQcFlagClient;
+  std::unique_ptr<::o2::bkp::api::CtpTriggerCountersServiceClient> mCtpTriggerCountersClient;
+  std::unique_ptr<::o2::bkp::api::RunServiceClient> mRunClient;
+  std::unique_ptr<::o2::bkp::api::LhcFillServiceClient> mLhcFillClient;
+  std::unique_ptr<::o2::bkp::api::LogServiceClient> mLogClient;
+  std::unique_ptr<::o2::bkp::api::EnvironmentServiceClient> mEnvironmentClient;
+};
+} // namespace o2::bkp::api::shm
+
+#endif // CXX_CLIENT_SHM_SHMBKPCLIENT_H
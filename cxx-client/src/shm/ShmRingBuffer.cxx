@@ -0,0 +1,303 @@
+//  Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+//  See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+//  All rights not expressly granted are reserved.
+//
+//  This software is distributed under the terms of the GNU General Public
+//  License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+//  In applying this license CERN does not waive the privileges and immunities
+//  granted to it by virtue of its status as an Intergovernmental Organization
+//  or submit itself to any jurisdiction.
+
+#include "ShmRingBuffer.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace o2::bkp::api::shm
+{
+namespace
+{
+constexpr uint64_t MAGIC = 0x4f32424b50524e47; // "O2BKPRNG"
+constexpr uint32_t VERSION = 2;
+
+size_t segmentSize(uint32_t slotCount, uint32_t slotSize)
+{
+  return sizeof(ShmRingHeader) + static_cast<size_t>(slotCount) * slotSize;
+}
+
+/// FNV-1a hash of a record and the position it was claimed at
+uint64_t recordChecksum(uint64_t claim, ShmRecordType type, const char* payload, size_t size)
+{
+  uint64_t hash = 0xcbf29ce484222325;
+  auto mix = [&hash](const char* data, size_t length) {
+    for (size_t index = 0; index < length; index++) {
+      hash = (hash ^ static_cast<unsigned char>(data[index])) * 0x100000001b3;
+    }
+  };
+  mix(reinterpret_cast<const char*>(&claim), sizeof(claim));
+  mix(reinterpret_cast<const char*>(&type), sizeof(type));
+  mix(payload, size);
+  return hash;
+}
+
+std::runtime_error systemError(const std::string& what, const std::string& name)
+{
+  return std::runtime_error(what + " shared memory segment " + name + ": " + std::strerror(errno));
+}
+
+/// Give access to the segment to its owner and to the given group only, whatever the umask
+void restrictAccess(int fd, const std::string& name, std::optional<gid_t> group)
+{
+  if (group.has_value() && fchown(fd, static_cast<uid_t>(-1), *group) != 0) {
+    throw systemError("Unable to set the group of", name);
+  }
+  if (fchmod(fd, group.has_value() ? 0660 : 0600) != 0) {
+    throw systemError("Unable to restrict the access to", name);
+  }
+}
+} // namespace
+
+ShmRingBuffer ShmRingBuffer::create(const std::string& name, uint32_t slotCount, uint32_t slotSize, std::chrono::milliseconds claimTimeout, std::optional<gid_t> group)
+{
+  if (slotCount == 0 || (slotCount & (slotCount - 1)) != 0) {
+    throw std::invalid_argument("shared memory ring slot count must be a power of two");
+  }
+  if (slotSize <= sizeof(ShmSlot) || slotSize % alignof(ShmSlot) != 0) {
+    throw std::invalid_argument("shared memory ring slot size must be a multiple of 8 larger than the slot header");
+  }
+
+  auto size = segmentSize(slotCount, slotSize);
+  auto fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd < 0 && errno == EEXIST) {
+    std::optional<ShmRingBuffer> previous;
+    try {
+      previous.emplace(open(name));
+    } catch (const std::runtime_error&) {
+      // Not a ring: replaced below
+    }
+    if (previous && previous->mSize == size && previous->mHeader->slotCount == slotCount && previous->mHeader->slotSize == slotSize) {
+      // Left by a previous daemon, its producers may still be writing to it
+      auto previousFd = shm_open(name.c_str(), O_RDWR, 0);
+      if (previousFd < 0) {
+        throw systemError("Unable to open", name);
+      }
+      try {
+        restrictAccess(previousFd, name, group);
+      } catch (...) {
+        close(previousFd);
+        throw;
+      }
+      close(previousFd);
+      previous->mClaimTimeout = claimTimeout;
+      return std::move(*previous);
+    }
+    previous.reset();
+
+    // Producers which have the previous segment mapped keep it, they reach the new one once they open it again
+    unlink(name);
+    fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  }
+  if (fd < 0) {
+    throw systemError("Unable to create", name);
+  }
+  try {
+    restrictAccess(fd, name, group);
+  } catch (...) {
+    close(fd);
+    throw;
+  }
+  if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+    close(fd);
+    throw systemError("Unable to size", name);
+  }
+  auto address = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (address == MAP_FAILED) {
+    throw systemError("Unable to map", name);
+  }
+
+  ShmRingBuffer ring(address, size);
+  ring.mClaimTimeout = claimTimeout;
+  auto header = ring.mHeader;
+  // Invalidate the segment while it is being initialized, writers check the magic before attaching
+  new (&header->magic) std::atomic<uint64_t>(0);
+  header->version = VERSION;
+  header->slotCount = slotCount;
+  header->slotSize = slotSize;
+  new (&header->writeIndex) std::atomic<uint64_t>(0);
+  new (&header->readIndex) std::atomic<uint64_t>(0);
+  new (&header->droppedRecords) std::atomic<uint64_t>(0);
+  for (uint64_t index = 0; index < slotCount; index++) {
+    new (&ring.slotAt(index)->sequence) std::atomic<uint64_t>(index);
+  }
+  header->magic.store(MAGIC, std::memory_order_release);
+
+  return ring;
+}
+
+ShmRingBuffer ShmRingBuffer::open(const std::string& name)
+{
+  auto fd = shm_open(name.c_str(), O_RDWR, 0);
+  if (fd < 0) {
+    throw systemError("Unable to open", name);
+  }
+  struct stat status {
+  };
+  if (fstat(fd, &status) != 0 || static_cast<size_t>(status.st_size) < sizeof(ShmRingHeader)) {
+    close(fd);
+    throw std::runtime_error("Shared memory segment " + name + " is not a Bookkeeping ring");
+  }
+  auto size = static_cast<size_t>(status.st_size);
+  auto address = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (address == MAP_FAILED) {
+    throw systemError("Unable to map", name);
+  }
+
+  ShmRingBuffer ring(address, size);
+  auto header = ring.mHeader;
+  if (header->magic.load(std::memory_order_acquire) != MAGIC
+      || header->version != VERSION
+      || segmentSize(header->slotCount, header->slotSize) > size) {
+    throw std::runtime_error("Shared memory segment " + name + " is not a Bookkeeping ring or is not initialized yet");
+  }
+  return ring;
+}
+
+void ShmRingBuffer::unlink(const std::string& name)
+{
+  shm_unlink(name.c_str());
+}
+
+ShmRingBuffer::ShmRingBuffer(void* address, size_t size)
+  : mAddress(address), mSize(size), mHeader(static_cast<ShmRingHeader*>(address))
+{
+}
+
+ShmRingBuffer::ShmRingBuffer(ShmRingBuffer&& other) noexcept
+  : mAddress(other.mAddress),
+    mSize(other.mSize),
+    mHeader(other.mHeader),
+    mClaimTimeout(other.mClaimTimeout),
+    mStalledPosition(other.mStalledPosition),
+    mStalledSince(other.mStalledSince)
+{
+  other.mAddress = nullptr;
+  other.mHeader = nullptr;
+}
+
+ShmRingBuffer::~ShmRingBuffer()
+{
+  if (mAddress != nullptr) {
+    munmap(mAddress, mSize);
+  }
+}
+
+ShmSlot* ShmRingBuffer::slotAt(uint64_t index) const
+{
+  auto slots = reinterpret_cast<char*>(mHeader) + sizeof(ShmRingHeader);
+  return reinterpret_cast<ShmSlot*>(slots + (index & (mHeader->slotCount - 1)) * mHeader->slotSize);
+}
+
+uint32_t ShmRingBuffer::maxPayloadSize() const
+{
+  return mHeader->slotSize - sizeof(ShmSlot);
+}
+
+uint64_t ShmRingBuffer::droppedRecords() const
+{
+  return mHeader->droppedRecords.load(std::memory_order_relaxed);
+}
+
+bool ShmRingBuffer::tryPush(ShmRecordType type, const std::string& payload)
+{
+  if (payload.size() > maxPayloadSize()) {
+    throw std::runtime_error("Record of " + std::to_string(payload.size()) + " bytes exceeds the shared memory slot size");
+  }
+
+  auto position = mHeader->writeIndex.load(std::memory_order_relaxed);
+  ShmSlot* slot;
+  while (true) {
+    slot = slotAt(position);
+    auto sequence = slot->sequence.load(std::memory_order_acquire);
+    auto difference = static_cast<int64_t>(sequence - position);
+    if (difference == 0) {
+      if (mHeader->writeIndex.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+        break;
+      }
+    } else if (difference < 0) {
+      mHeader->droppedRecords.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    } else {
+      position = mHeader->writeIndex.load(std::memory_order_relaxed);
+    }
+  }
+
+  slot->claim = position;
+  slot->type = type;
+  slot->size = static_cast<uint32_t>(payload.size());
+  slot->checksum = recordChecksum(position, type, payload.data(), payload.size());
+  std::memcpy(reinterpret_cast<char*>(slot) + sizeof(ShmSlot), payload.data(), payload.size());
+  // Fails if the consumer gave up waiting for this record and skipped its slot
+  auto claimed = position;
+  return slot->sequence.compare_exchange_strong(claimed, position + 1, std::memory_order_release, std::memory_order_relaxed);
+}
+
+bool ShmRingBuffer::tryPop(ShmRecordType& type, std::string& payload)
+{
+  while (true) {
+    auto position = mHeader->readIndex.load(std::memory_order_relaxed);
+    auto slot = slotAt(position);
+    if (slot->sequence.load(std::memory_order_acquire) == position + 1) {
+      auto claim = slot->claim;
+      auto checksum = slot->checksum;
+      type = slot->type;
+      auto size = std::min(slot->size, maxPayloadSize());
+      payload.assign(reinterpret_cast<const char*>(slot) + sizeof(ShmSlot), size);
+      slot->sequence.store(position + mHeader->slotCount, std::memory_order_release);
+      mHeader->readIndex.store(position + 1, std::memory_order_relaxed);
+      // Written over by the producer of a previous lap whose slot has been skipped while it was still writing it
+      if (claim != position || checksum != recordChecksum(claim, type, payload.data(), payload.size())) {
+        mHeader->droppedRecords.fetch_add(1, std::memory_order_relaxed);
+        continue;
+      }
+      return true;
+    }
+
+    // Empty ring, or a slot claimed by a producer which is still writing it
+    if (mHeader->writeIndex.load(std::memory_order_relaxed) == position || !skipStalledSlot(position, *slot)) {
+      return false;
+    }
+  }
+}
+
+bool ShmRingBuffer::skipStalledSlot(uint64_t position, ShmSlot& slot)
+{
+  auto now = std::chrono::steady_clock::now();
+  if (mStalledPosition != position) {
+    mStalledPosition = position;
+    mStalledSince = now;
+    return false;
+  }
+  if (now - mStalledSince < mClaimTimeout) {
+    return false;
+  }
+
+  // Release the slot for the next lap, unless its producer published it in the meantime
+  auto claimed = position;
+  if (slot.sequence.compare_exchange_strong(claimed, position + mHeader->slotCount, std::memory_order_acq_rel)) {
+    mHeader->droppedRecords.fetch_add(1, std::memory_order_relaxed);
+    mHeader->readIndex.store(position + 1, std::memory_order_relaxed);
+  }
+  mStalledPosition.reset();
+  return true;
+}
+} // namespace o2::bkp::api::shm
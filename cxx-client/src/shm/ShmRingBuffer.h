@@ -0,0 +1,137 @@
+//  Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+//  See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+//  All rights not expressly granted are reserved.
+//
+//  This software is distributed under the terms of the GNU General Public
+//  License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+//  In applying this license CERN does not waive the privileges and immunities
+//  granted to it by virtue of its status as an Intergovernmental Organization
+//  or submit itself to any jurisdiction.
+
+#ifndef CXX_CLIENT_SHM_SHMRINGBUFFER_H
+#define CXX_CLIENT_SHM_SHMRINGBUFFER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <sys/types.h>
+
+namespace o2::bkp::api::shm
+{
+/// Type of the records exchanged through the shared memory ring, each one maps to a gRPC request message
+enum class ShmRecordType : uint32_t {
+  FlpUpdateCounters = 1,
+  CtpTriggerCountersCreateOrUpdate = 2,
+  DplProcessExecutionCreate = 3,
+  RunUpdate = 4,
+};
+
+/// Fixed layout header at the beginning of the shared memory segment
+struct ShmRingHeader {
+  std::atomic<uint64_t> magic;
+  uint32_t version;
+  uint32_t slotCount;
+  uint32_t slotSize;
+  alignas(64) std::atomic<uint64_t> writeIndex;
+  alignas(64) std::atomic<uint64_t> readIndex;
+  alignas(64) std::atomic<uint64_t> droppedRecords;
+};
+
+/// Fixed layout slot, the payload (serialized request) directly follows the slot header
+struct ShmSlot {
+  std::atomic<uint64_t> sequence;
+  /// Write position the record was claimed at, telling apart the records of the producers whose slot has been skipped
+  uint64_t claim;
+  /// Checksum of the claim and the record, telling apart the records overwritten by a producer whose slot was skipped
+  uint64_t checksum;
+  ShmRecordType type;
+  uint32_t size;
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared memory ring requires address-free 64 bits atomics");
+
+/**
+ * Bounded multi-producers single-consumer lock-free ring living in a POSIX shared memory segment
+ *
+ * Each slot carries a sequence number: producers claim a slot by advancing the shared write index and publish it by
+ * bumping the slot's sequence, the consumer (the aggregator daemon) releases it for the next lap once it has been read.
+ *
+ * A producer killed between claiming and publishing its slot would block the consumer forever: a slot claimed but not
+ * published within the claim timeout is skipped by the consumer and its record counted as dropped. A producer publishing
+ * a slot after it has been skipped loses its record. As the skipped slot is handed out again, such a producer may still
+ * be writing it while the next one does: each record carries the position it was claimed at and a checksum, and the
+ * consumer drops the records which do not match them.
+ */
+class ShmRingBuffer
+{
+ public:
+  /// Create the named segment, used by the aggregator daemon
+  ///
+  /// A valid ring of the same geometry left by a previous daemon is reattached as is, so that the producers which still
+  /// have it mapped keep reaching the daemon. Any other segment with this name is unlinked and replaced, its producers
+  /// keeping the old one until they open the segment again. The segment is only accessible to its owner, and to the
+  /// given group if any: throw std::runtime_error if it can not be restricted so, for example if it is owned by another
+  /// user.
+  ///
+  /// @param claimTimeout how long the consumer waits for a claimed slot to be published before skipping it
+  /// @param group the group whose processes may write records, none to limit the segment to the daemon's user
+  static ShmRingBuffer create(
+    const std::string& name,
+    uint32_t slotCount,
+    uint32_t slotSize,
+    std::chrono::milliseconds claimTimeout = std::chrono::milliseconds{ 1000 },
+    std::optional<gid_t> group = std::nullopt);
+
+  /// Attach to an existing segment created by the aggregator daemon
+  static ShmRingBuffer open(const std::string& name);
+
+  ShmRingBuffer(ShmRingBuffer&& other) noexcept;
+  ShmRingBuffer& operator=(ShmRingBuffer&&) = delete;
+  ShmRingBuffer(const ShmRingBuffer&) = delete;
+  ShmRingBuffer& operator=(const ShmRingBuffer&) = delete;
+  ~ShmRingBuffer();
+
+  /// Copy a record in the ring, return false if the ring is full or the record was skipped by the consumer
+  bool tryPush(ShmRecordType type, const std::string& payload);
+
+  /// Pop the oldest record if any, only one consumer may call this
+  ///
+  /// The slot of a record claimed but not published within the claim timeout is skipped, a record overwritten by the
+  /// producer of a skipped slot is dropped.
+  bool tryPop(ShmRecordType& type, std::string& payload);
+
+  /// Maximal size of a record's payload
+  uint32_t maxPayloadSize() const;
+
+  /// Number of records that have been refused because the ring was full, skipped because they were never published or
+  /// dropped because they were overwritten
+  uint64_t droppedRecords() const;
+
+  /// Remove the named segment, already mapped rings stay valid
+  static void unlink(const std::string& name);
+
+ private:
+  ShmRingBuffer(void* address, size_t size);
+
+  ShmSlot* slotAt(uint64_t index) const;
+
+  /// Skip the claimed but unpublished slot at the given read position once it waited for the claim timeout, return
+  /// true if the consumer can go on reading (the slot was skipped, or published meanwhile)
+  bool skipStalledSlot(uint64_t position, ShmSlot& slot);
+
+  void* mAddress;
+  size_t mSize;
+  ShmRingHeader* mHeader;
+
+  /// Consumer side only: read position waiting for its slot to be published and since when
+  std::chrono::milliseconds mClaimTimeout{ 1000 };
+  std::optional<uint64_t> mStalledPosition;
+  std::chrono::steady_clock::time_point mStalledSince;
+};
+} // namespace o2::bkp::api::shm
+
+#endif // CXX_CLIENT_SHM_SHMRINGBUFFER_H
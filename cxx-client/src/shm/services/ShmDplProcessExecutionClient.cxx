@@ -0,0 +1,44 @@
+//  Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+//  See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+//  All rights not expressly granted are reserved.
+//
+//  This software is distributed under the terms of the GNU General Public
+//  License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+//  In applying this license CERN does not waive the privileges and immunities
+//  granted to it by virtue of its status as an Intergovernmental Organization
+//  or submit itself to any jurisdiction.
+
+#include "ShmDplProcessExecutionClient.h"
+#include "dplProcessExecution.pb.h"
+
+using o2::bkp::DplProcessType;
+using o2::bookkeeping::DplProcessExecutionCreationRequest;
+
+namespace o2::bkp::api::shm::services
+{
+ShmDplProcessExecutionClient::ShmDplProcessExecutionClient(std::shared_ptr<ShmRingBuffer> ring) : mRing(std::move(ring))
+{
+}
+
+void ShmDplProcessExecutionClient::registerProcessExecution(
+  int runNumber,
+  DplProcessType type,
+  std::string hostname,
+  std::string deviceId,
+  std::string args,
+  std::string detector)
+{
+  DplProcessExecutionCreationRequest request{};
+  request.set_runnumber(runNumber);
+  request.set_detectorname(detector);
+  request.set_processname(deviceId);
+  request.set_type(static_cast<o2::bookkeeping::DplProcessType>(type));
+  request.set_hostname(hostname);
+  request.set_args(args);
+
+  if (!mRing->tryPush(ShmRecordType::DplProcessExecutionCreate, request.SerializeAsString())) {
+    throw std::runtime_error("Shared memory ring is full, DPL process execution has been dropped");
+  }
+}
+} // namespace o2::bkp::api::shm::services
@@ -0,0 +1,44 @@
+//  Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+//  See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+//  All rights not expressly granted are reserved.
+//
+//  This software is distributed under the terms of the GNU General Public
+//  License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+//  In applying this license CERN does not waive the privileges and immunities
+//  granted to it by virtue of its status as an Intergovernmental Organization
+//  or submit itself to any jurisdiction.
+
+#include "ShmFlpServiceClient.h"
+#include "flp.pb.h"
+
+using o2::bookkeeping::UpdateCountersRequest;
+
+namespace o2::bkp::api::shm::services
+{
+ShmFlpServiceClient::ShmFlpServiceClient(std::shared_ptr<ShmRingBuffer> ring) : mRing(std::move(ring))
+{
+}
+
+void ShmFlpServiceClient::updateReadoutCountersByFlpNameAndRunNumber(
+  const std::string& flpName,
+  int32_t runNumber,
+  uint64_t nSubtimeframes,
+  uint64_t nEquipmentBytes,
+  uint64_t nRecordingBytes,
+  uint64_t nFairMQBytes)
+{
+  UpdateCountersRequest request;
+
+  request.set_flpname(flpName);
+  request.set_runnumber(runNumber);
+  request.set_nsubtimeframes(nSubtimeframes);
+  request.set_nequipmentbytes(nEquipmentBytes);
+  request.set_nrecordingbytes(nRecordingBytes);
+  request.set_nfairmqbytes(nFairMQBytes);
+
+  if (!mRing->tryPush(ShmRecordType::FlpUpdateCounters, request.SerializeAsString())) {
+    throw std::runtime_error("Shared memory ring is full, FLP counters update has been dropped");
+  }
+}
+} // namespace o2::bkp::api::shm::services
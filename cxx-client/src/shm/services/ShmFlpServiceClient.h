@@ -0,0 +1,40 @@
+//  Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+//  See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+//  All rights not expressly granted are reserved.
+//
+//  This software is distributed under the terms of the GNU General Public
+//  License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+//  In applying this license CERN does not waive the privileges and immunities
+//  granted to it by virtue of its status as an Intergovernmental Organization
+//  or submit itself to any jurisdiction.
+
+#ifndef CXX_CLIENT_SHM_SERVICES_SHMFLPSERVICECLIENT_H
+#define CXX_CLIENT_SHM_SERVICES_SHMFLPSERVICECLIENT_H
+
+#include <memory>
+#include "BookkeepingApi/FlpServiceClient.h"
+#include "shm/ShmRingBuffer.h"
+
+namespace o2::bkp::api::shm::services
+{
+/// Shared memory ring based implementation of FlpServiceClient
+class ShmFlpServiceClient : public FlpServiceClient
+{
+ public:
+  explicit ShmFlpServiceClient(std::shared_ptr<ShmRingBuffer> ring);
+
+  void updateReadoutCountersByFlpNameAndRunNumber(
+    const std::string& flpName,
+    int32_t runNumber,
+    uint64_t nSubtimeframes,
+    uint64_t nEquipmentBytes,
+    uint64_t nRecordingBytes,
+    uint64_t nFairMQBytes) override;
+
+ private:
+  std::shared_ptr<ShmRingBuffer> mRing;
+};
+} // namespace o2::bkp::api::shm::services
+
+#endif // CXX_CLIENT_SHM_SERVICES_SHMFLPSERVICECLIENT_H
@@ -0,0 +1,40 @@
+//  Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+//  See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+//  All rights not expressly granted are reserved.
+//
+//  This software is distributed under the terms of the GNU General Public
+//  License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+//  In applying this license CERN does not waive the privileges and immunities
+//  granted to it by virtue of its status as an Intergovernmental Organization
+//  or submit itself to any jurisdiction.
+
+#include "ShmQcFlagServiceClient.h"
+
+#include <stdexcept>
+
+namespace o2::bkp::api::shm::services
+{
+namespace
+{
+[[noreturn]] void throwUnsupported()
+{
+  throw std::runtime_error("QC flags creation is not available through the shared memory transport, use a gRPC client instead");
+}
+} // namespace
+
+std::vector<int> ShmQcFlagServiceClient::createForDataPass(uint32_t, const std::string&, const std::string&, const std::vector<QcFlag>&)
+{
+  throwUnsupported();
+}
+
+std::vector<int> ShmQcFlagServiceClient::createForSimulationPass(uint32_t, const std::string&, const std::string&, const std::vector<QcFlag>&)
+{
+  throwUnsupported();
+}
+
+std::vector<int> ShmQcFlagServiceClient::createForSynchronous(uint32_t, const std::string&, const std::vector<QcFlag>&)
+{
+  throwUnsupported();
+}
+} // namespace o2::bkp::api::shm::services
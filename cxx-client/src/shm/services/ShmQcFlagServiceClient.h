@@ -0,0 +1,31 @@
+//  Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+//  See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+//  All rights not expressly granted are reserved.
+//
+//  This software is distributed under the terms of the GNU General Public
+//  License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+//  In applying this license CERN does not waive the privileges and immunities
+//  granted to it by virtue of its status as an Intergovernmental Organization
+//  or submit itself to any jurisdiction.
+
+#ifndef CXX_CLIENT_SHM_SERVICES_SHMQCFLAGSERVICECLIENT_H
+#define CXX_CLIENT_SHM_SERVICES_SHMQCFLAGSERVICECLIENT_H
+
+#include "BookkeepingApi/QcFlagServiceClient.h"
+
+namespace o2::bkp::api::shm::services
+{
+/// QC flag creation returns the created flags ids, which a one-way ring can not provide: every call throws
+class ShmQcFlagServiceClient : public QcFlagServiceClient
+{
+ public:
+  ~ShmQcFlagServiceClient() override = default;
+
+  std::vector<int> createForDataPass(uint32_t runNumber, const std::string& passName, const std::string& detectorName, const std::vector<QcFlag>& qcFlags) override;
+  std::vector<int> createForSimulationPass(uint32_t runNumber, const std::string& productionName, const std::string& detectorName, const std::vector<QcFlag>& qcFlags) override;
+  std::vector<int> createForSynchronous(uint32_t runNumber, const std::string& detectorName, const std::vector<QcFlag>& qcFlags) override;
+};
+} // namespace o2::bkp::api::shm::services
+
+#endif // CXX_CLIENT_SHM_SERVICES_SHMQCFLAGSERVICECLIENT_H
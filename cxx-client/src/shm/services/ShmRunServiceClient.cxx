@@ -0,0 +1,34 @@
+//  Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+//  See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+//  All rights not expressly granted are reserved.
+//
+//  This software is distributed under the terms of the GNU General Public
+//  License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+//  In applying this license CERN does not waive the privileges and immunities
+//  granted to it by virtue of its status as an Intergovernmental Organization
+//  or submit itself to any jurisdiction.
+
+#include "ShmRunServiceClient.h"
+#include "run.pb.h"
+
+using o2::bookkeeping::RunUpdateRequest;
+
+namespace o2::bkp::api::shm::services
+{
+ShmRunServiceClient::ShmRunServiceClient(std::shared_ptr<ShmRingBuffer> ring) : mRing(std::move(ring))
+{
+}
+
+void ShmRunServiceClient::setRawCtpTriggerConfiguration(int runNumber, std::string rawCtpTriggerConfiguration)
+{
+  RunUpdateRequest updateRequest{};
+
+  updateRequest.set_runnumber(runNumber);
+  updateRequest.set_rawctptriggerconfiguration(rawCtpTriggerConfiguration);
+
+  if (!mRing->tryPush(ShmRecordType::RunUpdate, updateRequest.SerializeAsString())) {
+    throw std::runtime_error("Shared memory ring is full, run update has been dropped");
+  }
+}
+} // namespace o2::bkp::api::shm::services
@@ -0,0 +1,35 @@
+//  Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+//  See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+//  All rights not expressly granted are reserved.
+//
+//  This software is distributed under the terms of the GNU General Public
+//  License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+//  In applying this license CERN does not waive the privileges and immunities
+//  granted to it by virtue of its status as an Intergovernmental Organization
+//  or submit itself to any jurisdiction.
+
+#ifndef CXX_CLIENT_SHM_SERVICES_SHMRUNSERVICECLIENT_H
+#define CXX_CLIENT_SHM_SERVICES_SHMRUNSERVICECLIENT_H
+
+#include <memory>
+#include "BookkeepingApi/RunServiceClient.h"
+#include "shm/ShmRingBuffer.h"
+
+namespace o2::bkp::api::shm::services
+{
+/// Shared memory ring based implementation of RunServiceClient
+class ShmRunServiceClient : public RunServiceClient
+{
+ public:
+  explicit ShmRunServiceClient(std::shared_ptr<ShmRingBuffer> ring);
+  ~ShmRunServiceClient() override = default;
+
+  void setRawCtpTriggerConfiguration(int runNumber, std::string rawCtpTriggerConfiguration) override;
+
+ private:
+  std::shared_ptr<ShmRingBuffer> mRing;
+};
+} // namespace o2::bkp::api::shm::services
+
+#endif // CXX_CLIENT_SHM_SERVICES_SHMRUNSERVICECLIENT_H
@@ -26,6 +26,7 @@ const { KafkaConfig } = require('./config/index.js');
 const { AliEcsSynchronizer } = require('./server/kafka/AliEcsSynchronizer.js');
 const { environmentService } = require('./server/services/environment/EnvironmentService.js');
 const { runService } = require('./server/services/run/RunService.js');
+const { ctpTriggerCountersService } = require('./server/services/ctpTriggerCounters/CtpTriggerCountersService.js');
 const { CcdbSynchronizer } = require('./server/externalServicesSynchronization/ccdb/CcdbSynchronizer.js');
 const { promises: fs } = require('fs');
 const { MonAlisaClient } = require('./server/externalServicesSynchronization/monalisa/MonAlisaClient.js');
@@ -190,6 +191,7 @@ class BookkeepingApplication {
 
         this.scheduledProcessesManager.cleanup();
         try {
+            await ctpTriggerCountersService.flush();
             await this.database.disconnect();
             await this.webUiServer.close();
         } catch (error) {
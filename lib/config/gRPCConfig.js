@@ -14,9 +14,40 @@
 const internalOrigin = process.env?.GRPC_INTERNAL_ORIGIN ?? null;
 const authenticatedOrigin = process.env?.GRPC_AUTHENTICATED_ORIGIN ?? null;
 
+// Default to 10 minutes, longer than any client retry policy
+const idempotencyWindowMs = Number(process.env?.GRPC_IDEMPOTENCY_WINDOW_MS ?? 10 * 60 * 1000);
+
+// Watched entities are fetched once per interval, whatever the amount of watchers
+const watchPollIntervalMs = Number(process.env?.GRPC_WATCH_POLL_INTERVAL_MS ?? 1000);
+
+// CTP trigger counters samples are stored by batches, replacing the previous sample of the same class if it was not stored yet
+const ctpTriggerCountersFlushIntervalMs = Number(process.env?.GRPC_CTP_TRIGGER_COUNTERS_FLUSH_INTERVAL_MS ?? 1000);
+
+// Spans are only recorded if an export file is given, for the calls sampled by their client or, without client decision, at this ratio
+const tracingExportPath = process.env?.GRPC_TRACING_EXPORT_PATH ?? null;
+const tracingSampleRatio = Number(process.env?.GRPC_TRACING_SAMPLE_RATIO ?? 0);
+
 module.exports = {
     origin: {
         internal: internalOrigin,
         authenticated: authenticatedOrigin,
     },
+    idempotency: {
+        windowMs: idempotencyWindowMs,
+        maxKeys: 100000,
+    },
+    watch: {
+        pollIntervalMs: watchPollIntervalMs,
+    },
+    ctpTriggerCounters: {
+        flushIntervalMs: ctpTriggerCountersFlushIntervalMs,
+        maxPendingCounters: 10000,
+        maxBufferedCounters: 100000,
+    },
+    tracing: {
+        exportPath: tracingExportPath,
+        sampleRatio: tracingSampleRatio,
+        flushIntervalMs: 1000,
+        maxBufferedSpans: 10000,
+    },
 };
@@ -20,6 +20,7 @@ const models = require('./models/index.js');
 const tables = require('./tables/index.js');
 const utilities = require('./utilities/index.js');
 const { LogManager } = require('@aliceo2/web-ui');
+const { recordDatabaseTiming } = require('../utilities/serverTiming.js');
 
 /**
  * Sequelize implementation of the Database.
@@ -43,6 +44,7 @@ class SequelizeDatabase {
                 underscored: true,
             },
         });
+        recordDatabaseTiming(this.sequelize);
 
         this._models = models(this.sequelize);
         this._tables = tables(this.sequelize);
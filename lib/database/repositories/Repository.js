@@ -13,6 +13,7 @@
 
 const { dataSource } = require('../DataSource.js');
 const { QueryBuilder } = require('../utilities/QueryBuilder.js');
+const { tracer, traceMethods } = require('../../utilities/tracing.js');
 
 /**
  * Sequelize implementation of the Repository.
@@ -25,6 +26,11 @@ class Repository {
      */
     constructor(model) {
         this.model = model;
+
+        // Queries made while handling a traced gRPC call are spans of its trace, named after the concrete repository
+        if (tracer.enabled) {
+            traceMethods(this, this.constructor.name, tracer);
+        }
     }
 
     /**
@@ -197,6 +203,17 @@ class Repository {
     async upsert(entity) {
         return this.model.upsert(entity);
     }
+
+    /**
+     * Upsert multiple entities in db with a single query
+     *
+     * @param {Object[]} entities the entities to upsert
+     * @param {string[]} fieldsToUpdate the fields updated for the entities which already exist (identified by a unique key)
+     * @return {Promise<Model[]>} the upserted instances
+     */
+    async upsertAll(entities, fieldsToUpdate) {
+        return this.model.bulkCreate(entities, { updateOnDuplicate: fieldsToUpdate });
+    }
 }
 
 module.exports = Repository;
@@ -13,6 +13,8 @@
 
 const { dplProcessService } = require('../../services/dpl/DplProcessService.js');
 const { snakeToPascal } = require('../../../utilities/stringUtils.js');
+const { GRPCConfig } = require('../../../config/index.js');
+const { createIdempotencyWindow, scopeIdempotencyKey } = require('../../../utilities/idempotencyWindow.js');
 
 /**
  * Controller to handle requests through gRPC EnvironmentService
@@ -23,10 +25,11 @@ class GRPCDplProcessExecutionController {
      */
     constructor() {
         this.dplProcessService = dplProcessService;
+        this.idempotencyWindow = createIdempotencyWindow(GRPCConfig.idempotency);
     }
 
     // eslint-disable-next-line jsdoc/require-jsdoc
-    Create(newDplProcessExecution) {
+    Create(newDplProcessExecution, { identity } = {}) {
         const {
             runNumber,
             detectorName,
@@ -34,17 +37,21 @@ class GRPCDplProcessExecutionController {
             type,
             hostname,
             args,
+            idempotencyKey,
         } = newDplProcessExecution;
 
-        return this.dplProcessService.createProcessExecution(
-            { args },
-            {
-                runIdentifier: { runNumber },
-                detectorName,
-                processName,
-                processTypeLabel: snakeToPascal(type),
-                hostname: hostname,
-            },
+        return this.idempotencyWindow(
+            scopeIdempotencyKey('Create', identity, idempotencyKey),
+            () => this.dplProcessService.createProcessExecution(
+                { args },
+                {
+                    runIdentifier: { runNumber },
+                    detectorName,
+                    processName,
+                    processTypeLabel: snakeToPascal(type),
+                    hostname: hostname,
+                },
+            ),
         );
     }
 }
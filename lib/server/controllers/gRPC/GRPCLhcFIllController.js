@@ -10,7 +10,10 @@
  *  granted to it by virtue of its status as an Intergovernmental Organization
  *  or submit itself to any jurisdiction.
  */
+const { LogManager } = require('@aliceo2/web-ui');
 const { lhcFillService } = require('../../services/lhcFill/LhcFillService.js');
+const { GRPCConfig } = require('../../../config/index.js');
+const { createLatestValueWatcher } = require('../../../utilities/latestValueWatcher.js');
 
 /**
  * Controller to handle requests through gRPC LhcFillService
@@ -21,12 +24,28 @@ class GRPCLhcFillController {
      */
     constructor() {
         this.lhcFillService = lhcFillService;
+        this._logger = LogManager.getLogger('GRPC-LHC-FILL');
+
+        this.watchLast = createLatestValueWatcher(() => this.lhcFillService.getLast(), {
+            ...GRPCConfig.watch,
+            onError: (error) => this._logger.errorMessage(`Failed to fetch the last LHC fill for watchers: ${error.message}`),
+        });
     }
 
     // eslint-disable-next-line jsdoc/require-jsdoc
     async GetLast() {
         return { lhcFill: await this.lhcFillService.getLast() };
     }
+
+    // eslint-disable-next-line jsdoc/require-jsdoc
+    async *Watch(_, { signal }) {
+        for await (const lhcFill of this.watchLast(signal)) {
+            if (lhcFill) {
+                // The fill is shared between all the watchers, while responses are converted in place
+                yield { lhcFill: { ...lhcFill } };
+            }
+        }
+    }
 }
 
 exports.GRPCLhcFillController = GRPCLhcFillController;
@@ -12,6 +12,9 @@
  */
 
 const { logService } = require('../../services/log/LogService.js');
+const { BadParameterError } = require('../../errors/BadParameterError.js');
+const { GRPCConfig } = require('../../../config/index.js');
+const { createIdempotencyWindow, scopeIdempotencyKey } = require('../../../utilities/idempotencyWindow.js');
 
 /**
  * Controller to handle requests through gRPC LogService
@@ -22,11 +25,41 @@ class GRPCLogController {
      */
     constructor() {
         this.logService = logService;
+        this.idempotencyWindow = createIdempotencyWindow(GRPCConfig.idempotency);
     }
 
     // eslint-disable-next-line jsdoc/require-jsdoc
-    Create({ title, text, parentLogId, runNumbers }) {
-        return this.logService.create({ title, text, parentLogId }, runNumbers);
+    Create({ title, text, parentLogId, runNumbers, idempotencyKey }, { identity } = {}) {
+        return this.idempotencyWindow(
+            scopeIdempotencyKey('Create', identity, idempotencyKey),
+            () => this.logService.create({ title, text, parentLogId }, runNumbers),
+        );
+    }
+
+    // eslint-disable-next-line jsdoc/require-jsdoc
+    async UploadAttachment(requests) {
+        const iterator = requests[Symbol.asyncIterator]();
+        const { value: firstRequest } = await iterator.next();
+        if (!firstRequest?.metadata) {
+            throw new BadParameterError('The first message of an attachment upload must be its metadata');
+        }
+        const { logId, originalName, mimeType } = firstRequest.metadata;
+
+        /**
+         * Extract the file content from the remaining requests
+         *
+         * @return {AsyncGenerator<Buffer>} the chunks of the file
+         */
+        async function* readChunks() {
+            for (let request = await iterator.next(); !request.done; request = await iterator.next()) {
+                if (!request.value.chunk) {
+                    throw new BadParameterError('Attachment metadata can only be given once, in the first message of the upload');
+                }
+                yield request.value.chunk;
+            }
+        }
+
+        return this.logService.createAttachment(logId, { originalName, mimeType }, readChunks());
     }
 }
 
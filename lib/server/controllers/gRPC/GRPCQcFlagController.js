@@ -13,6 +13,8 @@
 
 const { dataPassService } = require('../../services/dataPasses/DataPassService.js');
 const { qcFlagService } = require('../../services/qualityControlFlag/QcFlagService.js');
+const { GRPCConfig } = require('../../../config/index.js');
+const { createIdempotencyWindow, scopeIdempotencyKey } = require('../../../utilities/idempotencyWindow.js');
 
 /**
  * Controller to handle requests through gRPC QcFlagService
@@ -24,61 +26,68 @@ class GRPCQcFlagController {
     constructor() {
         this.qcFlagService = qcFlagService;
         this.dataPassService = dataPassService;
+        this.idempotencyWindow = createIdempotencyWindow(GRPCConfig.idempotency);
     }
 
     // eslint-disable-next-line jsdoc/require-jsdoc
-    async CreateForDataPass({ runNumber, detectorName, passName, flags }) {
-        const qcFlags = await this.qcFlagService.create(
-            flags.map(({ from, to, ...flag }) => ({
-                ...flag,
-                from: from !== undefined ? Number(from) : from,
-                to: to !== undefined ? Number(to) : to,
-            })),
-            {
-                runNumber,
-                detectorIdentifier: { detectorName },
-                dataPassIdentifier: { name: await this.dataPassService.getFullDataPassNameUsingRunPeriod(passName, runNumber) },
-            },
-            { user: { externalUserId: 0, roles: ['admin'] } },
-        );
+    CreateForDataPass({ runNumber, detectorName, passName, flags, idempotencyKey }, { identity } = {}) {
+        return this.idempotencyWindow(scopeIdempotencyKey('CreateForDataPass', identity, idempotencyKey), async () => {
+            const qcFlags = await this.qcFlagService.create(
+                flags.map(({ from, to, ...flag }) => ({
+                    ...flag,
+                    from: from !== undefined ? Number(from) : from,
+                    to: to !== undefined ? Number(to) : to,
+                })),
+                {
+                    runNumber,
+                    detectorIdentifier: { detectorName },
+                    dataPassIdentifier: { name: await this.dataPassService.getFullDataPassNameUsingRunPeriod(passName, runNumber) },
+                },
+                { user: { externalUserId: 0, roles: ['admin'] } },
+            );
 
-        return {
-            flagIds: qcFlags.map(({ id }) => id),
-        };
+            return {
+                flagIds: qcFlags.map(({ id }) => id),
+            };
+        });
     }
 
     // eslint-disable-next-line jsdoc/require-jsdoc
-    async CreateForSimulationPass({ runNumber, detectorName, productionName, flags }) {
-        const qcFlags = await this.qcFlagService.create(
-            flags.map(({ from, to, ...flag }) => ({
-                ...flag,
-                from: from !== undefined ? Number(from) : from,
-                to: to !== undefined ? Number(to) : to,
-            })),
-            { runNumber, detectorIdentifier: { detectorName }, simulationPassIdentifier: { name: productionName } },
-            { user: { externalUserId: 0, roles: ['admin'] } },
-        );
+    CreateForSimulationPass({ runNumber, detectorName, productionName, flags, idempotencyKey }, { identity } = {}) {
+        return this.idempotencyWindow(scopeIdempotencyKey('CreateForSimulationPass', identity, idempotencyKey), async () => {
+            const qcFlags = await this.qcFlagService.create(
+                flags.map(({ from, to, ...flag }) => ({
+                    ...flag,
+                    from: from !== undefined ? Number(from) : from,
+                    to: to !== undefined ? Number(to) : to,
+                })),
+                { runNumber, detectorIdentifier: { detectorName }, simulationPassIdentifier: { name: productionName } },
+                { user: { externalUserId: 0, roles: ['admin'] } },
+            );
 
-        return {
-            flagIds: qcFlags.map(({ id }) => id),
-        };
+            return {
+                flagIds: qcFlags.map(({ id }) => id),
+            };
+        });
     }
 
     // eslint-disable-next-line jsdoc/require-jsdoc
-    async CreateSynchronous({ runNumber, detectorName, flags }) {
-        const qcFlags = await this.qcFlagService.create(
-            flags.map(({ from, to, ...flag }) => ({
-                ...flag,
-                from: from !== undefined ? Number(from) : from,
-                to: to !== undefined ? Number(to) : to,
-            })),
-            { runNumber, detectorIdentifier: { detectorName } },
-            { user: { externalUserId: 0, roles: ['admin'] } },
-        );
+    CreateSynchronous({ runNumber, detectorName, flags, idempotencyKey }, { identity } = {}) {
+        return this.idempotencyWindow(scopeIdempotencyKey('CreateSynchronous', identity, idempotencyKey), async () => {
+            const qcFlags = await this.qcFlagService.create(
+                flags.map(({ from, to, ...flag }) => ({
+                    ...flag,
+                    from: from !== undefined ? Number(from) : from,
+                    to: to !== undefined ? Number(to) : to,
+                })),
+                { runNumber, detectorIdentifier: { detectorName } },
+                { user: { externalUserId: 0, roles: ['admin'] } },
+            );
 
-        return {
-            flagIds: qcFlags.map(({ id }) => id),
-        };
+            return {
+                flagIds: qcFlags.map(({ id }) => id),
+            };
+        });
     }
 }
 
@@ -11,8 +11,41 @@
  * or submit itself to any jurisdiction.
  */
 
+const { LogManager } = require('@aliceo2/web-ui');
 const { runService } = require('../../services/run/RunService.js');
+const { GRPCConfig } = require('../../../config/index.js');
+const { createLatestValueWatcher } = require('../../../utilities/latestValueWatcher.js');
 const { runAdapter } = require('../../../database/adapters/index');
+const { BadParameterError } = require('../../errors/BadParameterError.js');
+
+/**
+ * Names of the fields of the gRPC Run message, the only ones that can be selected
+ * @type {Set<string>}
+ */
+const RUN_FIELDS = new Set([
+    'runNumber', 'environmentId', 'bytesReadOut', 'createdAt', 'Id', 'nDetectors', 'nEpns', 'nFlps', 'nSubtimeframes',
+    'pdpConfigOption', 'pdpTopologyDescriptionLibraryFile', 'pdpWorkflowParameters', 'pdpBeamType', 'readoutCfgUri',
+    'runQuality', 'runType', 'tfbDdMode', 'timeO2End', 'timeO2Start', 'timeTrgEnd', 'timeTrgStart', 'triggerValue',
+    'rawCtpTriggerConfiguration', 'odcTopologyFullName', 'ddFlp', 'dcs', 'epn', 'epnTopology', 'detectors', 'updatedAt',
+    'lhcPeriod',
+]);
+
+/**
+ * Fields of the gRPC run coming from a relation of the same name, only fetched when selected
+ * @type {string[]}
+ */
+const RUN_FIELDS_FROM_RELATIONS = ['detectors', 'runType', 'lhcPeriod'];
+
+/**
+ * Return a copy of the given object containing only the given fields (the ones it does not have are ignored)
+ *
+ * @param {Object} object the object to project
+ * @param {string[]} fields the fields to keep
+ * @return {Object} the projection
+ */
+const projectFields = (object, fields) => Object.fromEntries(fields
+    .filter((field) => field in object)
+    .map((field) => [field, object[field]]));
 
 /**
  * Controller to handle requests through gRPC RunService
@@ -24,14 +57,61 @@ class GRPCRunController {
     constructor() {
         this.runService = runService;
         this.runAdapter = runAdapter;
+        this._logger = LogManager.getLogger('GRPC-RUN');
+
+        // A single watcher for all the relations requested: the fill is always fetched and removed when not requested
+        this.watchLast = createLatestValueWatcher(
+            () => this.runService.getLast({ lhcFill: true, detectors: true, runType: true, lhcPeriod: true }),
+            {
+                ...GRPCConfig.watch,
+                onError: (error) => this._logger.errorMessage(`Failed to fetch the last run for watchers: ${error.message}`),
+            },
+        );
     }
 
     // eslint-disable-next-line jsdoc/require-jsdoc
-    async Get({ runNumber, relations }) {
-        const run = await this.runService.getOrFail({ runNumber }, { lhcFill: relations.includes('LHC_FILL') });
+    async Get({ runNumber, relations, fields }) {
+        const unknownFields = fields.filter((field) => !RUN_FIELDS.has(field));
+        if (unknownFields.length > 0) {
+            throw new BadParameterError(`Unknown run fields: ${unknownFields.join(', ')}`);
+        }
+
+        // The whole run row is fetched anyway, the selection only spares the relations that are not selected
+        const runRelations = { lhcFill: relations.includes('LHC_FILL') };
+        for (const field of fields.filter((field) => RUN_FIELDS_FROM_RELATIONS.includes(field))) {
+            runRelations[field] = true;
+        }
+
+        const run = await this.runService.getOrFail({ runNumber }, runRelations);
         const { lhcFill } = run;
         delete run.lhcFill;
-        return { run: this.runAdapter.toGRPC(run), lhcFill };
+        const grpcRun = this.runAdapter.toGRPC(run);
+        return { run: fields.length > 0 ? projectFields(grpcRun, ['runNumber', ...fields]) : grpcRun, lhcFill };
+    }
+
+    // eslint-disable-next-line jsdoc/require-jsdoc
+    async *GetMany({ runNumberFrom, runNumberTo, lhcPeriod, relations }) {
+        const runs = this.runService.getMany(
+            { runNumberFrom, runNumberTo, lhcPeriod },
+            { lhcFill: relations.includes('LHC_FILL'), detectors: true, runType: true, lhcPeriod: true },
+        );
+        for await (const run of runs) {
+            const { lhcFill } = run;
+            delete run.lhcFill;
+            yield { run: this.runAdapter.toGRPC(run), lhcFill };
+        }
+    }
+
+    // eslint-disable-next-line jsdoc/require-jsdoc
+    async *Watch({ relations }, { signal }) {
+        const withLhcFill = relations.includes('LHC_FILL');
+        for await (const lastRun of this.watchLast(signal)) {
+            if (lastRun) {
+                // The run is shared between all the watchers, while responses are converted in place
+                const { lhcFill, ...run } = lastRun;
+                yield { run: this.runAdapter.toGRPC(run), lhcFill: withLhcFill && lhcFill ? { ...lhcFill } : undefined };
+            }
+        }
     }
 
     // eslint-disable-next-line jsdoc/require-jsdoc
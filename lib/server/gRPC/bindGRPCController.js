@@ -11,8 +11,63 @@
  * or submit itself to any jurisdiction.
  */
 
+const { Metadata } = require('@grpc/grpc-js');
 const { nativeToGRPCError } = require('./nativeToGRPCError.js');
 const { extractFieldsConverters } = require('./services/protoParsing/extractFieldsConverters.js');
+const { tracer } = require('../../utilities/tracing.js');
+const {
+    SERVER_TIMING_METADATA_KEY,
+    createServerTiming,
+    formatServerTiming,
+    runWithServerTiming,
+    timeStage,
+} = require('../../utilities/serverTiming.js');
+
+/**
+ * Apply a map function to every nodes of a tree described by their path in the tree
+ *
+ * For example, considering the tree {a: {b1: 12, b2: 5}} with a mapping of (x) => 2*x applied on path ['a', 'b2']
+ * Will update the tree to be: {a: {b1: 12, b2: 10}}
+ *
+ * @param {object} tree the tree to update (will be updated in place)
+ * @param {string[]} leafPath path of the leaf to update in the tree
+ * @param {function} mapFunction the mapping function to apply
+ * @return {void}
+ */
+const mapTreeLeaves = (tree, leafPath, mapFunction) => {
+    if (!tree) {
+        return;
+    }
+
+    // We are at the end of the path, we have the actual value that need to be mapped
+    if (leafPath.length === 1) {
+        const [leafName] = leafPath;
+        // If leaf do not exist, simply return
+        if (leafName in tree) {
+            const value = tree[leafName];
+            // If leaf is an array of value, apply the map to all of them
+            tree[leafName] = Array.isArray(value)
+                ? value.map((item) => mapFunction(item))
+                : mapFunction(tree[leafName]);
+        }
+        return;
+    }
+
+    // Recurse in the tree nodes up to the actual leaf
+    const [newRootNodeName, ...newLeafPath] = leafPath;
+
+    // Move forward in the tree
+    let newTree = tree[newRootNodeName];
+
+    // Manipulate the new root as if it's an array, to apply map to all the subtrees if it's an array
+    if (!Array.isArray(newTree)) {
+        newTree = [newTree];
+    }
+
+    for (const newTreeItem of newTree) {
+        mapTreeLeaves(newTreeItem, newLeafPath, mapFunction);
+    }
+};
 
 /**
  * Adapt gRPC service method to controller handler
@@ -32,65 +87,146 @@ const adaptGrpcServiceMethodToControllerHandler = (
     controllerHandler,
     requestFieldsConverters,
     responseFieldsConverters,
-) => async ({ request }) => {
-    /**
-     * Apply a map function to every nodes of a tree described by their path in the tree
-     *
-     * For example, considering the tree {a: {b1: 12, b2: 5}} with a mapping of (x) => 2*x applied on path ['a', 'b2']
-     * Will update the tree to be: {a: {b1: 12, b2: 10}}
-     *
-     * @param {object} tree the tree to update (will be updated in place)
-     * @param {string[]} leafPath path of the leaf to update in the tree
-     * @param {function} mapFunction the mapping function to apply
-     * @return {void}
-     */
-    const mapTreeLeaves = (tree, leafPath, mapFunction) => {
-        if (!tree) {
-            return;
-        }
+) => async (call) => {
+    const { request } = call;
+    // Apply the js converter to all the request parameters that needs it
+    for (const { path, toJs } of requestFieldsConverters) {
+        mapTreeLeaves(request, path, toJs);
+    }
 
-        // We are at the end of the path, we have the actual value that need to be mapped
-        if (leafPath.length === 1) {
-            const [leafName] = leafPath;
-            // If leaf do not exist, simply return
-            if (leafName in tree) {
-                const value = tree[leafName];
-                // If leaf is an array of value, apply the map to all of them
-                tree[leafName] = Array.isArray(value)
-                    ? value.map((item) => mapFunction(item))
-                    : mapFunction(tree[leafName]);
-            }
-            return;
-        }
+    const response = await controllerHandler(request, { identity: call.identity });
 
-        // Recurse in the tree nodes up to the actual leaf
-        const [newRootNodeName, ...newLeafPath] = leafPath;
+    if (typeof response !== 'object' || response === null) {
+        return null;
+    }
 
-        // Move forward in the tree
-        let newTree = tree[newRootNodeName];
+    // Apply the gRPC converter to all the request parameters that needs it
+    for (const { path, fromJs } of responseFieldsConverters) {
+        mapTreeLeaves(response, path, fromJs);
+    }
 
-        // Manipulate the new root as if it's an array, to apply map to all the subtrees if it's an array
-        if (!Array.isArray(newTree)) {
-            newTree = [newTree];
-        }
+    return response;
+};
 
-        for (const newTreeItem of newTree) {
-            mapTreeLeaves(newTreeItem, newLeafPath, mapFunction);
-        }
+/**
+ * Wait until a server stream can be written again or the call is cancelled by the client
+ *
+ * @param {ServerWritableStream} call the gRPC server stream
+ * @return {Promise<void>} resolves once the stream is writable again or cancelled
+ */
+const waitForDrainOrCancellation = (call) => new Promise((resolve) => {
+    // eslint-disable-next-line require-jsdoc
+    const onEvent = () => {
+        call.off('drain', onEvent);
+        call.off('cancelled', onEvent);
+        resolve();
     };
+    call.on('drain', onEvent);
+    call.on('cancelled', onEvent);
+});
 
-    // Apply the js converter to all the request parameters that needs it
+/**
+ * Adapt server streaming gRPC service method to controller handler
+ *
+ * Same as {@see adaptGrpcServiceMethodToControllerHandler}, except that the controller handler returns an iterable (or async iterable) of
+ * responses, each of them being adapted and written to the call's stream. Writing follows the flow control of the client, so that the
+ * responses are produced only as fast as the client reads them.
+ *
+ * The controller handler receives, in addition to the request, an object containing an abort `signal` raised when the client cancels the
+ * call, so that handlers waiting for events (for example a watch) can stop without waiting for their next response.
+ *
+ * The stream is not ended by the adapter, so that the trailers can be sent with its end.
+ *
+ * @param {function} controllerHandler the controller handler corresponding to the gRPC service
+ * @param {FieldConverter[]} requestFieldsConverters the list of request field converters
+ * @param {FieldConverter[]} responseFieldsConverters the list of response field converters
+ * @return {function} the function's adapter, resolving once all the responses have been written
+ */
+const adaptGrpcStreamingServiceMethodToControllerHandler = (
+    controllerHandler,
+    requestFieldsConverters,
+    responseFieldsConverters,
+) => async (call) => {
+    const { request } = call;
     for (const { path, toJs } of requestFieldsConverters) {
         mapTreeLeaves(request, path, toJs);
     }
 
-    const response = await controllerHandler(request);
+    const abortController = new AbortController();
+    // eslint-disable-next-line require-jsdoc
+    const onCancelled = () => abortController.abort();
+    call.on('cancelled', onCancelled);
+
+    try {
+        for await (const response of controllerHandler(request, { signal: abortController.signal, identity: call.identity })) {
+            if (call.cancelled) {
+                return;
+            }
+
+            for (const { path, fromJs } of responseFieldsConverters) {
+                mapTreeLeaves(response, path, fromJs);
+            }
+
+            if (!call.write(response)) {
+                await waitForDrainOrCancellation(call);
+            }
+        }
+    } finally {
+        call.off('cancelled', onCancelled);
+    }
+};
+
+/**
+ * Adapt client streaming gRPC service method to controller handler
+ *
+ * Same as {@see adaptGrpcServiceMethodToControllerHandler}, except that the controller handler receives an async iterable of the requests,
+ * each of them being adapted once read, instead of a single request. As for server streaming, it also receives an object containing an abort
+ * `signal` raised when the client cancels the call. The iteration throws if the client cancels the call, so that a partial stream of
+ * requests is never taken for a complete one.
+ *
+ * @param {function} controllerHandler the controller handler corresponding to the gRPC service
+ * @param {FieldConverter[]} requestFieldsConverters the list of request field converters
+ * @param {FieldConverter[]} responseFieldsConverters the list of response field converters
+ * @return {function} the function's adapter
+ */
+const adaptGrpcClientStreamingServiceMethodToControllerHandler = (
+    controllerHandler,
+    requestFieldsConverters,
+    responseFieldsConverters,
+) => async (call) => {
+    /**
+     * Read and adapt the requests of the call
+     *
+     * @return {AsyncGenerator<Object>} the adapted requests
+     */
+    async function* readRequests() {
+        for await (const request of call) {
+            for (const { path, toJs } of requestFieldsConverters) {
+                mapTreeLeaves(request, path, toJs);
+            }
+            yield request;
+        }
+        if (call.cancelled) {
+            throw new Error('The call has been cancelled by the client');
+        }
+    }
+
+    const abortController = new AbortController();
+    // eslint-disable-next-line require-jsdoc
+    const onCancelled = () => abortController.abort();
+    call.on('cancelled', onCancelled);
+
+    let response;
+    try {
+        response = await controllerHandler(readRequests(), { signal: abortController.signal, identity: call.identity });
+    } finally {
+        call.off('cancelled', onCancelled);
+    }
 
     if (typeof response !== 'object' || response === null) {
         return null;
     }
 
-    // Apply the gRPC converter to all the request parameters that needs it
     for (const { path, fromJs } of responseFieldsConverters) {
         mapTreeLeaves(response, path, fromJs);
     }
@@ -98,15 +234,70 @@ const adaptGrpcServiceMethodToControllerHandler = (
     return response;
 };
 
+/**
+ * Run the pre-processors of a call, in order
+ *
+ * @param {Array<function|{process:function}>} preProcessors the pre-processors to run
+ * @param {Object} call the gRPC call
+ * @return {Promise<void>} resolves once all the pre-processors ran
+ */
+const runPreProcessors = async (preProcessors, call) => {
+    for (const preProcessor of preProcessors || []) {
+        await (typeof preProcessor === 'function' ? preProcessor(call) : preProcessor.process(call));
+    }
+};
+
+/**
+ * Handle a call within the trace sent by its client in its `traceparent` metadata, with a span for its pre-processors and one for its
+ * controller, recording the time spent in each of them and in database queries to the given timing
+ *
+ * @param {Object} call the gRPC call
+ * @param {string} path the path of the called method, naming the server span of the call
+ * @param {Array<function|{process:function}>} preProcessors the pre-processors to run before the controller
+ * @param {string} controllerSpanName the name of the controller span
+ * @param {ServerTiming} timing the timing of the call
+ * @param {function(): Promise<*>} runController the controller handling of the call, once pre-processed
+ * @return {Promise<*>} the result of the controller
+ */
+const handleCall = (call, path, preProcessors, controllerSpanName, timing, runController) => runWithServerTiming(
+    timing,
+    () => tracer.runInTrace(call.metadata?.get('traceparent')[0], path, async () => {
+        await timeStage('authMs', () => tracer.withSpan('preProcessors', () => runPreProcessors(preProcessors, call)));
+        return timeStage('handlerMs', () => tracer.withSpan(controllerSpanName, runController));
+    }),
+);
+
+/**
+ * Create the trailers of a call, reporting its timing to the client
+ *
+ * @param {ServerTiming} timing the timing of the call
+ * @return {Metadata} the trailers
+ */
+const createTrailers = (timing) => {
+    const trailers = new Metadata();
+    trailers.set(SERVER_TIMING_METADATA_KEY, formatServerTiming(timing));
+    return trailers;
+};
+
 /**
  * Adapt a controller to be used as implementation for a given service definition
  *
  * For the methods of the given controller that match service methods, the controller's method will be used to handle gRPC request, the call's
- * request will be provided as unique parameter when calling controller's function (it will match the request type specified in the proto) and
- * the controller's response will be returned to the caller (waiting for promises if it applies)
+ * request will be provided as first parameter when calling controller's function (it will match the request type specified in the proto) and
+ * the controller's response will be returned to the caller (waiting for promises if it applies). The second parameter is an object containing
+ * the `identity` of the caller set by the authentication pre-processor, undefined for anonymous calls.
  *
  * Enums are converted from gRPC values to js values using {@see fromGRPCEnum} and conversely using {@see toGRPCEnum}
  *
+ * For server streaming methods, the controller's method must return an iterable (or async iterable, for example an async generator) of
+ * responses. For client streaming methods, it receives an async iterable of the requests instead of a single one.
+ *
+ * Calls whose trace is sampled (see {@see tracer}) are recorded as a server span, child of the client span sent in the `traceparent`
+ * metadata, with a span for the pre-processors and one for the controller method, in which the repositories record their own spans.
+ *
+ * Every call, successful or not, reports in its `server-timing` trailer (formatted as the HTTP Server-Timing header) the time spent waiting
+ * for a database connection (queue), in the pre-processors (auth), in the controller (handler) and in database queries (db).
+ *
  * @param {Object} serviceDefinition the definition of the service to bind
  * @param {Object} implementation the controller instance to use as implementation
  * @param {Array<function|{process:function}>} preProcessors a list of functions (or class containing a `process` function) that need to be run
@@ -117,31 +308,56 @@ const adaptGrpcServiceMethodToControllerHandler = (
 const bindGRPCController = (serviceDefinition, implementation, preProcessors, absoluteMessagesDefinitions) => {
     const serviceImplementations = {};
 
-    for (const [methodName, { requestType, responseType, path }] of Object.entries(serviceDefinition)) {
+    for (const [methodName, { requestType, responseType, requestStream, responseStream, path }] of Object.entries(serviceDefinition)) {
         const requestFieldsConverters = extractFieldsConverters(requestType.type, absoluteMessagesDefinitions);
         const responseFieldsConverters = extractFieldsConverters(responseType.type, absoluteMessagesDefinitions);
+        const controllerSpanName = `${implementation.constructor.name}.${methodName}`;
+
+        if (responseStream) {
+            serviceImplementations[methodName] = async (call) => {
+                const adapter = adaptGrpcStreamingServiceMethodToControllerHandler(
+                    implementation[methodName].bind(implementation),
+                    requestFieldsConverters,
+                    responseFieldsConverters,
+                );
 
+                const timing = createServerTiming();
+                try {
+                    await handleCall(call, path, preProcessors, controllerSpanName, timing, () => adapter(call));
+                } catch (error) {
+                    call.emit('error', { ...nativeToGRPCError(error), metadata: createTrailers(timing) });
+                    return;
+                }
+
+                if (!call.cancelled) {
+                    call.end(createTrailers(timing));
+                }
+            };
+            continue;
+        }
+
+        const adaptControllerHandler = requestStream
+            ? adaptGrpcClientStreamingServiceMethodToControllerHandler
+            : adaptGrpcServiceMethodToControllerHandler;
         serviceImplementations[methodName] = async (call, callback) => {
-            const adapter = adaptGrpcServiceMethodToControllerHandler(
+            const adapter = adaptControllerHandler(
                 implementation[methodName].bind(implementation),
                 requestFieldsConverters,
                 responseFieldsConverters,
             );
 
+            const timing = createServerTiming();
             try {
-                for (const preProcessor of preProcessors || []) {
-                    await (typeof preProcessor === 'function' ? preProcessor(call) : preProcessor.process(call));
-                }
-
-                const response = await adapter(call);
+                const response = await handleCall(call, path, preProcessors, controllerSpanName, timing, () => adapter(call));
 
                 if (response === null) {
-                    callback(nativeToGRPCError(new Error(`Controller for ${path} returned an invalid response`)));
+                    const error = nativeToGRPCError(new Error(`Controller for ${path} returned an invalid response`));
+                    callback({ ...error, metadata: createTrailers(timing) });
                 } else {
-                    callback(null, response);
+                    callback(null, response, createTrailers(timing));
                 }
             } catch (error) {
-                callback(nativeToGRPCError(error));
+                callback({ ...nativeToGRPCError(error), metadata: createTrailers(timing) });
             }
         };
     }
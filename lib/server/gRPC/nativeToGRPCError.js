@@ -14,6 +14,8 @@
 const { ConflictError } = require('../errors/ConflictError.js');
 const { AuthenticatedOnly } = require('../errors/AuthenticatedOnly.js');
 const { InvalidCredentials } = require('../errors/InvalidCredentials');
+const { ResourceExhaustedError } = require('../errors/ResourceExhaustedError.js');
+const { BadParameterError } = require('../errors/BadParameterError.js');
 
 /**
  * Convert a js native error to a GRPC error
@@ -30,6 +32,10 @@ const nativeToGRPCError = (error) => {
         code = 6;
     } else if (error instanceof AuthenticatedOnly || error instanceof InvalidCredentials) {
         code = 16;
+    } else if (error instanceof ResourceExhaustedError) {
+        code = 8;
+    } else if (error instanceof BadParameterError) {
+        code = 3;
     }
 
     return {
@@ -1,11 +1,61 @@
+const { LogManager } = require('@aliceo2/web-ui');
+const { ConnectionError } = require('sequelize');
 const { CtpTriggerCountersRepository } = require('../../../database/repositories');
 const { ctpTriggerCountersAdapter } = require('../../../database/adapters');
 const { getRunOrFail } = require('../run/getRunOrFail.js');
+const { GRPCConfig } = require('../../../config/index.js');
+const { createWriteBehindBuffer } = require('../../../utilities/writeBehindBuffer.js');
+const { ResourceExhaustedError } = require('../../errors/ResourceExhaustedError.js');
+
+/**
+ * Counters updated when a sample is received for an existing (runNumber, className)
+ * @type {string[]}
+ */
+const UPDATED_COUNTERS_FIELDS = ['timestamp', 'lmb', 'lma', 'l0b', 'l0a', 'l1b', 'l1a', 'updatedAt'];
+
+/**
+ * Maximal amount of runs remembered as existing, forgotten all at once when exceeded
+ * @type {number}
+ */
+const MAX_VALIDATED_RUNS = 1000;
 
 /**
  * Service related to trigger counters
  */
 class CtpTriggerCountersService {
+    /**
+     * Constructor
+     *
+     * @param {Object} [configuration] the write-behind configuration of the counters, see {@see GRPCConfig.ctpTriggerCounters}
+     */
+    constructor(configuration) {
+        const { flushIntervalMs, maxPendingCounters, maxBufferedCounters } = configuration || {};
+        this._logger = LogManager.getLogger('CTP-TRIGGER-COUNTERS-SERVICE');
+
+        /**
+         * Runs known to exist, to check only once the run of the many samples of its classes
+         * @type {Set<number>}
+         */
+        this._validatedRunNumbers = new Set();
+
+        this._countersBuffer = createWriteBehindBuffer({
+            write: (counters) => CtpTriggerCountersRepository.upsertAll(counters, UPDATED_COUNTERS_FIELDS),
+            flushIntervalMs,
+            maxPendingEntries: maxPendingCounters,
+            capacity: maxBufferedCounters,
+            // Counters are kept while the database is unreachable, and dropped if the database rejects them
+            isTransientError: (error) => error instanceof ConnectionError,
+            onError: (error, counters, dropped) => {
+                if (dropped) {
+                    const classes = counters.map(({ runNumber, className }) => `${runNumber}/${className}`).join(', ');
+                    this._logger.errorMessage(`Dropped trigger counters of ${classes}, failed to store them: ${error.message}`);
+                } else {
+                    this._logger.errorMessage(`Failed to store ${counters.length} trigger counters, retrying later: ${error.message}`);
+                }
+            },
+        });
+    }
+
     /**
      * Return the list of trigger counters linked to a given run
      *
@@ -13,23 +63,40 @@ class CtpTriggerCountersService {
      * @return {Promise<CtpTriggerCounters[]>} the trigger counters for the run
      */
     async getPerRun(runNumber) {
+        // Read the counters received so far, not only the ones already written
+        await this.flush();
         return (await CtpTriggerCountersRepository.findAll({ where: { runNumber } })).map(ctpTriggerCountersAdapter.toEntity);
     }
 
     /**
      * Create or update trigger counters for a given run
      *
+     * The counters are stored with a delay (see {@see flush}), a sample being replaced by the next one of the same class if it is received
+     * meanwhile. The run is checked to exist only for its first sample.
+     *
+     * Resolving means the counters have been accepted, not stored: the counters received since the last flush are lost if the process crashes
+     * and a sample rejected by the database is only logged. Samples of new classes are refused while too many counters are waiting to be
+     * stored, for example while the database is unreachable.
+     *
      * @param {object} criteria the criteria identifying the counters to update
      * @param {number} criteria.runNumber the run number of run for which trigger counters are created/updated
      * @param {string} criteria.className the run number of run for which trigger counters are created/updated
      * @param {Pick<CtpTriggerCounters, 'timestamp'|'lmb'|'lma'|'l0b'|'l0a'|'l1b'|'l1a'>} counters the actual counters data
-     * @return {Promise<void>} resolves once the counters have been created
+     * @return {Promise<void>} resolves once the counters have been accepted
+     * @throws {ResourceExhaustedError} if too many counters are waiting to be stored
      */
     async createOrUpdatePerRun({ runNumber, className }, counters) {
-        // Check that run exists
-        const run = await getRunOrFail({ runNumber });
-        await CtpTriggerCountersRepository.upsert({
-            runNumber: run.runNumber,
+        if (!this._validatedRunNumbers.has(runNumber)) {
+            // Check that run exists
+            const run = await getRunOrFail({ runNumber });
+            if (this._validatedRunNumbers.size >= MAX_VALIDATED_RUNS) {
+                this._validatedRunNumbers.clear();
+            }
+            this._validatedRunNumbers.add(run.runNumber);
+        }
+
+        const accepted = this._countersBuffer.set(`${runNumber}/${className}`, {
+            runNumber,
             className,
             timestamp: counters.timestamp,
             lmb: counters.lmb,
@@ -39,9 +106,25 @@ class CtpTriggerCountersService {
             l1b: counters.l1b,
             l1a: counters.l1a,
         });
+        if (!accepted) {
+            throw new ResourceExhaustedError('Too many trigger counters are waiting to be stored, retry later');
+        }
+    }
+
+    /**
+     * Store the counters received so far, as multi-row upserts
+     *
+     * Counters are flushed periodically, when too many are waiting, at the end of a run and when the application stops. If the database is
+     * unreachable, the counters are kept for the next flush. If it rejects a batch, its counters are stored one by one and the ones it still
+     * rejects are logged and dropped.
+     *
+     * @return {Promise<void>} resolves once the counters received so far have been stored, kept for the next flush or dropped
+     */
+    flush() {
+        return this._countersBuffer.flush();
     }
 }
 
 exports.CtpTriggerCountersService = CtpTriggerCountersService;
 
-exports.ctpTriggerCountersService = new CtpTriggerCountersService();
+exports.ctpTriggerCountersService = new CtpTriggerCountersService(GRPCConfig.ctpTriggerCounters);
@@ -14,10 +14,12 @@
 const { createLog } = require('./createLog.js');
 const { getLog } = require('./getLog.js');
 const { logAdapter, attachmentAdapter, tagAdapter } = require('../../../database/adapters/index.js');
-const { repositories: { LogRepository, LogLhcFillsRepository } } = require('../../../database');
+const { repositories: { AttachmentRepository, LogRepository, LogLhcFillsRepository } } = require('../../../database');
 const { dataSource } = require('../../../database/DataSource.js');
 const { LogEnvironmentsRepository } = require('../../../database/repositories/index.js');
 const { getLogsByTagsInPeriod } = require('./getLogsByTagsInPeriod.js');
+const { getLogOrFail } = require('./getLogOrFail.js');
+const { writeAttachmentFile } = require('./writeAttachmentFile.js');
 
 /**
  * @typedef LogRelationsToInclude object specifying which log's relations should be fetched alongside the log
@@ -213,6 +215,30 @@ class LogService {
         // No transaction, log is ready here and can not be null
         return this.get(logId);
     }
+
+    /**
+     * Store a file received in chunks and attach it to an existing log
+     *
+     * @param {number} logId the id of the log to which the file is attached
+     * @param {{originalName: string, mimeType: string}} file the name of the file on the uploader side and its MIME type
+     * @param {AsyncIterable<Buffer>} chunks the consecutive chunks of the file content
+     * @return {Promise<Attachment>} resolve with the created attachment
+     */
+    async createAttachment(logId, { originalName, mimeType }, chunks) {
+        await getLogOrFail(logId);
+
+        const { fileName, path, size } = await writeAttachmentFile(originalName, chunks);
+        const attachment = await AttachmentRepository.insert({
+            fileName,
+            originalName,
+            path,
+            size,
+            mimeType,
+            encoding: 'binary',
+            logId,
+        });
+        return attachmentAdapter.toEntity(attachment);
+    }
 }
 
 exports.LogService = LogService;
@@ -0,0 +1,58 @@
+/**
+ * @license
+ * Copyright CERN and copyright holders of ALICE O2. This software is
+ * distributed under the terms of the GNU General Public License v3 (GPL
+ * Version 3), copied verbatim in the file "COPYING".
+ *
+ * See http://alice-o2.web.cern.ch/license for full licensing information.
+ *
+ * In applying this license CERN does not waive the privileges and immunities
+ * granted to it by virtue of its status as an Intergovernmental Organization
+ * or submit itself to any jurisdiction.
+ */
+
+const { createWriteStream } = require('fs');
+const { unlink } = require('fs/promises');
+const { basename, join } = require('path');
+const { pipeline } = require('stream/promises');
+
+/**
+ * @typedef AttachmentFile
+ * @property {string} fileName the name of the stored file
+ * @property {string} path the full path of the stored file
+ * @property {number} size the size of the file, in bytes
+ */
+
+/**
+ * Write the content of an attachment to the attachments directory, as it is received
+ *
+ * The file is named the same way as the attachments uploaded through HTTP. Only the chunks being written are kept in memory, and the
+ * partially written file is removed if reading the chunks fails.
+ *
+ * @param {string} originalName the name of the file on the uploader side
+ * @param {AsyncIterable<Buffer>} chunks the consecutive chunks of the file content
+ * @return {Promise<AttachmentFile>} resolves once the whole content has been written
+ */
+exports.writeAttachmentFile = async (originalName, chunks) => {
+    const fileName = `${Date.now()}_${basename(originalName)}`;
+    const path = join(process.env?.ATTACHMENT_PATH || '/tmp', fileName);
+
+    let size = 0;
+    try {
+        await pipeline(
+            chunks,
+            async function* (source) {
+                for await (const chunk of source) {
+                    size += chunk.length;
+                    yield chunk;
+                }
+            },
+            createWriteStream(path),
+        );
+    } catch (error) {
+        await unlink(path).catch(() => {});
+        throw error;
+    }
+
+    return { fileName, path, size };
+};
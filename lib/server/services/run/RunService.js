@@ -38,6 +38,7 @@ const { getEnvironmentOrFail } = require('../environment/getEnvironmentOrFail.js
 const { EnvironmentConfiguration } = require('../environment/EnvironmentConfiguration.js');
 const { TriggerValue } = require('../../../domain/enums/TriggerValue.js');
 const { flpRoleService } = require('../flp/FlpRoleService.js');
+const { ctpTriggerCountersService } = require('../ctpTriggerCounters/CtpTriggerCountersService.js');
 
 /**
  * @typedef RunIdentifier object to uniquely identify a run
@@ -79,6 +80,12 @@ const { flpRoleService } = require('../flp/FlpRoleService.js');
  */
 const EOR_REASON_CATEGORIES_TO_LOG = ['DETECTORS', 'DETECTOR'];
 
+/**
+ * Amount of runs fetched at once when iterating over many runs
+ * @type {number}
+ */
+const GET_MANY_BATCH_SIZE = 200;
+
 /**
  * Create a log stating the detector's quality change
  *
@@ -196,6 +203,22 @@ class RunService {
         return run ? runAdapter.toEntity(run) : null;
     }
 
+    /**
+     * Find and return the most recent run, the one with the highest run number
+     *
+     * @param {RunRelationsToInclude} [relations] the relations to include
+     * @return {Promise<Run|null>} resolve with the run found or null if there is no run at all
+     */
+    async getLast(relations) {
+        const queryBuilder = dataSource.createQueryBuilder()
+            .orderBy('runNumber', 'DESC')
+            .limit(1);
+        this._getRunQbConfiguration(queryBuilder, relations ?? {});
+
+        const run = await RunRepository.findOne(queryBuilder);
+        return run ? runAdapter.toEntity(run) : null;
+    }
+
     /**
      * Find and return a run by its run number or id, and throws a {@see NotFoundError} if no run is found
      *
@@ -211,6 +234,58 @@ class RunService {
         ));
     }
 
+    /**
+     * Iterate over the runs in a range of run numbers and/or of a given LHC period, in increasing run number order
+     *
+     * Runs are fetched by batches, so that any amount of runs can be iterated over without loading all of them at once
+     *
+     * @param {Object} criteria the criteria of the runs to fetch, at least one of them must be specified
+     * @param {number} [criteria.runNumberFrom] if specified, only runs with a run number higher or equal are fetched
+     * @param {number} [criteria.runNumberTo] if specified, only runs with a run number lower or equal are fetched
+     * @param {string} [criteria.lhcPeriod] if specified, only runs of the LHC period with this name are fetched
+     * @param {RunRelationsToInclude} [relations] the relations to include
+     * @param {number} [batchSize] the amount of runs fetched at once
+     * @return {AsyncGenerator<Run>} the runs
+     * @throws {BadParameterError} if no criteria is specified
+     */
+    async *getMany({ runNumberFrom, runNumberTo, lhcPeriod }, relations, batchSize = GET_MANY_BATCH_SIZE) {
+        if (runNumberFrom === undefined && runNumberTo === undefined && !lhcPeriod) {
+            throw new BadParameterError('At least one of run number range or LHC period must be specified to fetch runs');
+        }
+
+        let lastRunNumber = null;
+        while (true) {
+            const queryBuilder = dataSource.createQueryBuilder()
+                .orderBy('runNumber', 'ASC')
+                .limit(batchSize);
+            this._getRunQbConfiguration(queryBuilder, relations ?? {});
+
+            // Resume after the last run of the previous batch rather than using an offset, which gets slower with each batch
+            if (lastRunNumber !== null) {
+                queryBuilder.where('runNumber').greaterThan(lastRunNumber, true);
+            }
+            if (runNumberFrom !== undefined) {
+                queryBuilder.where('runNumber').greaterThan(runNumberFrom, false);
+            }
+            if (runNumberTo !== undefined) {
+                queryBuilder.where('runNumber').lowerThan(runNumberTo, false);
+            }
+            if (lhcPeriod) {
+                queryBuilder.whereAssociation('lhcPeriod', 'name').is(lhcPeriod);
+            }
+
+            const runs = await RunRepository.findAll(queryBuilder);
+            for (const run of runs) {
+                yield runAdapter.toEntity(run);
+            }
+
+            if (runs.length < batchSize) {
+                return;
+            }
+            lastRunNumber = runs[runs.length - 1].runNumber;
+        }
+    }
+
     /**
      * Create or Update a run by its run number, using environment info if it applies
      *
@@ -411,6 +486,12 @@ class RunService {
             }
         }, { transaction });
 
+        // Store the trigger counters buffered for an ending run right away, unless in a transaction of the caller that the counters of
+        // the other runs must not depend on
+        if (!transaction && (runPatch.timeO2End || runPatch.timeTrgEnd)) {
+            await ctpTriggerCountersService.flush();
+        }
+
         return this.get(identifier, { tags: true, runType: true, detectors: true, eorReasons: true, lhcPeriod: true });
     }
 
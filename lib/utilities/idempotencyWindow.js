@@ -0,0 +1,109 @@
+/**
+ *  @license
+ *  Copyright CERN and copyright holders of ALICE O2. This software is
+ *  distributed under the terms of the GNU General Public License v3 (GPL
+ *  Version 3), copied verbatim in the file "COPYING".
+ *
+ *  See http://alice-o2.web.cern.ch/license for full licensing information.
+ *
+ *  In applying this license CERN does not waive the privileges and immunities
+ *  granted to it by virtue of its status as an Intergovernmental Organization
+ *  or submit itself to any jurisdiction.
+ */
+
+const { createHash } = require('crypto');
+
+/**
+ * Default duration, in milliseconds, during which an idempotency key is remembered
+ * @type {number}
+ */
+const DEFAULT_WINDOW_MS = 10 * 60 * 1000;
+
+/**
+ * Default maximum amount of idempotency keys remembered at once
+ * @type {number}
+ */
+const DEFAULT_MAX_KEYS = 100000;
+
+/**
+ * Create a deduplication window, in which operations run with the same idempotency key are only run once
+ *
+ * An operation run with a key already used less than `windowMs` ago is not run again, the result of the first one is returned instead (even
+ * if it is still in progress). Operations that fail are forgotten so that they can be retried with the same key, and operations without key
+ * are always run.
+ *
+ * Keys are only remembered in the memory of this process: the window does not deduplicate the operations sent to another server, nor the
+ * ones received after a restart. Clients must therefore send the retries of a keyed request to the server of its first attempt.
+ *
+ * @param {Object} [configuration={}] the window configuration
+ * @param {number} [configuration.windowMs] duration, in milliseconds, during which a key is remembered
+ * @param {number} [configuration.maxKeys] maximum amount of keys remembered, the oldest ones are forgotten first
+ * @param {function(): number} [configuration.now] the clock to use, returning a timestamp in milliseconds
+ * @return {function(string|undefined, function(): Promise<*>): Promise<*>} function running a given operation with a given key
+ */
+exports.createIdempotencyWindow = (configuration) => {
+    const {
+        windowMs = DEFAULT_WINDOW_MS,
+        maxKeys = DEFAULT_MAX_KEYS,
+        now = Date.now,
+    } = configuration || {};
+
+    /**
+     * Result promise and expiration timestamp per key, in insertion (hence expiration) order
+     * @type {Map<string, {result: Promise<*>, expiresAt: number}>}
+     */
+    const entries = new Map();
+
+    return async (idempotencyKey, operation) => {
+        if (!idempotencyKey) {
+            return operation();
+        }
+
+        const currentTime = now();
+        for (const [key, { expiresAt }] of entries) {
+            if (expiresAt > currentTime) {
+                break;
+            }
+            entries.delete(key);
+        }
+
+        const existingEntry = entries.get(idempotencyKey);
+        if (existingEntry) {
+            return existingEntry.result;
+        }
+
+        for (const key of entries.keys()) {
+            if (entries.size < maxKeys) {
+                break;
+            }
+            entries.delete(key);
+        }
+
+        const entry = { result: Promise.resolve().then(operation), expiresAt: currentTime + windowMs };
+        entries.set(idempotencyKey, entry);
+        entry.result.catch(() => {
+            if (entries.get(idempotencyKey) === entry) {
+                entries.delete(idempotencyKey);
+            }
+        });
+        return entry.result;
+    };
+};
+
+/**
+ * Scope an idempotency key to the method it has been sent to and to the identity of its caller, so that the same key sent to another method
+ * or by another caller is not taken for a retry and given the result of someone else's operation
+ *
+ * @param {string} methodName the name of the method the key has been sent to
+ * @param {Object|undefined} identity the identity of the caller set by the authentication, undefined for anonymous calls
+ * @param {string|undefined} idempotencyKey the key sent by the caller, if any
+ * @return {string|undefined} the scoped key, undefined if no key has been sent
+ */
+exports.scopeIdempotencyKey = (methodName, identity, idempotencyKey) => {
+    if (!idempotencyKey) {
+        return undefined;
+    }
+    // Hashed, as the identity may be large and must not be kept in clear in memory
+    const caller = identity ? createHash('sha256').update(JSON.stringify(identity)).digest('base64') : 'anonymous';
+    return `${methodName}:${caller}:${idempotencyKey}`;
+};
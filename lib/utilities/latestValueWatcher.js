@@ -0,0 +1,153 @@
+/**
+ *  @license
+ *  Copyright CERN and copyright holders of ALICE O2. This software is
+ *  distributed under the terms of the GNU General Public License v3 (GPL
+ *  Version 3), copied verbatim in the file "COPYING".
+ *
+ *  See http://alice-o2.web.cern.ch/license for full licensing information.
+ *
+ *  In applying this license CERN does not waive the privileges and immunities
+ *  granted to it by virtue of its status as an Intergovernmental Organization
+ *  or submit itself to any jurisdiction.
+ */
+
+/**
+ * Default interval, in milliseconds, between two fetches of the watched value
+ * @type {number}
+ */
+const DEFAULT_POLL_INTERVAL_MS = 1000;
+
+/**
+ * Default key of a value, changing whenever any of its properties changes
+ *
+ * @param {*} value the value
+ * @return {string} the key
+ */
+const defaultToKey = (value) => JSON.stringify(value, (_, item) => typeof item === 'bigint' ? item.toString() : item);
+
+/**
+ * Create a watcher of the latest version of a value, shared between all its subscribers
+ *
+ * While there is at least one subscriber, the value is fetched every `pollIntervalMs` by a single loop, whatever the amount of subscribers,
+ * and each subscriber is given the new value when it changed. The loop stops with the last subscriber, and starts again with the next one.
+ *
+ * @param {function(): Promise<*>} fetchLatest function fetching the current version of the value
+ * @param {Object} [configuration={}] the watcher configuration
+ * @param {number} [configuration.pollIntervalMs] interval, in milliseconds, between two fetches
+ * @param {function(*): string} [configuration.toKey] function returning a key identifying a version of the value, the value is considered
+ *     changed when its key changes
+ * @param {function(Error): void} [configuration.onError] called when a periodic fetch fails, the previous value is then kept
+ * @return {function(AbortSignal=): AsyncGenerator<*>} function returning the value followed by each of its changes, until the given signal
+ *     is aborted
+ */
+exports.createLatestValueWatcher = (fetchLatest, configuration) => {
+    const {
+        pollIntervalMs = DEFAULT_POLL_INTERVAL_MS,
+        toKey = defaultToKey,
+        onError = () => {},
+    } = configuration || {};
+
+    /**
+     * Functions waking up each subscriber waiting for a change
+     * @type {Set<function(): void>}
+     */
+    const subscribers = new Set();
+
+    /**
+     * @type {{value: *, key: string}|null}
+     */
+    let latest = null;
+
+    /**
+     * Promise of the first fetch of the current polling loop, null if the loop is stopped
+     * @type {Promise<void>|null}
+     */
+    let started = null;
+    let timer = null;
+
+    /**
+     * Fetch the value and wake up the subscribers if it changed
+     *
+     * @return {Promise<void>} resolves once the value has been fetched
+     */
+    const poll = async () => {
+        try {
+            const value = await fetchLatest();
+            const key = toKey(value);
+            if (latest?.key !== key) {
+                latest = { value, key };
+                for (const wake of subscribers) {
+                    wake();
+                }
+            }
+        } catch (error) {
+            onError(error);
+        }
+    };
+
+    /**
+     * Schedule the next fetch, or stop the loop if there is no subscriber left
+     *
+     * @return {void}
+     */
+    const scheduleNextPoll = () => {
+        if (subscribers.size === 0) {
+            started = null;
+            return;
+        }
+        timer = setTimeout(async () => {
+            timer = null;
+            await poll();
+            scheduleNextPoll();
+        }, pollIntervalMs);
+    };
+
+    /**
+     * Remove a subscriber, and stop the loop if it was the last one
+     *
+     * @param {function(): void} wake the subscriber to remove
+     * @return {void}
+     */
+    const unsubscribe = (wake) => {
+        subscribers.delete(wake);
+        if (subscribers.size === 0 && timer !== null) {
+            clearTimeout(timer);
+            timer = null;
+            started = null;
+        }
+    };
+
+    return async function* watch(signal) {
+        let wakeUp = null;
+        // eslint-disable-next-line require-jsdoc
+        const wake = () => wakeUp?.();
+        subscribers.add(wake);
+
+        try {
+            if (!started) {
+                // The value kept since the previous loop may be outdated
+                latest = null;
+                started = poll().then(scheduleNextPoll);
+            }
+            await started;
+
+            let yieldedKey = null;
+            while (!signal?.aborted) {
+                if (latest !== null && latest.key !== yieldedKey) {
+                    yieldedKey = latest.key;
+                    yield latest.value;
+                    continue;
+                }
+
+                await new Promise((resolve) => {
+                    wakeUp = resolve;
+                    signal?.addEventListener('abort', resolve, { once: true });
+                });
+                signal?.removeEventListener('abort', wakeUp);
+                wakeUp = null;
+            }
+        } finally {
+            unsubscribe(wake);
+        }
+    };
+};
@@ -0,0 +1,125 @@
+/**
+ *  @license
+ *  Copyright CERN and copyright holders of ALICE O2. This software is
+ *  distributed under the terms of the GNU General Public License v3 (GPL
+ *  Version 3), copied verbatim in the file "COPYING".
+ *
+ *  See http://alice-o2.web.cern.ch/license for full licensing information.
+ *
+ *  In applying this license CERN does not waive the privileges and immunities
+ *  granted to it by virtue of its status as an Intergovernmental Organization
+ *  or submit itself to any jurisdiction.
+ */
+
+const { AsyncLocalStorage } = require('async_hooks');
+const { performance } = require('perf_hooks');
+
+/**
+ * Time spent by the server in the stages of a call, in milliseconds
+ *
+ * @typedef ServerTiming
+ * @property {number} queueMs the time spent waiting for a database connection from the pool
+ * @property {number} authMs the time spent running the pre-processors of the call, which authenticate it
+ * @property {number} handlerMs the time spent running the controller, database queries included
+ * @property {number} dbMs the time spent running database queries
+ */
+
+/**
+ * Name of the trailer metadata in which the timing of a call is sent back to its client
+ * @type {string}
+ */
+exports.SERVER_TIMING_METADATA_KEY = 'server-timing';
+
+/**
+ * Timing of the call being handled in the current asynchronous context
+ * @type {AsyncLocalStorage<ServerTiming>}
+ */
+const serverTimingStorage = new AsyncLocalStorage();
+
+/**
+ * Create the timing of a call, before its handling starts
+ *
+ * @return {ServerTiming} the timing, with all the stages at 0
+ */
+exports.createServerTiming = () => ({ queueMs: 0, authMs: 0, handlerMs: 0, dbMs: 0 });
+
+/**
+ * Run the handling of a call, the time spent in its stages and database queries being added to the given timing
+ *
+ * @param {ServerTiming} timing the timing of the call
+ * @param {function(): Promise<*>} operation the handling of the call
+ * @return {Promise<*>} the result of the operation
+ */
+exports.runWithServerTiming = (timing, operation) => serverTimingStorage.run(timing, operation);
+
+/**
+ * Run a stage of the call being handled, adding its duration to the timing of the call if there is one
+ *
+ * @param {'authMs'|'handlerMs'} stage the stage of the call
+ * @param {function(): Promise<*>} operation the stage of the call
+ * @return {Promise<*>} the result of the operation
+ */
+exports.timeStage = async (stage, operation) => {
+    const timing = serverTimingStorage.getStore();
+    const start = performance.now();
+    try {
+        return await operation();
+    } finally {
+        if (timing) {
+            timing[stage] += performance.now() - start;
+        }
+    }
+};
+
+/**
+ * Add to the timing of the calls the time their queries wait for a database connection and run
+ *
+ * @param {Sequelize} sequelize the sequelize instance running the queries
+ * @return {void}
+ */
+exports.recordDatabaseTiming = (sequelize) => {
+    // Keyed by the options of the query for the pool acquisition, which has no query object yet, and by the query for its run
+    const acquisitionsStart = new WeakMap();
+    const queriesStart = new WeakMap();
+
+    sequelize.addHook('beforePoolAcquire', (options) => {
+        const timing = serverTimingStorage.getStore();
+        if (timing && options) {
+            acquisitionsStart.set(options, { timing, start: performance.now() });
+        }
+    });
+    sequelize.addHook('afterPoolAcquire', (_connection, options) => {
+        const acquisition = options && acquisitionsStart.get(options);
+        if (acquisition) {
+            acquisitionsStart.delete(options);
+            acquisition.timing.queueMs += performance.now() - acquisition.start;
+        }
+    });
+
+    sequelize.addHook('beforeQuery', (_options, query) => {
+        const timing = serverTimingStorage.getStore();
+        if (timing) {
+            queriesStart.set(query, { timing, start: performance.now() });
+        }
+    });
+    sequelize.addHook('afterQuery', (_options, query) => {
+        const run = queriesStart.get(query);
+        if (run) {
+            queriesStart.delete(query);
+            run.timing.dbMs += performance.now() - run.start;
+        }
+    });
+};
+
+/**
+ * Format the timing of a call as a Server-Timing header value, for example `queue;dur=0.02, auth;dur=1.3, handler;dur=12.25, db;dur=9.8`
+ *
+ * @param {ServerTiming} timing the timing of the call
+ * @return {string} the formatted timing, durations being in milliseconds with at most 3 decimals
+ */
+exports.formatServerTiming = ({ queueMs, authMs, handlerMs, dbMs }) => [
+    ['queue', queueMs],
+    ['auth', authMs],
+    ['handler', handlerMs],
+    ['db', dbMs],
+].map(([name, durationMs]) => `${name};dur=${Number(durationMs.toFixed(3))}`).join(', ');
@@ -0,0 +1,253 @@
+/**
+ *  @license
+ *  Copyright CERN and copyright holders of ALICE O2. This software is
+ *  distributed under the terms of the GNU General Public License v3 (GPL
+ *  Version 3), copied verbatim in the file "COPYING".
+ *
+ *  See http://alice-o2.web.cern.ch/license for full licensing information.
+ *
+ *  In applying this license CERN does not waive the privileges and immunities
+ *  granted to it by virtue of its status as an Intergovernmental Organization
+ *  or submit itself to any jurisdiction.
+ */
+
+const { AsyncLocalStorage } = require('async_hooks');
+const { randomBytes } = require('crypto');
+const { appendFile } = require('fs/promises');
+const { performance } = require('perf_hooks');
+const { GRPCConfig } = require('../config/index.js');
+
+/**
+ * Span recorded by a tracer
+ *
+ * @typedef Span
+ * @property {string} traceId the 32 hexadecimal characters identifying the trace
+ * @property {string} spanId the 16 hexadecimal characters identifying the span
+ * @property {string|null} parentSpanId the span in which this one has been started, null for the root of a trace
+ * @property {string} name the name of the traced operation
+ * @property {string} kind 'server' for the handling of a call, 'internal' for its stages
+ * @property {number} startUs the start of the span, in microseconds since epoch
+ * @property {number} durationUs the duration of the span, in microseconds
+ * @property {string|null} error the message of the error which ended the span, if any
+ */
+
+/**
+ * Parse a W3C trace context (version 00 `traceparent` header)
+ *
+ * @param {string|undefined} traceparent the trace context, formatted as `00-<32 hex trace id>-<16 hex parent span id>-<2 hex flags>`
+ * @return {{traceId: string, parentSpanId: string, sampled: boolean}|null} the parsed trace context, null if it is missing or invalid
+ */
+const parseTraceparent = (traceparent) => {
+    const match = /^00-([0-9a-f]{32})-([0-9a-f]{16})-([0-9a-f]{2})$/.exec(traceparent ?? '');
+    if (!match || /^0+$/.test(match[1]) || /^0+$/.test(match[2])) {
+        return null;
+    }
+
+    const [, traceId, parentSpanId, flags] = match;
+    return { traceId, parentSpanId, sampled: (parseInt(flags, 16) & 0x01) === 1 };
+};
+
+exports.parseTraceparent = parseTraceparent;
+
+/**
+ * Return the current time in microseconds since epoch, with a sub-millisecond resolution
+ *
+ * @return {number} the current time
+ */
+const nowUs = () => Math.round((performance.timeOrigin + performance.now()) * 1000);
+
+/**
+ * Create a tracer recording the spans of the calls whose trace is sampled
+ *
+ * A call carrying the trace context of its client follows the sampling decision of the client, the other ones start a new trace sampled with a
+ * probability of `sampleRatio`. Within a sampled trace, the spans started by {@see withSpan}, even through asynchronous operations, are
+ * children of the innermost span in progress. Outside of a sampled trace, operations are run as is, so that tracing costs nearly nothing
+ * when disabled.
+ *
+ * @param {Object} [configuration={}] the tracer configuration
+ * @param {number} [configuration.sampleRatio=0] the fraction of the new traces which are sampled
+ * @param {{export: function(Span): void}|null} [configuration.exporter=null] the exporter of the ended spans, no trace is recorded without
+ * @return {{enabled: boolean, runInTrace: function, withSpan: function}} the tracer
+ */
+exports.createTracer = (configuration) => {
+    const { sampleRatio = 0, exporter = null } = configuration || {};
+    const storage = new AsyncLocalStorage();
+
+    /**
+     * Run an operation in a new span, ending it once the operation (or the promise it returns) completes
+     *
+     * @param {{traceId: string, parentSpanId: string|null}} context the trace of the span and its parent
+     * @param {string} name the name of the span
+     * @param {string} kind the kind of the span
+     * @param {function(): *} operation the operation to run
+     * @return {*} the result of the operation
+     */
+    const runInSpan = ({ traceId, parentSpanId }, name, kind, operation) => {
+        const spanId = randomBytes(8).toString('hex');
+        const startUs = nowUs();
+
+        // eslint-disable-next-line require-jsdoc
+        const end = (error) => exporter.export({
+            traceId,
+            spanId,
+            parentSpanId,
+            name,
+            kind,
+            startUs,
+            durationUs: nowUs() - startUs,
+            error: error ? error.message ?? String(error) : null,
+        });
+
+        let result;
+        try {
+            result = storage.run({ traceId, spanId }, operation);
+        } catch (error) {
+            end(error);
+            throw error;
+        }
+
+        if (typeof result?.then !== 'function') {
+            end(null);
+            return result;
+        }
+        return result.then(
+            (value) => {
+                end(null);
+                return value;
+            },
+            (error) => {
+                end(error);
+                throw error;
+            },
+        );
+    };
+
+    return {
+        enabled: exporter !== null,
+
+        /**
+         * Run the handling of a call as the root span of its server side, if the trace of the call is sampled
+         *
+         * @param {string|undefined} traceparent the trace context sent by the client, if any
+         * @param {string} name the name of the span, for example the path of the gRPC method
+         * @param {function(): *} operation the handling of the call
+         * @return {*} the result of the operation
+         */
+        runInTrace: (traceparent, name, operation) => {
+            if (!exporter) {
+                return operation();
+            }
+
+            const parent = parseTraceparent(traceparent);
+            const sampled = parent ? parent.sampled : Math.random() < sampleRatio;
+            if (!sampled) {
+                return operation();
+            }
+
+            const traceId = parent?.traceId ?? randomBytes(16).toString('hex');
+            return runInSpan({ traceId, parentSpanId: parent?.parentSpanId ?? null }, name, 'server', operation);
+        },
+
+        /**
+         * Run a stage of the handling of a call as a child of the current span, if it is traced
+         *
+         * @param {string} name the name of the span
+         * @param {function(): *} operation the stage to run
+         * @return {*} the result of the operation
+         */
+        withSpan: (name, operation) => {
+            const current = storage.getStore();
+            if (!current) {
+                return operation();
+            }
+
+            return runInSpan({ traceId: current.traceId, parentSpanId: current.spanId }, name, 'internal', operation);
+        },
+    };
+};
+
+/**
+ * Create an exporter appending spans as JSON lines to a file
+ *
+ * Spans are buffered and written by batches every `flushIntervalMs`, or as soon as half of `maxBufferedSpans` are waiting. Spans exported
+ * while `maxBufferedSpans` are already buffered or being written are dropped, so that a slow disk never slows down the calls.
+ *
+ * @param {string} path the path of the file
+ * @param {Object} [configuration={}] the exporter configuration
+ * @param {number} [configuration.flushIntervalMs=1000] the maximal delay, in milliseconds, before a span is written
+ * @param {number} [configuration.maxBufferedSpans=10000] the maximal amount of spans buffered or being written
+ * @return {{export: function(Span): void, flush: function(): Promise<void>}} the exporter
+ */
+exports.createJsonLinesSpanExporter = (path, configuration) => {
+    const { flushIntervalMs = 1000, maxBufferedSpans = 10000 } = configuration || {};
+
+    let buffered = [];
+    // Spans buffered or being written
+    let pendingSpans = 0;
+    let writing = Promise.resolve();
+
+    // eslint-disable-next-line require-jsdoc
+    const flush = () => {
+        if (buffered.length > 0) {
+            const lines = buffered;
+            buffered = [];
+            writing = writing
+                .then(() => appendFile(path, lines.join('')))
+                // Tracing must never fail the calls, losing a batch of spans is acceptable
+                .catch(() => null)
+                .then(() => {
+                    pendingSpans -= lines.length;
+                });
+        }
+        return writing;
+    };
+
+    setInterval(flush, flushIntervalMs).unref();
+
+    return {
+        export: (span) => {
+            if (pendingSpans >= maxBufferedSpans) {
+                return;
+            }
+            buffered.push(`${JSON.stringify(span)}\n`);
+            pendingSpans++;
+            if (buffered.length >= maxBufferedSpans / 2) {
+                flush();
+            }
+        },
+        flush,
+    };
+};
+
+/**
+ * Wrap every method of an object, including the inherited ones, so that each of their calls is a span named `<prefix>.<method>`
+ *
+ * @param {Object} target the object whose methods are traced, updated in place
+ * @param {string} prefix the prefix of the spans names, for example the class of the object
+ * @param {{withSpan: function}} tracer the tracer recording the spans
+ * @return {void}
+ */
+exports.traceMethods = (target, prefix, tracer) => {
+    let prototype = Object.getPrototypeOf(target);
+    while (prototype && prototype !== Object.prototype) {
+        for (const [name, { value }] of Object.entries(Object.getOwnPropertyDescriptors(prototype))) {
+            // Overridden methods are wrapped when met in the subclass, first in the prototype chain
+            if (name === 'constructor' || typeof value !== 'function' || Object.prototype.hasOwnProperty.call(target, name)) {
+                continue;
+            }
+            const method = target[name];
+            target[name] = (...args) => tracer.withSpan(`${prefix}.${name}`, () => method.apply(target, args));
+        }
+        prototype = Object.getPrototypeOf(prototype);
+    }
+};
+
+/**
+ * Tracer of the gRPC calls handled by the server, configured by {@see GRPCConfig.tracing}
+ */
+exports.tracer = exports.createTracer({
+    sampleRatio: GRPCConfig.tracing.sampleRatio,
+    exporter: GRPCConfig.tracing.exportPath
+        ? exports.createJsonLinesSpanExporter(GRPCConfig.tracing.exportPath, GRPCConfig.tracing)
+        : null,
+});
@@ -0,0 +1,144 @@
+/**
+ *  @license
+ *  Copyright CERN and copyright holders of ALICE O2. This software is
+ *  distributed under the terms of the GNU General Public License v3 (GPL
+ *  Version 3), copied verbatim in the file "COPYING".
+ *
+ *  See http://alice-o2.web.cern.ch/license for full licensing information.
+ *
+ *  In applying this license CERN does not waive the privileges and immunities
+ *  granted to it by virtue of its status as an Intergovernmental Organization
+ *  or submit itself to any jurisdiction.
+ */
+
+/**
+ * Create a write-behind buffer, keeping the latest value per key in memory and writing them by batches
+ *
+ * Values are written every `flushIntervalMs`, or as soon as `maxPendingEntries` distinct keys are waiting. A value replaced before being
+ * written is never written. Flushes are run one after the other and never fail: if a batch can not be written because of a transient error
+ * (for example the database being unreachable), its values are kept to be written with the next batch (unless replaced meanwhile). Otherwise,
+ * its values are written one by one and the ones which still fail are dropped, so that a value always rejected can not block the others. In
+ * both cases the errors are given to `onError`.
+ *
+ * At most `capacity` values are kept in memory, including the ones being written: new keys are refused once it is reached, for example while
+ * the database is unreachable. Values are only in memory until written, those waiting are lost if the process stops without flushing.
+ *
+ * @param {Object} configuration the buffer configuration
+ * @param {function(Array<*>): Promise<void>} configuration.write the function writing a batch of values
+ * @param {number} [configuration.flushIntervalMs=1000] the maximal delay, in milliseconds, before a value is written
+ * @param {number} [configuration.maxPendingEntries=10000] the amount of keys waiting which triggers a flush
+ * @param {number} [configuration.capacity=10*maxPendingEntries] the maximal amount of values kept in memory
+ * @param {function(Error): boolean} [configuration.isTransientError] states if a write error is transient, the values being then kept
+ * @param {function(Error, Array<*>): void} [configuration.onError] called with the errors of the writes which failed and the values they
+ *     concerned, and if these values have been dropped
+ * @return {{set: function(string, *): boolean, flush: function(): Promise<void>}} the buffer, whose `set` returns false if the value has been
+ *     refused because the buffer is full
+ */
+exports.createWriteBehindBuffer = (configuration) => {
+    const {
+        write,
+        flushIntervalMs = 1000,
+        maxPendingEntries = 10000,
+        capacity = 10 * maxPendingEntries,
+        isTransientError = () => false,
+        onError = () => null,
+    } = configuration;
+
+    /**
+     * Values waiting to be written, per key
+     * @type {Map<string, *>}
+     */
+    let pending = new Map();
+    // Amount of values being written, still counted in the buffer capacity
+    let writingCount = 0;
+    let flushing = Promise.resolve();
+    // Flush waiting for the previous one to be over, which will also write the values set meanwhile
+    let queuedFlush = null;
+
+    /**
+     * Keep values which could not be written to be written with the next batch, unless replaced meanwhile
+     *
+     * @param {Iterable<[string, *]>} entries the entries to keep
+     * @return {void}
+     */
+    const keep = (entries) => {
+        for (const [key, value] of entries) {
+            if (!pending.has(key)) {
+                pending.set(key, value);
+            }
+        }
+    };
+
+    /**
+     * Write a batch whose bulk write failed one value at a time, dropping the values which can not be written
+     *
+     * @param {Map<string, *>} batch the batch to write
+     * @return {Promise<void>} resolves once every value has been written, kept or dropped
+     */
+    const writeOneByOne = async (batch) => {
+        for (const [key, value] of batch) {
+            try {
+                await write([value]);
+            } catch (error) {
+                const dropped = !isTransientError(error);
+                if (!dropped) {
+                    keep([[key, value]]);
+                }
+                onError(error, [value], dropped);
+            }
+        }
+    };
+
+    /**
+     * Write the values currently waiting, once the previous flush is over
+     *
+     * @return {Promise<void>} resolves once they have been written, kept for the next flush or dropped
+     */
+    const flush = () => {
+        if (queuedFlush) {
+            return queuedFlush;
+        }
+
+        queuedFlush = flushing.then(async () => {
+            queuedFlush = null;
+            if (pending.size === 0) {
+                return;
+            }
+
+            const batch = pending;
+            pending = new Map();
+            writingCount = batch.size;
+            try {
+                await write([...batch.values()]);
+            } catch (error) {
+                if (isTransientError(error)) {
+                    keep(batch);
+                    onError(error, [...batch.values()], false);
+                } else {
+                    await writeOneByOne(batch);
+                }
+            } finally {
+                writingCount = 0;
+            }
+        });
+        flushing = queuedFlush;
+        return flushing;
+    };
+
+    setInterval(flush, flushIntervalMs).unref();
+
+    return {
+        set: (key, value) => {
+            if (!pending.has(key) && pending.size + writingCount >= capacity) {
+                return false;
+            }
+
+            pending.set(key, value);
+            if (pending.size >= maxPendingEntries) {
+                flush();
+            }
+            return true;
+        },
+        flush,
+    };
+};
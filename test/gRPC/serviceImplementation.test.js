@@ -20,6 +20,8 @@ const { extractAbsoluteMessageDefinitions } = require('../../lib/server/gRPC/ser
 const sinon = require('sinon');
 const { bindGRPCController } = require('../../lib/server/gRPC/bindGRPCController.js');
 const { Long } = require('@grpc/proto-loader');
+const { EventEmitter } = require('events');
+const { Readable } = require('stream');
 
 const PROTO_DIR = `${__dirname}/proto`;
 
@@ -154,4 +156,200 @@ module.exports = () => {
             message: 'Controller for /test.Service/TestEnums returned an invalid response',
         })).to.be.true;
     });
+
+    it('should successfully send the timing of the call in its trailers, whatever its outcome', async () => {
+        const serverTimingPattern = /^queue;dur=[\d.]+, auth;dur=[\d.]+, handler;dur=[\d.]+, db;dur=[\d.]+$/;
+        const controller = {
+            TestEnums: async () => {
+                await new Promise((resolve) => setTimeout(resolve, 10));
+                return {};
+            },
+            TestBigInts: () => {
+                throw new Error('Controller failed');
+            },
+            TestRepeated: sinon.fake(),
+        };
+        const adapter = bindGRPCController(proto.Service.service, controller, [], absoluteMessagesDefinitions);
+
+        const callback = sinon.fake();
+        await adapter.TestEnums({ request: {} }, callback);
+        const [error, , trailers] = callback.firstCall.args;
+        expect(error).to.be.null;
+        const [serverTiming] = trailers.get('server-timing');
+        expect(serverTiming).to.match(serverTimingPattern);
+        expect(Number(/handler;dur=([\d.]+)/.exec(serverTiming)[1])).to.be.at.least(9);
+
+        const failedCallback = sinon.fake();
+        await adapter.TestBigInts({ request: {} }, failedCallback);
+        const [failure] = failedCallback.firstCall.args;
+        expect(failure.message).to.equal('Controller failed');
+        expect(failure.metadata.get('server-timing')[0]).to.match(serverTimingPattern);
+    });
+
+    describe('Server streaming', () => {
+        /**
+         * Create a fake server stream call, recording the written responses
+         *
+         * @param {Object} request the request of the call
+         * @return {EventEmitter} the fake call
+         */
+        const createStreamCall = (request) => {
+            const call = new EventEmitter();
+            call.request = request;
+            call.cancelled = false;
+            call.written = [];
+            call.write = (response) => {
+                call.written.push(response);
+                return true;
+            };
+            call.end = sinon.fake();
+            return call;
+        };
+
+        it('should successfully write every response of the controller and end the stream', async () => {
+            const controller = {
+                // eslint-disable-next-line require-jsdoc
+                async *TestStream() {
+                    yield { ui: 0xFEDCBA9876543210n, i: -0x76543210FEDCBA98n };
+                    yield { ui: 0xFEDCBA9876543210n, i: -0x76543210FEDCBA98n };
+                },
+            };
+            const adapter = bindGRPCController(proto.Service.service, controller, [], absoluteMessagesDefinitions);
+            const call = createStreamCall({});
+
+            await adapter.TestStream(call);
+
+            expect(call.written).to.have.lengthOf(2);
+            for (const response of call.written) {
+                expect(response.ui.equals(Long.fromString('FEDCBA9876543210', true, 16))).to.be.true;
+                expect(response.i.equals(Long.fromString('-76543210FEDCBA98', false, 16))).to.be.true;
+            }
+            sinon.assert.calledOnce(call.end);
+            expect(call.end.firstCall.args[0].get('server-timing')).to.have.lengthOf(1);
+        });
+
+        it('should successfully stop writing when the client cancelled the call', async () => {
+            const call = createStreamCall({});
+            const controller = {
+                // eslint-disable-next-line require-jsdoc
+                async *TestStream() {
+                    yield { ui: 1n, i: 1n };
+                    call.cancelled = true;
+                    yield { ui: 2n, i: 2n };
+                },
+            };
+            const adapter = bindGRPCController(proto.Service.service, controller, [], absoluteMessagesDefinitions);
+
+            await adapter.TestStream(call);
+
+            expect(call.written).to.have.lengthOf(1);
+            sinon.assert.notCalled(call.end);
+        });
+
+        it('should successfully abort the signal given to the controller when the client cancels the call', async () => {
+            const call = createStreamCall({});
+            let signal;
+            const controller = {
+                // eslint-disable-next-line require-jsdoc
+                async *TestStream(_, options) {
+                    ({ signal } = options);
+                    yield { ui: 1n, i: 1n };
+                    await new Promise((resolve) => signal.addEventListener('abort', resolve));
+                },
+            };
+            const adapter = bindGRPCController(proto.Service.service, controller, [], absoluteMessagesDefinitions);
+
+            const done = adapter.TestStream(call);
+            await new Promise((resolve) => setImmediate(resolve));
+            expect(signal.aborted).to.be.false;
+
+            call.cancelled = true;
+            call.emit('cancelled');
+            await done;
+
+            expect(signal.aborted).to.be.true;
+            expect(call.written).to.have.lengthOf(1);
+            sinon.assert.notCalled(call.end);
+            expect(call.listenerCount('cancelled')).to.equal(0);
+        });
+
+        it('should successfully convert controller errors to a stream error', async () => {
+            const controller = {
+                // eslint-disable-next-line require-jsdoc
+                async *TestStream() {
+                    yield { ui: 1n, i: 1n };
+                    throw new Error('Fetch failed');
+                },
+            };
+            const adapter = bindGRPCController(proto.Service.service, controller, [], absoluteMessagesDefinitions);
+            const call = createStreamCall({});
+            const onError = sinon.fake();
+            call.on('error', onError);
+
+            await adapter.TestStream(call);
+
+            expect(call.written).to.have.lengthOf(1);
+            sinon.assert.calledWithMatch(onError, { code: 2, message: 'Fetch failed' });
+        });
+    });
+
+    describe('Client streaming', () => {
+        /**
+         * Create a fake client stream call, reading the given requests
+         *
+         * @param {Object[]} requests the requests sent by the client
+         * @return {Readable} the fake call
+         */
+        const createClientStreamCall = (requests) => {
+            const call = Readable.from(requests);
+            call.cancelled = false;
+            return call;
+        };
+
+        it('should successfully give every converted request to the controller and answer with its response', async () => {
+            const controller = {
+                // eslint-disable-next-line require-jsdoc
+                async TestClientStream(requests) {
+                    let ui = 0n;
+                    for await (const request of requests) {
+                        ui += request.ui;
+                    }
+                    return { ui, i: -1n };
+                },
+            };
+            const adapter = bindGRPCController(proto.Service.service, controller, [], absoluteMessagesDefinitions);
+            const callback = sinon.fake();
+
+            const call = createClientStreamCall([{ ui: Long.fromNumber(1, true) }, { ui: Long.fromNumber(2, true) }]);
+            await adapter.TestClientStream(call, callback);
+
+            sinon.assert.calledOnce(callback);
+            const [error, response] = callback.firstCall.args;
+            expect(error).to.be.null;
+            expect(response.ui.equals(Long.fromNumber(3, true))).to.be.true;
+            expect(response.i.equals(Long.fromNumber(-1))).to.be.true;
+        });
+
+        it('should successfully fail the iteration of the requests when the client cancelled the call', async () => {
+            const call = createClientStreamCall([{ ui: Long.fromNumber(1, true) }]);
+            let received = 0;
+            const controller = {
+                // eslint-disable-next-line require-jsdoc
+                async TestClientStream(requests) {
+                    for await (const _ of requests) {
+                        received++;
+                        call.cancelled = true;
+                    }
+                    return { ui: 1n, i: 1n };
+                },
+            };
+            const adapter = bindGRPCController(proto.Service.service, controller, [], absoluteMessagesDefinitions);
+            const callback = sinon.fake();
+
+            await adapter.TestClientStream(call, callback);
+
+            expect(received).to.equal(1);
+            sinon.assert.calledOnceWithMatch(callback, { code: 2, message: 'The call has been cancelled by the client' });
+        });
+    });
 };
@@ -0,0 +1,105 @@
+/**
+ * @license
+ * Copyright CERN and copyright holders of ALICE O2. This software is
+ * distributed under the terms of the GNU General Public License v3 (GPL
+ * Version 3), copied verbatim in the file "COPYING".
+ *
+ * See http://alice-o2.web.cern.ch/license for full licensing information.
+ *
+ * In applying this license CERN does not waive the privileges and immunities
+ * granted to it by virtue of its status as an Intergovernmental Organization
+ * or submit itself to any jurisdiction.
+ */
+
+const assert = require('assert');
+const sinon = require('sinon');
+const chai = require('chai');
+const { GRPCRunController } = require('../../../../lib/server/controllers/gRPC/GRPCRunController.js');
+const { BadParameterError } = require('../../../../lib/server/errors/BadParameterError.js');
+
+const { expect } = chai;
+
+/**
+ * Create a run as returned by the run service, containing the relations it has been asked for
+ *
+ * @param {Object} relations the relations to fetch
+ * @return {Object} the run
+ */
+const createRun = (relations) => ({
+    runNumber: 106,
+    environmentId: 'CmCvjNbg',
+    runQuality: 'good',
+    nDetectors: 2,
+    ...relations.detectors ? { detectors: 'CPV, ITS' } : {},
+    ...relations.runType ? { runType: { name: 'PHYSICS' } } : {},
+    ...relations.lhcPeriod ? { lhcPeriod: { name: 'LHC22a' } } : {},
+    ...relations.lhcFill ? { lhcFill: { fillNumber: 1 } } : {},
+});
+
+/**
+ * Create a controller whose run service returns the run built by createRun
+ *
+ * @return {GRPCRunController} the controller
+ */
+const createController = () => {
+    const controller = new GRPCRunController();
+    controller.runService = { getOrFail: sinon.fake((_, relations) => Promise.resolve(createRun(relations))) };
+    return controller;
+};
+
+module.exports = () => {
+    it('should successfully return the whole run without its relations when no field is selected', async () => {
+        const controller = createController();
+
+        const { run, lhcFill } = await controller.Get({ runNumber: 106, relations: [], fields: [] });
+
+        expect(run).to.eql({
+            runNumber: 106,
+            environmentId: 'CmCvjNbg',
+            runQuality: 'good',
+            nDetectors: 2,
+            detectors: undefined,
+            runType: undefined,
+            lhcPeriod: undefined,
+        });
+        expect(lhcFill).to.be.undefined;
+        expect(controller.runService.getOrFail.firstCall.args[1]).to.eql({ lhcFill: false });
+    });
+
+    it('should successfully return only the selected fields and the run number', async () => {
+        const controller = createController();
+
+        const { run } = await controller.Get({ runNumber: 106, relations: [], fields: ['runQuality', 'detectors'] });
+
+        expect(run).to.eql({ runNumber: 106, runQuality: 'good', detectors: ['CPV', 'ITS'] });
+    });
+
+    it('should successfully fetch the detectors, run type and LHC period only when they are selected', async () => {
+        const controller = createController();
+
+        await controller.Get({ runNumber: 106, relations: [], fields: ['runQuality'] });
+        expect(controller.runService.getOrFail.lastCall.args[1]).to.eql({ lhcFill: false });
+
+        await controller.Get({ runNumber: 106, relations: ['LHC_FILL'], fields: ['runType', 'lhcPeriod'] });
+        expect(controller.runService.getOrFail.lastCall.args[1]).to.eql({ lhcFill: true, runType: true, lhcPeriod: true });
+    });
+
+    it('should successfully omit the selected fields the run does not have', async () => {
+        const controller = createController();
+
+        const { run } = await controller.Get({ runNumber: 106, relations: ['LHC_FILL'], fields: ['nDetectors', 'timeO2End'] });
+
+        expect(run).to.eql({ runNumber: 106, nDetectors: 2 });
+        expect(controller.runService.getOrFail.lastCall.args[1]).to.eql({ lhcFill: true });
+    });
+
+    it('should reject with BadParameterError when an unknown field is selected', async () => {
+        const controller = createController();
+
+        await assert.rejects(
+            () => controller.Get({ runNumber: 106, relations: [], fields: ['nDetectors', 'unknownField'] }),
+            new BadParameterError('Unknown run fields: unknownField'),
+        );
+        expect(controller.runService.getOrFail.called).to.be.false;
+    });
+};
@@ -15,10 +15,12 @@ const UtilitiesSuite = require('./utilities/index.js');
 const ServicesSuite = require('./services/index.js');
 const MiddlewareSuite = require('./middleware/index.js');
 const ExternalServicesSynchronizationSuite = require('./externalServicesSynchronization/index.js');
+const ControllersSuite = require('./controllers/index.js');
 
 module.exports = () => {
     describe('Utilities', UtilitiesSuite);
     describe('Services', ServicesSuite);
     describe('Middlewares', MiddlewareSuite);
     describe('External Services Synchronization', ExternalServicesSynchronizationSuite);
+    describe('Controllers', ControllersSuite);
 };
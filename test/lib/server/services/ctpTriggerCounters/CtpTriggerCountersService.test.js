@@ -112,6 +112,30 @@ module.exports = () => {
         ]);
     });
 
+    it('Should successfully store only the latest of the counters received for a class before being read', async () => {
+        const timestamp = Math.floor(Date.now() / 1000) * 1000;
+        for (const lmb of [21, 31, 41]) {
+            await ctpTriggerCountersService.createOrUpdatePerRun(
+                { runNumber: 2, className: 'CLASS-NAME' },
+                { timestamp, lmb, lma: 2, l0b: 3, l0a: 4, l1b: 5, l1a: 6 },
+            );
+        }
+        expect((await ctpTriggerCountersService.getPerRun(2)).map(simplifyCtpTriggerCounters)).to.deep.eql([
+            {
+                id: 5,
+                runNumber: 2,
+                className: 'CLASS-NAME',
+                timestamp,
+                lmb: 41,
+                lma: 2,
+                l0b: 3,
+                l0a: 4,
+                l1b: 5,
+                l1a: 6,
+            },
+        ]);
+    });
+
     it('Should throw when trying to create/update counters for a non-existing run', async () => {
         await assert.rejects(
             () => ctpTriggerCountersService.createOrUpdatePerRun(
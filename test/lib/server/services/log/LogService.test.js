@@ -12,6 +12,8 @@
  */
 
 const assert = require('assert');
+const { readdir, readFile } = require('fs/promises');
+const { Readable } = require('stream');
 const { logService } = require('../../../../../lib/server/services/log/LogService.js');
 const { NotFoundError } = require('../../../../../lib/server/errors/NotFoundError.js');
 const chai = require('chai');
@@ -90,4 +92,43 @@ module.exports = () => {
 
         expect(childLogs.length).to.equal(expectedAmountOfChildren);
     });
+
+    it('Should successfully store a file received in chunks and attach it to a log', async () => {
+        const chunks = [Buffer.from('first chunk, '), Buffer.from('second chunk')];
+
+        const attachment = await logService.createAttachment(1, { originalName: 'dump.txt', mimeType: 'text/plain' }, Readable.from(chunks));
+
+        expect(attachment.logId).to.equal(1);
+        expect(attachment.originalName).to.equal('dump.txt');
+        expect(attachment.mimeType).to.equal('text/plain');
+        expect(attachment.size).to.equal(25);
+        expect(attachment.fileName).to.match(/^\d+_dump\.txt$/);
+        expect(await readFile(attachment.path, 'utf8')).to.equal('first chunk, second chunk');
+
+        const log = await logService.get(1);
+        expect(log.attachments.map(({ id }) => id)).to.include(attachment.id);
+    });
+
+    it('Should not keep any file of an attachment whose upload failed', async () => {
+        const originalName = `partial-${Date.now()}.txt`;
+        // eslint-disable-next-line require-jsdoc
+        const chunks = async function* () {
+            yield Buffer.from('partial content');
+            throw new Error('The call has been cancelled by the client');
+        };
+
+        await assert.rejects(
+            () => logService.createAttachment(1, { originalName, mimeType: 'text/plain' }, chunks()),
+            new Error('The call has been cancelled by the client'),
+        );
+        const storedFiles = await readdir(process.env?.ATTACHMENT_PATH || '/tmp');
+        expect(storedFiles.filter((fileName) => fileName.endsWith(originalName))).to.be.empty;
+    });
+
+    it('Should throw when attaching a file to a non-existing log', async () => {
+        await assert.rejects(
+            () => logService.createAttachment(9999, { originalName: 'dump.txt', mimeType: 'text/plain' }, Readable.from([])),
+            new NotFoundError('Log with this id (9999) could not be found'),
+        );
+    });
 };
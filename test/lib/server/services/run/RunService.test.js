@@ -24,6 +24,7 @@ const { getLog } = require('../../../../../lib/server/services/log/getLog.js');
 const { updateRun } = require('../../../../../lib/server/services/run/updateRun.js');
 const { RunDetectorQualities } = require('../../../../../lib/domain/enums/RunDetectorQualities.js');
 const { RunDefinition } = require('../../../../../lib/domain/enums/RunDefinition.js');
+const { repositories: { RunRepository } } = require('../../../../../lib/database/index.js');
 
 module.exports = () => {
     const baseRun = {
@@ -755,4 +756,36 @@ module.exports = () => {
         expect(run.eorReasons[0].title).to.equal('TPC');
         expect(run.eorReasons[0].description).to.equal('Run stopped due to LHC dump');
     });
+
+    it('should successfully fetch the run with the highest run number as last run', async () => {
+        const [expectedRun] = await RunRepository.findAll({ order: [['runNumber', 'DESC']], limit: 1 });
+
+        const run = await runService.getLast({ lhcFill: true });
+        expect(run.runNumber).to.equal(expectedRun.runNumber);
+        expect(run).to.have.property('lhcFill');
+    });
+
+    it('should successfully iterate over the runs of a run number range by batches', async () => {
+        const runNumbers = [];
+        for await (const run of runService.getMany({ runNumberFrom: 1, runNumberTo: 10 }, {}, 3)) {
+            runNumbers.push(run.runNumber);
+        }
+        expect(runNumbers).to.deep.equal([1, 2, 3, 4, 5, 6, 7, 8, 9, 10]);
+    });
+
+    it('should successfully iterate over the runs of an LHC period', async () => {
+        const runs = [];
+        for await (const run of runService.getMany({ runNumberFrom: 40, runNumberTo: 60, lhcPeriod: 'LHC22a' }, { lhcFill: true }, 2)) {
+            runs.push(run);
+        }
+        expect(runs.map(({ runNumber }) => runNumber)).to.deep.equal([49, 54, 56]);
+        expect(runs.every(({ lhcPeriod }) => lhcPeriod.name === 'LHC22a')).to.be.true;
+    });
+
+    it('should throw when iterating over runs without any criteria', async () => {
+        await assert.rejects(
+            () => runService.getMany({}).next(),
+            new BadParameterError('At least one of run number range or LHC period must be specified to fetch runs'),
+        );
+    });
 };
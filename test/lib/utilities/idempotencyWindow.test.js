@@ -0,0 +1,127 @@
+/**
+ *  @license
+ *  Copyright CERN and copyright holders of ALICE O2. This software is
+ *  distributed under the terms of the GNU General Public License v3 (GPL
+ *  Version 3), copied verbatim in the file "COPYING".
+ *
+ *  See http://alice-o2.web.cern.ch/license for full licensing information.
+ *
+ *  In applying this license CERN does not waive the privileges and immunities
+ *  granted to it by virtue of its status as an Intergovernmental Organization
+ *  or submit itself to any jurisdiction.
+ */
+
+const sinon = require('sinon');
+const chai = require('chai');
+
+const { expect } = chai;
+const assert = require('assert');
+const { createIdempotencyWindow, scopeIdempotencyKey } = require('../../../lib/utilities/idempotencyWindow.js');
+
+module.exports = () => {
+    it('should successfully run only once the operations with the same key', async () => {
+        const operation = sinon.fake.resolves({ id: 1 });
+        const idempotencyWindow = createIdempotencyWindow();
+
+        const first = await idempotencyWindow('key-1', operation);
+        const second = await idempotencyWindow('key-1', operation);
+
+        expect(operation.callCount).to.equal(1);
+        expect(second).to.equal(first);
+
+        await idempotencyWindow('key-2', operation);
+        expect(operation.callCount).to.equal(2);
+    });
+
+    it('should successfully share the result of an operation still in progress', async () => {
+        let resolveOperation;
+        const operation = sinon.fake(() => new Promise((resolve) => {
+            resolveOperation = resolve;
+        }));
+        const idempotencyWindow = createIdempotencyWindow();
+
+        const first = idempotencyWindow('key', operation);
+        const second = idempotencyWindow('key', operation);
+        await Promise.resolve();
+        resolveOperation(12);
+
+        expect(await first).to.equal(12);
+        expect(await second).to.equal(12);
+        expect(operation.callCount).to.equal(1);
+    });
+
+    it('should successfully run every operation without key', async () => {
+        const operation = sinon.fake.resolves(null);
+        const idempotencyWindow = createIdempotencyWindow();
+
+        await idempotencyWindow(undefined, operation);
+        await idempotencyWindow('', operation);
+        await idempotencyWindow(undefined, operation);
+
+        expect(operation.callCount).to.equal(3);
+    });
+
+    it('should successfully run again a failed operation', async () => {
+        const operation = sinon.stub();
+        operation.onFirstCall().rejects(new Error('Transient failure'));
+        operation.onSecondCall().resolves(3);
+        const idempotencyWindow = createIdempotencyWindow();
+
+        await assert.rejects(() => idempotencyWindow('key', operation), new Error('Transient failure'));
+        expect(await idempotencyWindow('key', operation)).to.equal(3);
+        expect(await idempotencyWindow('key', operation)).to.equal(3);
+
+        expect(operation.callCount).to.equal(2);
+    });
+
+    it('should successfully forget the keys older than the window', async () => {
+        let now = 0;
+        const operation = sinon.fake.resolves(null);
+        const idempotencyWindow = createIdempotencyWindow({ windowMs: 1000, now: () => now });
+
+        await idempotencyWindow('key', operation);
+        now = 999;
+        await idempotencyWindow('key', operation);
+        expect(operation.callCount).to.equal(1);
+
+        now = 1000;
+        await idempotencyWindow('key', operation);
+        expect(operation.callCount).to.equal(2);
+    });
+
+    it('should successfully forget the oldest keys when too many are remembered', async () => {
+        const operation = sinon.fake.resolves(null);
+        const idempotencyWindow = createIdempotencyWindow({ maxKeys: 2 });
+
+        await idempotencyWindow('key-1', operation);
+        await idempotencyWindow('key-2', operation);
+        await idempotencyWindow('key-3', operation);
+        expect(operation.callCount).to.equal(3);
+
+        await idempotencyWindow('key-3', operation);
+        await idempotencyWindow('key-2', operation);
+        expect(operation.callCount).to.equal(3);
+
+        await idempotencyWindow('key-1', operation);
+        expect(operation.callCount).to.equal(4);
+    });
+
+    it('should successfully scope the keys by method and caller', async () => {
+        const operation = sinon.fake.resolves(null);
+        const idempotencyWindow = createIdempotencyWindow();
+        const alice = { id: 1, username: 'alice' };
+        const bob = { id: 2, username: 'bob' };
+
+        await idempotencyWindow(scopeIdempotencyKey('Create', alice, 'key-1'), operation);
+        await idempotencyWindow(scopeIdempotencyKey('Create', { ...alice }, 'key-1'), operation);
+        expect(operation.callCount).to.equal(1);
+
+        await idempotencyWindow(scopeIdempotencyKey('Create', bob, 'key-1'), operation);
+        await idempotencyWindow(scopeIdempotencyKey('Create', undefined, 'key-1'), operation);
+        await idempotencyWindow(scopeIdempotencyKey('CreateSynchronous', alice, 'key-1'), operation);
+        expect(operation.callCount).to.equal(4);
+
+        expect(scopeIdempotencyKey('Create', alice, undefined)).to.be.undefined;
+        expect(scopeIdempotencyKey('Create', alice, '')).to.be.undefined;
+    });
+};
@@ -13,14 +13,24 @@
 
 const cacheAsyncFunctionTest = require('./cacheAsyncFunction.test.js');
 const deepmerge = require('./deepmerge.test.js');
+const idempotencyWindowTest = require('./idempotencyWindow.test.js');
 const isPromise = require('./isPromise.test.js');
+const latestValueWatcherTest = require('./latestValueWatcher.test.js');
 const rangeUtilsTest = require('./rangeUtils.test.js');
 const stringUtilsTest = require('./stringUtils.test.js');
+const serverTimingTest = require('./serverTiming.test.js');
+const tracingTest = require('./tracing.test.js');
+const writeBehindBufferTest = require('./writeBehindBuffer.test.js');
 
 module.exports = () => {
     describe('cacheFunction', cacheAsyncFunctionTest);
     describe('deepmerge', deepmerge);
+    describe('idempotencyWindow', idempotencyWindowTest);
     describe('isPromise', isPromise);
+    describe('latestValueWatcher', latestValueWatcherTest);
     describe('stringUtils', stringUtilsTest);
+    describe('serverTiming', serverTimingTest);
+    describe('tracing', tracingTest);
+    describe('writeBehindBuffer', writeBehindBufferTest);
     describe('rangeUtils', rangeUtilsTest)
 };
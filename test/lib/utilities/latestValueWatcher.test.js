@@ -0,0 +1,115 @@
+/**
+ *  @license
+ *  Copyright CERN and copyright holders of ALICE O2. This software is
+ *  distributed under the terms of the GNU General Public License v3 (GPL
+ *  Version 3), copied verbatim in the file "COPYING".
+ *
+ *  See http://alice-o2.web.cern.ch/license for full licensing information.
+ *
+ *  In applying this license CERN does not waive the privileges and immunities
+ *  granted to it by virtue of its status as an Intergovernmental Organization
+ *  or submit itself to any jurisdiction.
+ */
+
+const sinon = require('sinon');
+const chai = require('chai');
+
+const { expect } = chai;
+const { createLatestValueWatcher } = require('../../../lib/utilities/latestValueWatcher.js');
+
+module.exports = () => {
+    let clock;
+
+    beforeEach(() => {
+        clock = sinon.useFakeTimers();
+    });
+
+    afterEach(() => {
+        clock.restore();
+    });
+
+    /**
+     * Collect the values given by a watch until the given signal is aborted
+     *
+     * @param {AsyncGenerator} watch the watch to collect
+     * @return {{values: Array, done: Promise<void>}} the values collected so far and a promise resolving at the end of the watch
+     */
+    const collect = (watch) => {
+        const values = [];
+        const done = (async () => {
+            for await (const value of watch) {
+                values.push(value);
+            }
+        })();
+        return { values, done };
+    };
+
+    it('should successfully give the current value then each of its changes', async () => {
+        let current = { fillNumber: 1 };
+        const watchLast = createLatestValueWatcher(async () => current, { pollIntervalMs: 100 });
+        const abortController = new AbortController();
+
+        const { values, done } = collect(watchLast(abortController.signal));
+        await clock.tickAsync(0);
+        expect(values).to.deep.equal([{ fillNumber: 1 }]);
+
+        await clock.tickAsync(100);
+        expect(values).to.have.lengthOf(1);
+
+        current = { fillNumber: 1, stableBeamsStart: 1000n };
+        await clock.tickAsync(100);
+        current = { fillNumber: 2 };
+        await clock.tickAsync(100);
+        expect(values).to.deep.equal([{ fillNumber: 1 }, { fillNumber: 1, stableBeamsStart: 1000n }, { fillNumber: 2 }]);
+
+        abortController.abort();
+        await done;
+    });
+
+    it('should successfully share a single fetch loop between all the watchers and stop it with the last one', async () => {
+        const fetchLatest = sinon.fake.resolves({ runNumber: 1 });
+        const watchLast = createLatestValueWatcher(fetchLatest, { pollIntervalMs: 100 });
+        const firstAbortController = new AbortController();
+        const secondAbortController = new AbortController();
+
+        const first = collect(watchLast(firstAbortController.signal));
+        const second = collect(watchLast(secondAbortController.signal));
+        await clock.tickAsync(1000);
+        expect(fetchLatest.callCount).to.equal(11);
+        expect(first.values).to.deep.equal([{ runNumber: 1 }]);
+        expect(second.values).to.deep.equal([{ runNumber: 1 }]);
+
+        firstAbortController.abort();
+        await first.done;
+        await clock.tickAsync(1000);
+        expect(fetchLatest.callCount).to.equal(21);
+
+        secondAbortController.abort();
+        await second.done;
+        await clock.tickAsync(1000);
+        expect(fetchLatest.callCount).to.equal(21);
+    });
+
+    it('should successfully keep the previous value when a fetch fails', async () => {
+        let fetchLatest = async () => ({ runNumber: 1 });
+        const onError = sinon.fake();
+        const watchLast = createLatestValueWatcher(() => fetchLatest(), { pollIntervalMs: 100, onError });
+        const abortController = new AbortController();
+
+        const { values, done } = collect(watchLast(abortController.signal));
+        await clock.tickAsync(0);
+
+        fetchLatest = async () => {
+            throw new Error('Database unavailable');
+        };
+        await clock.tickAsync(100);
+        sinon.assert.calledOnceWithMatch(onError, { message: 'Database unavailable' });
+
+        fetchLatest = async () => ({ runNumber: 2 });
+        await clock.tickAsync(100);
+        expect(values).to.deep.equal([{ runNumber: 1 }, { runNumber: 2 }]);
+
+        abortController.abort();
+        await done;
+    });
+};
@@ -0,0 +1,120 @@
+/**
+ *  @license
+ *  Copyright CERN and copyright holders of ALICE O2. This software is
+ *  distributed under the terms of the GNU General Public License v3 (GPL
+ *  Version 3), copied verbatim in the file "COPYING".
+ *
+ *  See http://alice-o2.web.cern.ch/license for full licensing information.
+ *
+ *  In applying this license CERN does not waive the privileges and immunities
+ *  granted to it by virtue of its status as an Intergovernmental Organization
+ *  or submit itself to any jurisdiction.
+ */
+
+const chai = require('chai');
+const {
+    createServerTiming,
+    formatServerTiming,
+    recordDatabaseTiming,
+    runWithServerTiming,
+    timeStage,
+} = require('../../../lib/utilities/serverTiming.js');
+
+const { expect } = chai;
+
+/**
+ * Wait for the given delay
+ *
+ * @param {number} delayMs the delay in milliseconds
+ * @return {Promise<void>} resolves once the delay elapsed
+ */
+const sleep = (delayMs) => new Promise((resolve) => setTimeout(resolve, delayMs));
+
+/**
+ * Create a fake sequelize instance running its hooks around fake pool acquisitions and queries
+ *
+ * @return {{addHook: function, query: function(number, number): Promise<void>}} the fake sequelize instance
+ */
+const createFakeSequelize = () => {
+    const hooks = {};
+    return {
+        addHook: (name, hook) => {
+            hooks[name] = hook;
+        },
+        query: async (acquisitionMs, queryMs) => {
+            const options = {};
+            const query = {};
+            hooks.beforePoolAcquire(options);
+            await sleep(acquisitionMs);
+            hooks.afterPoolAcquire({}, options);
+            hooks.beforeQuery(options, query);
+            await sleep(queryMs);
+            hooks.afterQuery(options, query);
+        },
+    };
+};
+
+module.exports = () => {
+    it('should successfully add the duration of the stages to the timing of the call', async () => {
+        const timing = createServerTiming();
+
+        const result = await runWithServerTiming(timing, async () => {
+            await timeStage('authMs', () => sleep(5));
+            return timeStage('handlerMs', async () => {
+                await sleep(20);
+                return 'response';
+            });
+        });
+
+        expect(result).to.equal('response');
+        expect(timing.authMs).to.be.at.least(4);
+        expect(timing.handlerMs).to.be.at.least(19);
+        expect(timing.queueMs).to.equal(0);
+        expect(timing.dbMs).to.equal(0);
+    });
+
+    it('should successfully add the duration of a failed stage to the timing of the call', async () => {
+        const timing = createServerTiming();
+
+        let error = null;
+        try {
+            await runWithServerTiming(timing, () => timeStage('handlerMs', async () => {
+                await sleep(10);
+                throw new Error('Handler failed');
+            }));
+        } catch (e) {
+            error = e;
+        }
+
+        expect(error.message).to.equal('Handler failed');
+        expect(timing.handlerMs).to.be.at.least(9);
+    });
+
+    it('should successfully add the database time to the timing of the call running the queries', async () => {
+        const sequelize = createFakeSequelize();
+        recordDatabaseTiming(sequelize);
+        const firstTiming = createServerTiming();
+        const secondTiming = createServerTiming();
+
+        await Promise.all([
+            runWithServerTiming(firstTiming, () => sequelize.query(10, 20)),
+            runWithServerTiming(secondTiming, async () => {
+                await sequelize.query(0, 5);
+                await sequelize.query(0, 5);
+            }),
+            // Outside of any call, recorded nowhere
+            sequelize.query(0, 50),
+        ]);
+
+        expect(firstTiming.queueMs).to.be.at.least(9);
+        expect(firstTiming.dbMs).to.be.at.least(19);
+        expect(firstTiming.dbMs).to.be.below(45);
+        expect(secondTiming.dbMs).to.be.at.least(9);
+        expect(secondTiming.dbMs).to.be.below(45);
+    });
+
+    it('should successfully format the timing of a call as a Server-Timing header', () => {
+        expect(formatServerTiming({ queueMs: 0, authMs: 1.25, handlerMs: 12.3456789, dbMs: 10 }))
+            .to.equal('queue;dur=0, auth;dur=1.25, handler;dur=12.346, db;dur=10');
+    });
+};
@@ -0,0 +1,176 @@
+/**
+ *  @license
+ *  Copyright CERN and copyright holders of ALICE O2. This software is
+ *  distributed under the terms of the GNU General Public License v3 (GPL
+ *  Version 3), copied verbatim in the file "COPYING".
+ *
+ *  See http://alice-o2.web.cern.ch/license for full licensing information.
+ *
+ *  In applying this license CERN does not waive the privileges and immunities
+ *  granted to it by virtue of its status as an Intergovernmental Organization
+ *  or submit itself to any jurisdiction.
+ */
+
+const chai = require('chai');
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const { parseTraceparent, createTracer, createJsonLinesSpanExporter, traceMethods } = require('../../../lib/utilities/tracing.js');
+
+const { expect } = chai;
+
+const CLIENT_TRACE_ID = '0af7651916cd43dd8448eb211c80319c';
+const CLIENT_SPAN_ID = 'b7ad6b7169203331';
+
+/**
+ * Create an exporter keeping the spans in memory
+ *
+ * @return {{export: function, spans: Object[]}} the exporter
+ */
+const createMemoryExporter = () => {
+    const spans = [];
+    return { export: (span) => spans.push(span), spans };
+};
+
+module.exports = () => {
+    it('should successfully parse valid trace contexts', () => {
+        expect(parseTraceparent(`00-${CLIENT_TRACE_ID}-${CLIENT_SPAN_ID}-01`))
+            .to.eql({ traceId: CLIENT_TRACE_ID, parentSpanId: CLIENT_SPAN_ID, sampled: true });
+        expect(parseTraceparent(`00-${CLIENT_TRACE_ID}-${CLIENT_SPAN_ID}-00`).sampled).to.be.false;
+    });
+
+    it('should successfully reject missing or invalid trace contexts', () => {
+        expect(parseTraceparent(undefined)).to.be.null;
+        expect(parseTraceparent('')).to.be.null;
+        expect(parseTraceparent(`01-${CLIENT_TRACE_ID}-${CLIENT_SPAN_ID}-01`)).to.be.null;
+        expect(parseTraceparent(`00-${CLIENT_TRACE_ID.toUpperCase()}-${CLIENT_SPAN_ID}-01`)).to.be.null;
+        expect(parseTraceparent(`00-${'0'.repeat(32)}-${CLIENT_SPAN_ID}-01`)).to.be.null;
+        expect(parseTraceparent(`00-${CLIENT_TRACE_ID}-${'0'.repeat(16)}-01`)).to.be.null;
+    });
+
+    it('should successfully record the spans of a call sampled by its client, nested through asynchronous operations', async () => {
+        const exporter = createMemoryExporter();
+        const tracer = createTracer({ exporter });
+
+        const result = await tracer.runInTrace(`00-${CLIENT_TRACE_ID}-${CLIENT_SPAN_ID}-01`, '/o2.bookkeeping.RunService/Get', async () => {
+            await tracer.withSpan('preProcessors', async () => null);
+            return tracer.withSpan('GRPCRunController.Get', async () => {
+                await new Promise((resolve) => setTimeout(resolve, 5));
+                return tracer.withSpan('RunRepository.findOne', () => 12);
+            });
+        });
+
+        expect(result).to.equal(12);
+        expect(exporter.spans.map(({ name }) => name))
+            .to.eql(['preProcessors', 'RunRepository.findOne', 'GRPCRunController.Get', '/o2.bookkeeping.RunService/Get']);
+
+        const [preProcessors, repository, controller, server] = exporter.spans;
+        expect(exporter.spans.every(({ traceId }) => traceId === CLIENT_TRACE_ID)).to.be.true;
+        expect(server.parentSpanId).to.equal(CLIENT_SPAN_ID);
+        expect(server.kind).to.equal('server');
+        expect(preProcessors.parentSpanId).to.equal(server.spanId);
+        expect(controller.parentSpanId).to.equal(server.spanId);
+        expect(repository.parentSpanId).to.equal(controller.spanId);
+        expect(repository.kind).to.equal('internal');
+        expect(controller.durationUs).to.be.at.least(5000);
+        expect(controller.startUs).to.be.at.least(server.startUs);
+    });
+
+    it('should successfully record the error ending a span', async () => {
+        const exporter = createMemoryExporter();
+        const tracer = createTracer({ exporter });
+
+        let error;
+        try {
+            await tracer.runInTrace(`00-${CLIENT_TRACE_ID}-${CLIENT_SPAN_ID}-01`, 'call', () => tracer.withSpan('stage', () => {
+                throw new Error('Run not found');
+            }));
+        } catch (e) {
+            error = e;
+        }
+
+        expect(error.message).to.equal('Run not found');
+        expect(exporter.spans.map(({ error }) => error)).to.eql(['Run not found', 'Run not found']);
+    });
+
+    it('should successfully follow the sampling decision of the client and the sample ratio otherwise', async () => {
+        const exporter = createMemoryExporter();
+        const neverSampling = createTracer({ exporter, sampleRatio: 0 });
+        const alwaysSampling = createTracer({ exporter, sampleRatio: 1 });
+
+        await alwaysSampling.runInTrace(`00-${CLIENT_TRACE_ID}-${CLIENT_SPAN_ID}-00`, 'not sampled by client', async () => null);
+        await neverSampling.runInTrace(undefined, 'not sampled', async () => null);
+        expect(exporter.spans).to.have.lengthOf(0);
+
+        await neverSampling.runInTrace(`00-${CLIENT_TRACE_ID}-${CLIENT_SPAN_ID}-01`, 'sampled by client', async () => null);
+        await alwaysSampling.runInTrace('invalid', 'sampled', async () => null);
+        expect(exporter.spans.map(({ name }) => name)).to.eql(['sampled by client', 'sampled']);
+
+        const [, newTrace] = exporter.spans;
+        expect(newTrace.traceId).to.match(/^[0-9a-f]{32}$/);
+        expect(newTrace.traceId).to.not.equal(CLIENT_TRACE_ID);
+        expect(newTrace.parentSpanId).to.be.null;
+    });
+
+    it('should successfully run operations as is outside of a trace', () => {
+        const tracer = createTracer();
+        expect(tracer.enabled).to.be.false;
+        expect(tracer.runInTrace(`00-${CLIENT_TRACE_ID}-${CLIENT_SPAN_ID}-01`, 'call', () => 1)).to.equal(1);
+        expect(tracer.withSpan('stage', () => 2)).to.equal(2);
+    });
+
+    it('should successfully trace the methods of an object, including the inherited ones', async () => {
+        // eslint-disable-next-line require-jsdoc
+        class BaseRepository {
+            // eslint-disable-next-line require-jsdoc
+            async findOne() {
+                return this.value;
+            }
+
+            // eslint-disable-next-line require-jsdoc
+            async upsert() {
+                return 'base';
+            }
+        }
+
+        // eslint-disable-next-line require-jsdoc
+        class CountersRepository extends BaseRepository {
+            // eslint-disable-next-line require-jsdoc
+            async upsert() {
+                return `counters ${await super.upsert()}`;
+            }
+        }
+
+        const exporter = createMemoryExporter();
+        const tracer = createTracer({ exporter });
+        const repository = new CountersRepository();
+        repository.value = 5;
+        traceMethods(repository, 'CountersRepository', tracer);
+
+        const results = await tracer.runInTrace(`00-${CLIENT_TRACE_ID}-${CLIENT_SPAN_ID}-01`, 'call', async () => [
+            await repository.findOne(),
+            await repository.upsert(),
+        ]);
+
+        expect(results).to.eql([5, 'counters base']);
+        expect(exporter.spans.map(({ name }) => name)).to.eql(['CountersRepository.findOne', 'CountersRepository.upsert', 'call']);
+    });
+
+    it('should successfully write the spans as JSON lines and drop the ones exceeding the buffer', async () => {
+        const exportPath = path.join(fs.mkdtempSync(path.join(os.tmpdir(), 'spans-')), 'spans.jsonl');
+        const exporter = createJsonLinesSpanExporter(exportPath, { flushIntervalMs: 60 * 1000, maxBufferedSpans: 4 });
+
+        exporter.export({ name: 'first' });
+        exporter.export({ name: 'second' });
+        // Reaching half of the buffer starts a write, the two batches being written fill it
+        exporter.export({ name: 'third' });
+        exporter.export({ name: 'fourth' });
+        exporter.export({ name: 'dropped' });
+        await exporter.flush();
+        exporter.export({ name: 'fifth' });
+        await exporter.flush();
+
+        const lines = fs.readFileSync(exportPath, 'utf-8').split('\n').filter((line) => line);
+        expect(lines.map((line) => JSON.parse(line).name)).to.eql(['first', 'second', 'third', 'fourth', 'fifth']);
+    });
+};
@@ -0,0 +1,162 @@
+/**
+ *  @license
+ *  Copyright CERN and copyright holders of ALICE O2. This software is
+ *  distributed under the terms of the GNU General Public License v3 (GPL
+ *  Version 3), copied verbatim in the file "COPYING".
+ *
+ *  See http://alice-o2.web.cern.ch/license for full licensing information.
+ *
+ *  In applying this license CERN does not waive the privileges and immunities
+ *  granted to it by virtue of its status as an Intergovernmental Organization
+ *  or submit itself to any jurisdiction.
+ */
+
+const sinon = require('sinon');
+const chai = require('chai');
+const { createWriteBehindBuffer } = require('../../../lib/utilities/writeBehindBuffer.js');
+
+const { expect } = chai;
+
+module.exports = () => {
+    it('should successfully write only the latest value of each key, by batches', async () => {
+        const write = sinon.fake.resolves(undefined);
+        const buffer = createWriteBehindBuffer({ write, flushIntervalMs: 60 * 1000 });
+
+        buffer.set('1/CLASS-A', { lmb: 1 });
+        buffer.set('1/CLASS-B', { lmb: 2 });
+        buffer.set('1/CLASS-A', { lmb: 3 });
+        await buffer.flush();
+
+        expect(write.callCount).to.equal(1);
+        expect(write.firstCall.args[0]).to.eql([{ lmb: 3 }, { lmb: 2 }]);
+
+        await buffer.flush();
+        expect(write.callCount).to.equal(1);
+    });
+
+    it('should successfully flush as soon as the maximal amount of keys are waiting', async () => {
+        const write = sinon.fake.resolves(undefined);
+        const buffer = createWriteBehindBuffer({ write, flushIntervalMs: 60 * 1000, maxPendingEntries: 2 });
+
+        buffer.set('a', 1);
+        await Promise.resolve();
+        expect(write.callCount).to.equal(0);
+
+        buffer.set('b', 2);
+        buffer.set('c', 3);
+        await buffer.flush();
+
+        expect(write.callCount).to.equal(1);
+        expect(write.firstCall.args[0]).to.eql([1, 2, 3]);
+    });
+
+    it('should successfully keep the values of a batch failed with a transient error for the next one, unless replaced meanwhile', async () => {
+        let failNext = true;
+        const batches = [];
+        const onError = sinon.fake();
+        const buffer = createWriteBehindBuffer({
+            write: async (values) => {
+                if (failNext) {
+                    failNext = false;
+                    buffer.set('b', 'b2');
+                    throw new Error('Database unavailable');
+                }
+                batches.push(values);
+            },
+            flushIntervalMs: 60 * 1000,
+            isTransientError: () => true,
+            onError,
+        });
+
+        buffer.set('a', 'a1');
+        buffer.set('b', 'b1');
+        await buffer.flush();
+
+        expect(onError.callCount).to.equal(1);
+        expect(onError.firstCall.args[0].message).to.equal('Database unavailable');
+        expect(onError.firstCall.args[2]).to.equal(false);
+        expect(batches).to.eql([]);
+
+        await buffer.flush();
+        expect(batches).to.eql([['b2', 'a1']]);
+    });
+
+    it('should successfully write one by one the values of a rejected batch, dropping the ones still rejected', async () => {
+        const batches = [];
+        const onError = sinon.fake();
+        const buffer = createWriteBehindBuffer({
+            write: async (values) => {
+                if (values.includes('invalid')) {
+                    throw new Error('Invalid value');
+                }
+                batches.push(values);
+            },
+            flushIntervalMs: 60 * 1000,
+            onError,
+        });
+
+        buffer.set('a', 'a1');
+        buffer.set('b', 'invalid');
+        buffer.set('c', 'c1');
+        await buffer.flush();
+
+        expect(batches).to.eql([['a1'], ['c1']]);
+        expect(onError.callCount).to.equal(1);
+        expect(onError.firstCall.args[1]).to.eql(['invalid']);
+        expect(onError.firstCall.args[2]).to.equal(true);
+
+        buffer.set('a', 'a2');
+        await buffer.flush();
+        expect(batches).to.eql([['a1'], ['c1'], ['a2']]);
+    });
+
+    it('should successfully refuse new keys once full, including the values being written', async () => {
+        const buffer = createWriteBehindBuffer({
+            write: () => Promise.reject(new Error('Database unavailable')),
+            flushIntervalMs: 60 * 1000,
+            maxPendingEntries: 10,
+            capacity: 2,
+            isTransientError: () => true,
+        });
+
+        expect(buffer.set('a', 1)).to.equal(true);
+        expect(buffer.set('b', 1)).to.equal(true);
+        expect(buffer.set('c', 1)).to.equal(false);
+        expect(buffer.set('a', 2)).to.equal(true);
+
+        const flush = buffer.flush();
+        await Promise.resolve();
+        expect(buffer.set('c', 1)).to.equal(false);
+        await flush;
+
+        expect(buffer.set('c', 1)).to.equal(false);
+        expect(buffer.set('b', 2)).to.equal(true);
+    });
+
+    it('should successfully write the values set during a flush with the next one', async () => {
+        let resolveWrite;
+        const batches = [];
+        const buffer = createWriteBehindBuffer({
+            write: (values) => new Promise((resolve) => {
+                batches.push(values);
+                resolveWrite = resolve;
+            }),
+            flushIntervalMs: 60 * 1000,
+        });
+
+        buffer.set('a', 1);
+        const firstFlush = buffer.flush();
+        await Promise.resolve();
+        buffer.set('a', 2);
+        const secondFlush = buffer.flush();
+        expect(buffer.flush()).to.equal(secondFlush);
+
+        resolveWrite();
+        await firstFlush;
+        await new Promise((resolve) => setImmediate(resolve));
+        resolveWrite();
+        await secondFlush;
+
+        expect(batches).to.eql([[1], [2]]);
+    });
+};